@@ -13,11 +13,17 @@ linux64:
 	# pkg-config
 	ADDON_PKG_CONFIG_LIBRARIES = libusb-1.0
 
+	# shm_open() for shared-memory report export on older glibc.
+	ADDON_LDFLAGS = -lrt
+
 linux:
 	# linux only, any library that should be included in the project using
 	# pkg-config
 	ADDON_PKG_CONFIG_LIBRARIES = libusb-1.0
 
+	# shm_open() for shared-memory report export on older glibc.
+	ADDON_LDFLAGS = -lrt
+
 msys2:
 	# any library that should be included in the project using pkg-config
 	ADDON_PKG_CONFIG_LIBRARIES = libusb-1.0
@@ -27,8 +33,14 @@ linuxarmv6l:
 	# pkg-config
 	ADDON_PKG_CONFIG_LIBRARIES = libusb-1.0
 
+	# shm_open() for shared-memory report export on older glibc.
+	ADDON_LDFLAGS = -lrt
+
 linuxarmv7l:
 	# linux only, any library that should be included in the project using
 	# pkg-config
 	ADDON_PKG_CONFIG_LIBRARIES = libusb-1.0
+
+	# shm_open() for shared-memory report export on older glibc.
+	ADDON_LDFLAGS = -lrt
 	
\ No newline at end of file
@@ -0,0 +1,164 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofApp.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <random>
+
+
+const uint64_t ofApp::RUN_MICROS = 60000000;
+const uint64_t ofApp::WARM_UP_MICROS = 2000000;
+const double ofApp::MAX_ERROR_MICROS = 1000;
+
+
+ofApp::Result ofApp::run(const Scenario& scenario)
+{
+    Result result;
+    result.scenario = scenario;
+
+    ofxIO::HIDClockSync::Settings settings;
+    settings.tickBytes = 4;
+    settings.ticksPerSecond = 1000000;
+
+    // addSample() never touches the device, so it need not be open.
+    ofxIO::HIDDevice device;
+    ofxIO::HIDClockSync clockSync;
+    clockSync.setup(device, settings);
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::exponential_distribution<double> jitter(scenario.jitterMicros > 0 ? 1 / scenario.jitterMicros : 1);
+
+    auto delay = [&]() {
+        double micros = scenario.delayMicros;
+
+        if (scenario.jitterMicros > 0)
+            micros += jitter(random);
+
+        if (uniform(random) < scenario.spikeRate)
+            micros += scenario.spikeMicros * uniform(random);
+
+        return micros;
+    };
+
+    // The true device clock, as a function of host time.
+    const double HOST_START_MICROS = 1e9;
+    const double rate = 1 + scenario.driftPPM * 1e-6;
+
+    auto deviceTicks = [&](double hostMicros) {
+        double ticks = scenario.startTicks + (hostMicros - HOST_START_MICROS) * rate * settings.ticksPerSecond / 1e6;
+        return uint64_t(std::floor(ticks)) & 0xFFFFFFFF;
+    };
+
+    std::vector<double> errors;
+
+    for (double sendMicros = HOST_START_MICROS;
+         sendMicros < HOST_START_MICROS + RUN_MICROS;
+         sendMicros += settings.intervalMicros)
+    {
+        // The device latches its ticks when the request arrives.
+        double latchMicros = sendMicros + delay();
+        double receiveMicros = latchMicros + delay();
+
+        clockSync.addSample(uint64_t(sendMicros),
+                            uint64_t(receiveMicros),
+                            deviceTicks(latchMicros));
+
+        if (sendMicros < HOST_START_MICROS + WARM_UP_MICROS)
+            continue;
+
+        // A report timestamped somewhere before the next ping.
+        double eventMicros = receiveMicros + uniform(random) * settings.intervalMicros;
+        double translatedMicros = double(clockSync.toHostMicros(deviceTicks(eventMicros)));
+        errors.push_back(std::abs(translatedMicros - eventMicros));
+    }
+
+    if (!errors.empty())
+    {
+        double sumSquares = 0;
+
+        for (double error: errors)
+            sumSquares += error * error;
+
+        std::sort(errors.begin(), errors.end());
+
+        result.count = errors.size();
+        result.rmsMicros = std::sqrt(sumSquares / errors.size());
+        result.p99Micros = errors[std::min(errors.size() - 1, std::size_t(errors.size() * 0.99))];
+        result.maxMicros = errors.back();
+    }
+
+    // drift is host time per device time.
+    result.estimatedDriftPPM = (1 / clockSync.estimate().drift - 1) * 1e6;
+    return result;
+}
+
+
+void ofApp::setup()
+{
+    std::vector<Scenario> scenarios(5);
+
+    scenarios[0].name = "no drift, no jitter";
+
+    scenarios[1].name = "100 ppm, 50 us jitter";
+    scenarios[1].driftPPM = 100;
+    scenarios[1].jitterMicros = 50;
+
+    scenarios[2].name = "-250 ppm, 200 us jitter";
+    scenarios[2].driftPPM = -250;
+    scenarios[2].jitterMicros = 200;
+
+    scenarios[3].name = "100 ppm, 200 us, spikes";
+    scenarios[3].driftPPM = 100;
+    scenarios[3].jitterMicros = 200;
+    scenarios[3].spikeRate = 0.05;
+    scenarios[3].spikeMicros = 20000;
+
+    // The 32-bit counter wraps about a second into the run.
+    scenarios[4].name = "50 ppm, tick wrap";
+    scenarios[4].driftPPM = 50;
+    scenarios[4].jitterMicros = 100;
+    scenarios[4].startTicks = 0xFFFFFFFF - 1000000;
+
+    for (const auto& scenario: scenarios)
+    {
+        results.push_back(run(scenario));
+
+        const Result& result = results.back();
+
+        ofLogNotice("ofApp::setup") << scenario.name << ": "
+                                    << "RMS " << ofToString(result.rmsMicros, 1) << " us, "
+                                    << "p99 " << ofToString(result.p99Micros, 1) << " us, "
+                                    << "max " << ofToString(result.maxMicros, 1) << " us, "
+                                    << "drift " << ofToString(result.estimatedDriftPPM, 2) << " ppm";
+
+        if (result.maxMicros > MAX_ERROR_MICROS)
+            ofLogError("ofApp::setup") << scenario.name << ": error exceeds " << MAX_ERROR_MICROS << " us.";
+    }
+}
+
+
+void ofApp::draw()
+{
+    std::stringstream ss;
+    ss << "scenario                   RMS us   p99 us   max us   drift ppm  est. ppm" << std::endl;
+
+    for (const auto& result: results)
+    {
+        ss << std::left << std::setw(24) << result.scenario.name << std::right
+           << ofToString(result.rmsMicros, 1, 9, ' ')
+           << ofToString(result.p99Micros, 1, 9, ' ')
+           << ofToString(result.maxMicros, 1, 9, ' ')
+           << ofToString(result.scenario.driftPPM, 1, 12, ' ')
+           << ofToString(result.estimatedDriftPPM, 2, 10, ' ')
+           << std::endl;
+    }
+
+    ofDrawBitmapString(ss.str(), 20, 20);
+}
@@ -0,0 +1,93 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxHID.h"
+
+
+/// \brief Measures HIDClockSync accuracy against a simulated device clock.
+///
+/// Each scenario simulates a device whose tick counter runs with a fixed
+/// offset and drift from the host clock. Pings see a base USB delay plus
+/// exponential jitter in each direction and occasional scheduling spikes.
+/// The samples are passed to HIDClockSync::addSample() on a simulated
+/// timeline, so a minute of pings runs instantly and repeatably.
+///
+/// After a warm-up, device ticks taken between pings are translated with
+/// toHostMicros() and compared with the true host time.
+class ofApp: public ofBaseApp
+{
+public:
+    /// \brief A simulated device and link.
+    struct Scenario
+    {
+        /// \brief The name of the scenario.
+        std::string name;
+
+        /// \brief The device clock drift in parts per million.
+        double driftPPM = 0;
+
+        /// \brief The fixed one-way delay in microseconds.
+        double delayMicros = 125;
+
+        /// \brief The mean exponential jitter of each direction in
+        ///        microseconds.
+        double jitterMicros = 0;
+
+        /// \brief The probability that a ping is delayed by a spike.
+        double spikeRate = 0;
+
+        /// \brief The length of a spike in microseconds.
+        double spikeMicros = 0;
+
+        /// \brief The device tick count at the first ping.
+        uint64_t startTicks = 123456;
+    };
+
+    /// \brief The translation error of one scenario.
+    struct Result
+    {
+        /// \brief The scenario.
+        Scenario scenario;
+
+        /// \brief The number of translated timestamps.
+        std::size_t count = 0;
+
+        /// \brief The RMS error in microseconds.
+        double rmsMicros = 0;
+
+        /// \brief The 99th percentile absolute error in microseconds.
+        double p99Micros = 0;
+
+        /// \brief The largest absolute error in microseconds.
+        double maxMicros = 0;
+
+        /// \brief The estimated drift in parts per million.
+        double estimatedDriftPPM = 0;
+    };
+
+    void setup() override;
+    void draw() override;
+
+    /// \brief Simulate a scenario.
+    static Result run(const Scenario& scenario);
+
+    /// \brief The simulated run length in microseconds.
+    static const uint64_t RUN_MICROS;
+
+    /// \brief The time before errors are measured in microseconds.
+    static const uint64_t WARM_UP_MICROS;
+
+    /// \brief The error bound for cross-device alignment in microseconds.
+    static const double MAX_ERROR_MICROS;
+
+    std::vector<Result> results;
+
+};
@@ -0,0 +1,187 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofApp.h"
+
+
+const uint64_t ofApp::RUN_MICROS = 5000000;
+const uint64_t ofApp::CYCLE_MICROS = 20000;
+const uint64_t ofApp::INPUT_INTERVAL_MICROS = 150000;
+
+
+ofApp::Result ofApp::run()
+{
+    Result result;
+
+    auto backend = std::make_shared<ofxIO::HIDVirtualBackend>();
+    ofxIO::HIDBackend::set(backend);
+
+    ofxIO::HIDVirtualDevice::Settings settings;
+    settings.vendorId = 0x16C0;
+    settings.productId = 0x0486;
+    settings.serialNumber = "STRESS";
+    auto virtualDevice = backend->addDevice(settings);
+
+    virtualDevice->setGetFeatureHandler([](uint8_t* data, std::size_t size) {
+        std::fill(data + 1, data + size, 0x55);
+        return int(size);
+    });
+
+    ofxIO::HIDDeviceInfo info(settings.vendorId, settings.productId);
+
+    ofxIO::HIDDevice device;
+    device.setReadTimeoutMillis(ofxIO::HIDDevice::INFINITE_TIMEOUT);
+
+    if (!device.setup(info))
+    {
+        ofLogError("ofApp::run") << "Unable to open the virtual device.";
+        return result;
+    }
+
+    std::atomic<bool> running(true);
+    std::atomic<uint64_t> reads(0);
+    std::atomic<uint64_t> writes(0);
+    std::atomic<uint64_t> features(0);
+    std::atomic<uint64_t> failures(0);
+
+    // Failed calls are expected while the device is closed.
+    ofLogLevel logLevel = ofGetLogLevel();
+    ofSetLogLevel(OF_LOG_FATAL_ERROR);
+
+    std::thread producer([&]() {
+        std::vector<uint8_t> report(64, 0xAA);
+
+        while (running)
+        {
+            virtualDevice->pushInputReport(report);
+            std::this_thread::sleep_for(std::chrono::microseconds(INPUT_INTERVAL_MICROS));
+        }
+    });
+
+    std::thread reader([&]() {
+        std::vector<uint8_t> report;
+
+        while (running)
+        {
+            if (device.read(report) > 0)
+            {
+                ++reads;
+            }
+            else
+            {
+                ++failures;
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    });
+
+    std::thread writer([&]() {
+        std::vector<uint8_t> report(64, 0x01);
+
+        while (running)
+        {
+            if (device.write(0x00, report) > -1)
+                ++writes;
+            else
+                ++failures;
+
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    std::thread feature([&]() {
+        std::vector<uint8_t> report(8, 0x02);
+        std::vector<uint8_t> response;
+
+        while (running)
+        {
+            if (device.writeFeatureReport(0x01, report) > -1
+             && device.readFeatureReport(0x01, response, 9) > -1)
+                ++features;
+            else
+                ++failures;
+
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    uint64_t startMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+    while (ofxIO::HIDDeviceUtils::monotonicTimeMicros() < startMicros + RUN_MICROS)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(CYCLE_MICROS));
+
+        uint64_t closeStart = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+        device.close();
+        result.maxCloseMicros = std::max(result.maxCloseMicros,
+                                         ofxIO::HIDDeviceUtils::monotonicTimeMicros() - closeStart);
+
+        // Alternate between both ways of opening a device.
+        if (result.cycles % 2 == 0)
+            device.setup(info);
+        else
+            device.setupWithPath(ofxIO::HIDDeviceUtils::listDevicesWithInfo(info).at(0));
+
+        ++result.cycles;
+    }
+
+    running = false;
+
+    // Wake the reader, which may be blocked in an infinite read.
+    device.close();
+
+    producer.join();
+    reader.join();
+    writer.join();
+    feature.join();
+
+    ofSetLogLevel(logLevel);
+
+    ofxIO::HIDBackend::set(nullptr);
+
+    result.reads = reads;
+    result.writes = writes;
+    result.features = features;
+    result.failures = failures;
+    result.opens = virtualDevice->opens();
+    result.closes = virtualDevice->closes();
+    return result;
+}
+
+
+void ofApp::setup()
+{
+    result = run();
+
+    ofLogNotice("ofApp::setup") << result.cycles << " close cycles, "
+                                << result.reads << " reads, "
+                                << result.writes << " writes, "
+                                << result.features << " feature exchanges, "
+                                << result.failures << " failed calls, "
+                                << "longest close " << result.maxCloseMicros << " us";
+
+    if (result.opens != result.closes)
+        ofLogError("ofApp::setup") << "Opened " << result.opens << " handles but closed " << result.closes << ".";
+    else
+        ofLogNotice("ofApp::setup") << "Opened and closed " << result.opens << " handles.";
+}
+
+
+void ofApp::draw()
+{
+    std::stringstream ss;
+    ss << "close cycles:       " << result.cycles << std::endl;
+    ss << "reads:              " << result.reads << std::endl;
+    ss << "writes:             " << result.writes << std::endl;
+    ss << "feature exchanges:  " << result.features << std::endl;
+    ss << "failed calls:       " << result.failures << std::endl;
+    ss << "longest close (us): " << result.maxCloseMicros << std::endl;
+    ss << "handles opened:     " << result.opens << std::endl;
+    ss << "handles closed:     " << result.closes << std::endl;
+
+    ofDrawBitmapString(ss.str(), 20, 20);
+}
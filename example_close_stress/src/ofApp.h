@@ -0,0 +1,76 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxHID.h"
+
+
+/// \brief Stresses HIDDevice close and reopen against calls in flight.
+///
+/// A HIDVirtualDevice stands in for hardware. Reader, writer and feature
+/// report threads call the HIDDevice continuously while another thread
+/// closes and reopens it. Reads use an infinite timeout, so close() must
+/// interrupt them.
+///
+/// config.make builds the app with ThreadSanitizer, which reports any data
+/// race between the threads. The app also checks that every handle opened
+/// on the virtual device was closed.
+class ofApp: public ofBaseApp
+{
+public:
+    /// \brief The counts from the stress run.
+    struct Result
+    {
+        /// \brief The number of close and reopen cycles.
+        uint64_t cycles = 0;
+
+        /// \brief The number of reads that returned a report.
+        uint64_t reads = 0;
+
+        /// \brief The number of successful writes.
+        uint64_t writes = 0;
+
+        /// \brief The number of successful feature report exchanges.
+        uint64_t features = 0;
+
+        /// \brief The number of calls that failed because the device was
+        ///        closed.
+        uint64_t failures = 0;
+
+        /// \brief The longest close() in microseconds.
+        uint64_t maxCloseMicros = 0;
+
+        /// \brief The number of handles opened on the virtual device.
+        uint64_t opens = 0;
+
+        /// \brief The number of handles closed on the virtual device.
+        uint64_t closes = 0;
+    };
+
+    void setup() override;
+    void draw() override;
+
+    /// \brief Run the stress test.
+    Result run();
+
+    /// \brief The length of the run in microseconds.
+    static const uint64_t RUN_MICROS;
+
+    /// \brief The time between close and reopen cycles in microseconds.
+    static const uint64_t CYCLE_MICROS;
+
+    /// \brief The time between pushed input reports in microseconds.
+    ///
+    /// Longer than a read slice, so reads are often blocked when closed.
+    static const uint64_t INPUT_INTERVAL_MICROS;
+
+    Result result;
+
+};
@@ -0,0 +1,585 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "VirtualDeviceHarness.h"
+#include <cstring>
+#include <fstream>
+#include <random>
+
+#if defined(TARGET_WIN32)
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+
+SlowVirtualBackend::SlowVirtualBackend(uint64_t stringLatencyMicros):
+    _stringLatencyMicros(stringLatencyMicros)
+{
+}
+
+
+hid_device_info* SlowVirtualBackend::enumerate(unsigned short vendorId,
+                                               unsigned short productId)
+{
+    hid_device_info* devices = HIDVirtualBackend::enumerate(vendorId, productId);
+
+    std::size_t count = 0;
+
+    for (hid_device_info* device = devices; device != nullptr; device = device->next)
+        ++count;
+
+    // Serial number, manufacturer and product for each device.
+    std::this_thread::sleep_for(std::chrono::microseconds(3 * count * _stringLatencyMicros));
+    return devices;
+}
+
+
+int SlowVirtualBackend::getSerialNumberString(hid_device* device,
+                                              wchar_t* string,
+                                              std::size_t maxLength)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(_stringLatencyMicros));
+    return HIDVirtualBackend::getSerialNumberString(device, string, maxLength);
+}
+
+
+int SlowVirtualBackend::getManufacturerString(hid_device* device,
+                                              wchar_t* string,
+                                              std::size_t maxLength)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(_stringLatencyMicros));
+    return HIDVirtualBackend::getManufacturerString(device, string, maxLength);
+}
+
+
+int SlowVirtualBackend::getProductString(hid_device* device,
+                                         wchar_t* string,
+                                         std::size_t maxLength)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(_stringLatencyMicros));
+    return HIDVirtualBackend::getProductString(device, string, maxLength);
+}
+
+
+const std::size_t VirtualDeviceHarness::STOP_THREADS = 64;
+
+
+VirtualDeviceHarness::VirtualDeviceHarness(): _running(false)
+{
+}
+
+
+VirtualDeviceHarness::~VirtualDeviceHarness()
+{
+    stop();
+}
+
+
+void VirtualDeviceHarness::start(const Settings& settings)
+{
+    stop();
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _results.clear();
+        _coldStartResult = ColdStartResult();
+    }
+
+    _running = true;
+    _thread = std::thread(&VirtualDeviceHarness::_run, this, settings);
+}
+
+
+void VirtualDeviceHarness::stop()
+{
+    _running = false;
+
+    if (_thread.joinable())
+        _thread.join();
+}
+
+
+bool VirtualDeviceHarness::isRunning() const
+{
+    return _running;
+}
+
+
+std::vector<VirtualDeviceHarness::Result> VirtualDeviceHarness::results() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _results;
+}
+
+
+VirtualDeviceHarness::ColdStartResult VirtualDeviceHarness::coldStartResult() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _coldStartResult;
+}
+
+
+std::string VirtualDeviceHarness::status() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _status;
+}
+
+
+void VirtualDeviceHarness::_run(Settings settings)
+{
+    if (settings.coldStartDeviceCount > 0)
+    {
+        ColdStartResult result = _runColdStart(settings);
+
+        ofLogNotice("VirtualDeviceHarness::_run") << result.deviceCount << " device cold start:"
+            << " enumerated " << result.enumerateMicros / 1000.0 << " ms,"
+            << " cached " << result.cachedMicros / 1000.0 << " ms,"
+            << " " << result.hits << " hits,"
+            << " " << result.misses << " misses";
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _coldStartResult = result;
+    }
+
+    for (std::size_t deviceCount: settings.deviceCounts)
+    {
+        if (!_running)
+            break;
+
+        Result result = _runCount(settings, deviceCount);
+
+        ofLogNotice("VirtualDeviceHarness::_run") << deviceCount << " devices:"
+            << " fetch " << result.fetchMicros / 1000.0 << " ms,"
+            << " open " << result.openMicros / 1000.0 << " ms,"
+            << " " << result.bytesPerDevice << " bytes/device,"
+            << " " << result.cpuMicrosPerDevice << " us CPU/device/s,"
+            << " p50 " << result.latency.percentileMicros(50) << " us,"
+            << " p99 " << result.latency.percentileMicros(99) << " us,"
+            << " p99.9 " << result.latency.percentileMicros(99.9) << " us";
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _results.push_back(result);
+    }
+
+    _setStatus("Done.");
+    _running = false;
+}
+
+
+VirtualDeviceHarness::Result VirtualDeviceHarness::_runCount(const Settings& settings,
+                                                             std::size_t deviceCount)
+{
+    Result result;
+    result.deviceCount = deviceCount;
+
+    std::mt19937 random(deviceCount);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    // Assign profiles by weight.
+    std::vector<double> weights;
+
+    for (const auto& profile: settings.profiles)
+        weights.push_back(profile.weight);
+
+    std::discrete_distribution<std::size_t> chooseProfile(weights.begin(), weights.end());
+
+    std::vector<std::size_t> profiles(deviceCount);
+
+    for (auto& profile: profiles)
+        profile = chooseProfile(random);
+
+    // Serve the devices from a virtual backend for the length of the run.
+    std::shared_ptr<ofxIO::HIDBackend> previousBackend = ofxIO::HIDBackend::get();
+    auto backend = std::make_shared<ofxIO::HIDVirtualBackend>();
+    ofxIO::HIDBackend::set(backend);
+
+    std::vector<std::shared_ptr<ofxIO::HIDVirtualDevice>> virtualDevices;
+
+    for (std::size_t i = 0; i < deviceCount; ++i)
+    {
+        const Profile& profile = settings.profiles[profiles[i]];
+
+        ofxIO::HIDVirtualDevice::Settings deviceSettings;
+        deviceSettings.vendorId = profile.vendorId;
+        deviceSettings.productId = profile.productId;
+        deviceSettings.serialNumber = profile.serialPrefix + ofToString(i);
+        deviceSettings.manufacturer = "Virtual";
+        deviceSettings.product = "Virtual Device";
+        deviceSettings.usagePage = profile.usagePage;
+        deviceSettings.usage = profile.usage;
+        deviceSettings.interfaceNumber = 0;
+        deviceSettings.path = "virtual:" + deviceSettings.serialNumber;
+
+        // The path carries the failure decision so the fetcher is stateless.
+        if (uniform(random) < settings.fetchFailureRate)
+            deviceSettings.path += "!";
+
+        virtualDevices.push_back(backend->addDevice(deviceSettings));
+    }
+
+    // Enumeration: fetch every device's strings in parallel.
+    _setStatus("Fetching strings from " + ofToString(deviceCount) + " devices.");
+
+    std::atomic<std::size_t> fetchFailures(0);
+
+    auto fetcher = [&](const ofxIO::HIDDeviceHandle& handle) {
+        // Simulate the USB control transfers, then open the device and read
+        // its strings as a hardware fetch would.
+        std::this_thread::sleep_for(std::chrono::microseconds(settings.fetchLatencyMicros));
+
+        if (handle.path().back() == '!')
+        {
+            ++fetchFailures;
+
+            ofxIO::HIDDeviceHandle::Strings strings;
+            strings.serialNumber = ofxIO::HIDDeviceInfo::UNDEFINED_SERIAL_NUMBER;
+            strings.manufacturer = ofxIO::HIDDeviceInfo::UNDEFINED_MANUFACTURER;
+            strings.product = ofxIO::HIDDeviceInfo::UNDEFINED_PRODUCT;
+            return strings;
+        }
+
+        return ofxIO::HIDDeviceHandle::fetchStringsFromDevice(handle);
+    };
+
+    uint64_t fetchStart = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+    std::vector<ofxIO::HIDDeviceHandle> handles = ofxIO::HIDDeviceUtils::listDeviceHandles(ofxIO::HIDDeviceInfo::UNDEFINED_VENDOR_ID,
+                                                                                           ofxIO::HIDDeviceInfo::UNDEFINED_PRODUCT_ID,
+                                                                                           fetcher);
+    ofxIO::HIDDeviceUtils::fetchStrings(handles, settings.fetchThreads);
+    result.fetchMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros() - fetchStart;
+    result.fetchFailures = fetchFailures;
+
+    // Memory: open the devices and construct their report pipelines.
+    _setStatus("Opening " + ofToString(deviceCount) + " devices.");
+
+    uint64_t residentStart = _residentBytes();
+    uint64_t openStart = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+    std::vector<std::unique_ptr<ofxIO::HIDDevice>> devices;
+    std::vector<std::unique_ptr<ofxIO::HIDReportBroadcaster>> broadcasters;
+    std::vector<std::unique_ptr<ofxIO::HIDReportSubscriber>> subscribers;
+
+    for (const auto& handle: handles)
+    {
+        auto device = std::make_unique<ofxIO::HIDDevice>();
+
+        if (!device->setupWithPath(handle.toDeviceInfo()))
+        {
+            ++result.openFailures;
+            continue;
+        }
+
+        device->setReadTimeoutMillis(settings.readTimeoutMillis);
+
+        devices.push_back(std::move(device));
+        broadcasters.push_back(std::make_unique<ofxIO::HIDReportBroadcaster>(*devices.back(), settings.ringCapacity));
+        subscribers.push_back(broadcasters.back()->subscribe());
+    }
+
+    result.openMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros() - openStart;
+
+    uint64_t residentEnd = _residentBytes();
+
+    if (residentStart > 0 && residentEnd > residentStart && deviceCount > 0)
+        result.bytesPerDevice = double(residentEnd - residentStart) / deviceCount;
+
+    for (auto& broadcaster: broadcasters)
+        broadcaster->start();
+
+    // Reports: one simulator thread pushes, the broadcasters read and
+    // publish, and one consumer thread drains.
+    _setStatus("Streaming reports from " + ofToString(deviceCount) + " devices.");
+
+    std::atomic<bool> streaming(true);
+    std::atomic<uint64_t> pushed(0);
+    std::atomic<uint64_t> stalls(0);
+
+    std::thread simulator([&]() {
+        std::mt19937 simulatorRandom(deviceCount + 1);
+        std::uniform_real_distribution<double> simulatorUniform(0, 1);
+
+        uint64_t now = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+        // Stagger the first reports across one interval.
+        std::vector<uint64_t> nextMicros(deviceCount);
+        std::vector<uint64_t> intervals(deviceCount);
+
+        for (std::size_t i = 0; i < deviceCount; ++i)
+        {
+            intervals[i] = uint64_t(1000000 / std::max(settings.profiles[profiles[i]].reportsPerSecond, 1.0));
+            nextMicros[i] = now + uint64_t(simulatorUniform(simulatorRandom) * intervals[i]);
+        }
+
+        std::vector<uint8_t> data;
+
+        while (streaming)
+        {
+            now = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+            bool idle = true;
+
+            for (std::size_t i = 0; i < deviceCount; ++i)
+            {
+                if (nextMicros[i] > now)
+                    continue;
+
+                data.assign(std::max(settings.profiles[profiles[i]].reportSize, std::size_t(9)), 0);
+                data[0] = uint8_t(pushed.load());
+
+                // Stamp each report as it is pushed. A sweep over thousands
+                // of devices takes long enough that a shared timestamp would
+                // hide the time spent reaching the later devices.
+                uint64_t pushMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+                std::memcpy(data.data() + 1, &pushMicros, sizeof(pushMicros));
+
+                virtualDevices[i]->pushInputReport(data);
+                ++pushed;
+                idle = false;
+
+                nextMicros[i] += intervals[i];
+
+                if (simulatorUniform(simulatorRandom) < settings.stallRate)
+                {
+                    nextMicros[i] += settings.stallMicros;
+                    ++stalls;
+                }
+            }
+
+            if (idle)
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    std::thread consumer([&]() {
+        ofxIO::HIDReportRing::SharedReport report;
+
+        while (streaming)
+        {
+            bool idle = true;
+
+            for (auto& subscriber: subscribers)
+            {
+                while (subscriber->tryRead(report))
+                {
+                    uint64_t now = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+                    if (report->data.size() >= 9)
+                    {
+                        uint64_t pushMicros = 0;
+                        std::memcpy(&pushMicros, report->data.data() + 1, sizeof(pushMicros));
+                        result.latency.record(now - pushMicros);
+                    }
+
+                    idle = false;
+                }
+            }
+
+            if (idle)
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    uint64_t wallStart = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+    uint64_t cpuStart = _cpuMicros();
+
+    while (_running && ofxIO::HIDDeviceUtils::monotonicTimeMicros() < wallStart + settings.runMicros)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    streaming = false;
+    simulator.join();
+    consumer.join();
+
+    uint64_t wallMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros() - wallStart;
+    uint64_t cpuMicros = _cpuMicros() - cpuStart;
+
+    if (deviceCount > 0 && wallMicros > 0)
+        result.cpuMicrosPerDevice = cpuMicros / (wallMicros / 1000000.0) / deviceCount;
+
+    result.pushed = pushed;
+    result.stalls = stalls;
+
+    for (const auto& broadcaster: broadcasters)
+        result.published += broadcaster->published();
+
+    for (const auto& subscriber: subscribers)
+    {
+        result.received += subscriber->received();
+        result.dropped += subscriber->dropped();
+    }
+
+    for (const auto& virtualDevice: virtualDevices)
+        result.deviceDropped += virtualDevice->droppedInputReports();
+
+    // Stop the pipelines and close the devices through the virtual backend.
+    _setStatus("Closing " + ofToString(deviceCount) + " devices.");
+
+    // Each broadcaster may be blocked in a read for up to the read timeout,
+    // so stop them in parallel rather than one after another.
+    std::atomic<std::size_t> nextStop(0);
+    std::vector<std::thread> stoppers;
+
+    for (std::size_t i = 0; i < std::min(STOP_THREADS, broadcasters.size()); ++i)
+    {
+        stoppers.push_back(std::thread([&]() {
+            std::size_t j = 0;
+
+            while ((j = nextStop++) < broadcasters.size())
+                broadcasters[j]->stop();
+        }));
+    }
+
+    for (auto& stopper: stoppers)
+        stopper.join();
+
+    subscribers.clear();
+    broadcasters.clear();
+    devices.clear();
+
+    uint64_t opens = 0;
+    uint64_t closes = 0;
+
+    for (const auto& virtualDevice: virtualDevices)
+    {
+        opens += virtualDevice->opens();
+        closes += virtualDevice->closes();
+    }
+
+    if (opens != closes)
+        ofLogError("VirtualDeviceHarness::_runCount") << "Opened " << opens << " handles but closed " << closes << ".";
+
+    ofxIO::HIDBackend::set(previousBackend);
+
+    return result;
+}
+
+
+VirtualDeviceHarness::ColdStartResult VirtualDeviceHarness::_runColdStart(const Settings& settings)
+{
+    ColdStartResult result;
+    result.deviceCount = settings.coldStartDeviceCount;
+
+    _setStatus("Opening " + ofToString(result.deviceCount) + " devices from a cold start.");
+
+    std::shared_ptr<ofxIO::HIDBackend> previousBackend = ofxIO::HIDBackend::get();
+    auto backend = std::make_shared<SlowVirtualBackend>(settings.fetchLatencyMicros / 3);
+    ofxIO::HIDBackend::set(backend);
+
+    const Profile& profile = settings.profiles.front();
+
+    std::vector<ofxIO::HIDDeviceInfo> queries;
+
+    for (std::size_t i = 0; i < result.deviceCount; ++i)
+    {
+        ofxIO::HIDVirtualDevice::Settings deviceSettings;
+        deviceSettings.vendorId = profile.vendorId;
+        deviceSettings.productId = profile.productId;
+        deviceSettings.serialNumber = profile.serialPrefix + ofToString(i);
+        deviceSettings.manufacturer = "Virtual";
+        deviceSettings.product = "Virtual Device";
+        deviceSettings.usagePage = profile.usagePage;
+        deviceSettings.usage = profile.usage;
+        deviceSettings.interfaceNumber = 0;
+        backend->addDevice(deviceSettings);
+
+        queries.push_back(ofxIO::HIDDeviceInfo(profile.vendorId,
+                                               profile.productId,
+                                               deviceSettings.serialNumber));
+    }
+
+    std::vector<std::unique_ptr<ofxIO::HIDDevice>> devices(result.deviceCount);
+
+    for (auto& device: devices)
+        device = std::make_unique<ofxIO::HIDDevice>();
+
+    // The first launch has no registry, so each open enumerates.
+    ofxIO::HIDDeviceRegistry firstLaunch;
+
+    uint64_t startMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+    for (std::size_t i = 0; i < devices.size(); ++i)
+    {
+        if (!firstLaunch.open(*devices[i], queries[i]))
+            ++result.openFailures;
+    }
+
+    result.enumerateMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros() - startMicros;
+
+    for (auto& device: devices)
+        device->close();
+
+    // The next launch loads the registry saved by the first.
+    ofxIO::HIDDeviceRegistry nextLaunch;
+    nextLaunch.fromJSON(firstLaunch.toJSON());
+
+    startMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+    for (std::size_t i = 0; i < devices.size(); ++i)
+    {
+        if (!nextLaunch.open(*devices[i], queries[i]))
+            ++result.openFailures;
+    }
+
+    result.cachedMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros() - startMicros;
+    result.hits = nextLaunch.hits();
+    result.misses = nextLaunch.misses();
+
+    devices.clear();
+
+    ofxIO::HIDBackend::set(previousBackend);
+
+    return result;
+}
+
+
+void VirtualDeviceHarness::_setStatus(const std::string& status)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _status = status;
+}
+
+
+uint64_t VirtualDeviceHarness::_residentBytes()
+{
+#if defined(TARGET_LINUX)
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+
+    if (statm >> size >> resident)
+        return resident * uint64_t(sysconf(_SC_PAGESIZE));
+#endif
+
+    return 0;
+}
+
+
+uint64_t VirtualDeviceHarness::_cpuMicros()
+{
+#if defined(TARGET_WIN32)
+    FILETIME creation, exit, kernel, user;
+
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        return 0;
+
+    auto toMicros = [](const FILETIME& time) {
+        return ((uint64_t(time.dwHighDateTime) << 32) | time.dwLowDateTime) / 10;
+    };
+
+    return toMicros(kernel) + toMicros(user);
+#else
+    rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+    return uint64_t(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+         + uint64_t(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+#endif
+}
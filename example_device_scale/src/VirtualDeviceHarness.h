@@ -0,0 +1,268 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "ofMain.h"
+#include "ofxHID.h"
+
+
+/// \brief A virtual backend whose enumeration and string reads are slow.
+///
+/// On some platforms hid_enumerate() reads every device's string
+/// descriptors, and each string costs a USB control transfer.
+class SlowVirtualBackend: public ofxIO::HIDVirtualBackend
+{
+public:
+    /// \brief Create a SlowVirtualBackend.
+    /// \param stringLatencyMicros The time to read one string.
+    SlowVirtualBackend(uint64_t stringLatencyMicros);
+
+    hid_device_info* enumerate(unsigned short vendorId,
+                               unsigned short productId) override;
+
+    int getSerialNumberString(hid_device* device,
+                              wchar_t* string,
+                              std::size_t maxLength) override;
+
+    int getManufacturerString(hid_device* device,
+                              wchar_t* string,
+                              std::size_t maxLength) override;
+
+    int getProductString(hid_device* device,
+                         wchar_t* string,
+                         std::size_t maxLength) override;
+
+private:
+    /// \brief The time to read one string.
+    uint64_t _stringLatencyMicros = 0;
+
+};
+
+
+/// \brief Drives the library with thousands of simulated devices.
+///
+/// The devices are served by a HIDVirtualBackend, so they are enumerated,
+/// opened, read and closed through the same calls as hardware. A simulator
+/// thread pushes input reports into the virtual devices, each device's
+/// HIDReportBroadcaster reads and publishes them, and a consumer thread
+/// drains the subscribers. This exercises parallel string fetching, device
+/// setup and the report pipeline at scale without hardware.
+///
+/// Before the device counts, the harness measures a cold start: opening a
+/// set of devices by serial number with an empty HIDDeviceRegistry, then
+/// again with the registry saved by the first launch.
+class VirtualDeviceHarness
+{
+public:
+    /// \brief A kind of virtual device.
+    struct Profile
+    {
+        /// \brief The Vendor ID.
+        uint16_t vendorId = 0x16C0;
+
+        /// \brief The product ID.
+        uint16_t productId = 0x0486;
+
+        /// \brief The top level usage page.
+        uint16_t usagePage = 0xFFAB;
+
+        /// \brief The top level usage.
+        uint16_t usage = 0x0200;
+
+        /// \brief The serial number prefix, followed by the device index.
+        std::string serialPrefix = "VIRTUAL";
+
+        /// \brief The share of devices using this profile.
+        double weight = 1;
+
+        /// \brief The input report rate.
+        double reportsPerSecond = 250;
+
+        /// \brief The input report size in bytes.
+        ///
+        /// Reports carry their push time, so at least 9 bytes are sent.
+        std::size_t reportSize = 64;
+    };
+
+    /// \brief Harness settings.
+    struct Settings
+    {
+        /// \brief The device counts to run, in order.
+        std::vector<std::size_t> deviceCounts = { 10, 100, 1000, 4000 };
+
+        /// \brief The device profiles.
+        std::vector<Profile> profiles = { Profile() };
+
+        /// \brief The simulated time to fetch one device's strings.
+        uint64_t fetchLatencyMicros = 2000;
+
+        /// \brief The probability that fetching a device's strings fails.
+        double fetchFailureRate = 0.01;
+
+        /// \brief The number of string fetch threads, or 0 for the default.
+        std::size_t fetchThreads = 0;
+
+        /// \brief The probability that a report is followed by a stall.
+        double stallRate = 0.0001;
+
+        /// \brief The length of a stall in microseconds.
+        uint64_t stallMicros = 500000;
+
+        /// \brief The length of each report pipeline run in microseconds.
+        uint64_t runMicros = 2000000;
+
+        /// \brief The read timeout of each device in milliseconds.
+        uint64_t readTimeoutMillis = 100;
+
+        /// \brief The number of reports retained for each subscriber.
+        std::size_t ringCapacity = 64;
+
+        /// \brief The number of devices opened in the cold start run, or 0
+        ///        to skip it.
+        std::size_t coldStartDeviceCount = 40;
+    };
+
+    /// \brief The measurements for the cold start run.
+    struct ColdStartResult
+    {
+        /// \brief The number of virtual devices.
+        std::size_t deviceCount = 0;
+
+        /// \brief The wall time to open every device with an empty registry.
+        uint64_t enumerateMicros = 0;
+
+        /// \brief The wall time to open every device with a saved registry.
+        uint64_t cachedMicros = 0;
+
+        /// \brief The number of opens that used a cached path.
+        uint64_t hits = 0;
+
+        /// \brief The number of opens that needed an enumeration.
+        uint64_t misses = 0;
+
+        /// \brief The number of devices that failed to open.
+        std::size_t openFailures = 0;
+    };
+
+    /// \brief The measurements for one device count.
+    struct Result
+    {
+        /// \brief The number of virtual devices.
+        std::size_t deviceCount = 0;
+
+        /// \brief The wall time to fetch all device strings.
+        uint64_t fetchMicros = 0;
+
+        /// \brief The number of devices whose string fetch failed.
+        std::size_t fetchFailures = 0;
+
+        /// \brief The wall time to open every device.
+        uint64_t openMicros = 0;
+
+        /// \brief The number of devices that failed to open.
+        std::size_t openFailures = 0;
+
+        /// \brief The resident memory added per device, or 0 if unknown.
+        double bytesPerDevice = 0;
+
+        /// \brief The process CPU time per device per second of wall time.
+        double cpuMicrosPerDevice = 0;
+
+        /// \brief The number of reports pushed into the virtual devices.
+        uint64_t pushed = 0;
+
+        /// \brief The number of reports published by the broadcasters.
+        uint64_t published = 0;
+
+        /// \brief The number of reports received by subscribers.
+        uint64_t received = 0;
+
+        /// \brief The number of reports subscribers fell too far behind to read.
+        uint64_t dropped = 0;
+
+        /// \brief The number of reports dropped by full device queues.
+        uint64_t deviceDropped = 0;
+
+        /// \brief The number of injected stalls.
+        uint64_t stalls = 0;
+
+        /// \brief The time from push to receipt.
+        ofxIO::HIDLatencyHistogram latency;
+    };
+
+    /// \brief Create a VirtualDeviceHarness.
+    VirtualDeviceHarness();
+
+    /// \brief Destroy the VirtualDeviceHarness, stopping any run.
+    ~VirtualDeviceHarness();
+
+    /// \brief Run every device count on a background thread.
+    /// \param settings The harness settings.
+    void start(const Settings& settings);
+
+    /// \brief Stop the run and wait for it to exit.
+    void stop();
+
+    /// \returns true while the harness is running.
+    bool isRunning() const;
+
+    /// \returns the results of the completed device counts.
+    std::vector<Result> results() const;
+
+    /// \returns the cold start result, or an empty result if it has not
+    ///          completed.
+    ColdStartResult coldStartResult() const;
+
+    /// \returns a description of the current stage.
+    std::string status() const;
+
+private:
+    /// \brief The number of threads used to stop the broadcasters.
+    static const std::size_t STOP_THREADS;
+
+    /// \brief Run every device count.
+    void _run(Settings settings);
+
+    /// \brief Run a single device count.
+    Result _runCount(const Settings& settings, std::size_t deviceCount);
+
+    /// \brief Measure opening devices with and without a saved registry.
+    ColdStartResult _runColdStart(const Settings& settings);
+
+    /// \brief Set the status.
+    void _setStatus(const std::string& status);
+
+    /// \returns the resident memory of the process in bytes, or 0 if unknown.
+    static uint64_t _residentBytes();
+
+    /// \returns the CPU time used by the process in microseconds.
+    static uint64_t _cpuMicros();
+
+    /// \brief The completed results.
+    std::vector<Result> _results;
+
+    /// \brief The cold start result.
+    ColdStartResult _coldStartResult;
+
+    /// \brief The current stage.
+    std::string _status;
+
+    /// \brief True while the harness should keep running.
+    std::atomic<bool> _running;
+
+    /// \brief The harness thread.
+    std::thread _thread;
+
+    /// \brief The mutex protecting the results and status.
+    mutable std::mutex _mutex;
+
+};
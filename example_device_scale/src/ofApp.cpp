@@ -0,0 +1,74 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofApp.h"
+
+
+void ofApp::setup()
+{
+    VirtualDeviceHarness::Settings settings;
+
+    // A mix of RawHID boards and a second, chattier sensor board.
+    VirtualDeviceHarness::Profile rawHID;
+    rawHID.weight = 3;
+
+    VirtualDeviceHarness::Profile sensor;
+    sensor.vendorId = 0x1209;
+    sensor.productId = 0x0001;
+    sensor.usagePage = 0xFF00;
+    sensor.usage = 0x0001;
+    sensor.serialPrefix = "SENSOR";
+    sensor.reportsPerSecond = 1000;
+    sensor.reportSize = 32;
+
+    settings.profiles = { rawHID, sensor };
+
+    harness.start(settings);
+}
+
+
+void ofApp::exit()
+{
+    harness.stop();
+}
+
+
+void ofApp::draw()
+{
+    std::stringstream ss;
+    ss << harness.status() << std::endl << std::endl;
+
+    auto coldStart = harness.coldStartResult();
+
+    if (coldStart.deviceCount > 0)
+    {
+        ss << "Cold start, " << coldStart.deviceCount << " devices: "
+           << ofToString(coldStart.enumerateMicros / 1000.0, 1) << " ms enumerating, "
+           << ofToString(coldStart.cachedMicros / 1000.0, 1) << " ms from the registry ("
+           << coldStart.hits << " hits, " << coldStart.misses << " misses)"
+           << std::endl << std::endl;
+    }
+
+    ss << "devices  fetch ms  fail  open ms  bytes/dev  CPU us/dev/s  p50 us  p99 us  p99.9 us  dropped" << std::endl;
+
+    for (const auto& result: harness.results())
+    {
+        ss << ofToString(result.deviceCount, 7, ' ')
+           << ofToString(result.fetchMicros / 1000.0, 1, 10, ' ')
+           << ofToString(result.fetchFailures, 6, ' ')
+           << ofToString(result.openMicros / 1000.0, 1, 9, ' ')
+           << ofToString(result.bytesPerDevice, 0, 11, ' ')
+           << ofToString(result.cpuMicrosPerDevice, 1, 14, ' ')
+           << ofToString(result.latency.percentileMicros(50), 8, ' ')
+           << ofToString(result.latency.percentileMicros(99), 8, ' ')
+           << ofToString(result.latency.percentileMicros(99.9), 10, ' ')
+           << ofToString(result.dropped + result.deviceDropped, 9, ' ')
+           << std::endl;
+    }
+
+    ofDrawBitmapString(ss.str(), 20, 20);
+}
@@ -0,0 +1,182 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofApp.h"
+#include <iomanip>
+
+
+SlowStringBackend::SlowStringBackend(uint64_t latencyMicros):
+    _latencyMicros(latencyMicros)
+{
+}
+
+
+int SlowStringBackend::getSerialNumberString(hid_device* device,
+                                             wchar_t* string,
+                                             std::size_t maxLength)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(_latencyMicros));
+    return HIDVirtualBackend::getSerialNumberString(device, string, maxLength);
+}
+
+
+int SlowStringBackend::getManufacturerString(hid_device* device,
+                                             wchar_t* string,
+                                             std::size_t maxLength)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(_latencyMicros));
+    return HIDVirtualBackend::getManufacturerString(device, string, maxLength);
+}
+
+
+int SlowStringBackend::getProductString(hid_device* device,
+                                        wchar_t* string,
+                                        std::size_t maxLength)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(_latencyMicros));
+    return HIDVirtualBackend::getProductString(device, string, maxLength);
+}
+
+
+const std::size_t ofApp::DEVICE_COUNT = 64;
+const uint64_t ofApp::STRING_LATENCY_MICROS = 2000;
+const std::size_t ofApp::LIST_CALLS = 1000;
+
+
+ofApp::Result ofApp::run(const std::string& name, std::size_t threadCount)
+{
+    Result result;
+    result.name = name;
+
+    uint64_t startMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+    auto handles = ofxIO::HIDDeviceUtils::listDeviceHandles(ofxIO::HIDDeviceInfo::UNDEFINED_VENDOR_ID,
+                                                            ofxIO::HIDDeviceInfo::UNDEFINED_PRODUCT_ID,
+                                                            ofxIO::HIDDeviceHandle::fetchStringsFromDevice);
+
+    result.handleMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros() - startMicros;
+
+    if (threadCount == 0)
+    {
+        // Only the device the application is looking for.
+        if (!handles.empty())
+            handles[0].strings();
+    }
+    else
+    {
+        ofxIO::HIDDeviceUtils::fetchStrings(handles, threadCount);
+    }
+
+    result.totalMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros() - startMicros;
+
+    for (const auto& handle: handles)
+    {
+        if (handle.hasStrings())
+            ++result.fetched;
+    }
+
+    return result;
+}
+
+
+ofApp::ListResult ofApp::list(const std::string& name)
+{
+    ListResult result;
+    result.name = name;
+
+    uint64_t startMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+    for (std::size_t i = 0; i < LIST_CALLS; ++i)
+        result.devices = ofxIO::HIDDeviceUtils::listDevices().size();
+
+    uint64_t elapsedMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros() - startMicros;
+    result.microsPerCall = double(elapsedMicros) / LIST_CALLS;
+    return result;
+}
+
+
+void ofApp::setup()
+{
+    // The hidapi backend lists whatever is attached.
+    listResults.push_back(list("hidapi"));
+
+    auto backend = std::make_shared<SlowStringBackend>(STRING_LATENCY_MICROS);
+    ofxIO::HIDBackend::set(backend);
+
+    for (std::size_t i = 0; i < DEVICE_COUNT; ++i)
+    {
+        ofxIO::HIDVirtualDevice::Settings settings;
+        settings.vendorId = 0x16C0;
+        settings.productId = 0x0486;
+        settings.serialNumber = ofToString(1000000 + i);
+        settings.manufacturer = "Teensyduino";
+        settings.product = "RawHID";
+        backend->addDevice(settings);
+    }
+
+    results.push_back(run("eager, serial", 1));
+    results.push_back(run("lazy, one device", 0));
+    results.push_back(run("parallel, 4 threads", 4));
+    results.push_back(run("parallel, 16 threads", 16));
+    results.push_back(run("parallel, 64 threads", 64));
+
+    // Plain virtual devices report their strings during enumeration, as
+    // hidapi does.
+    auto virtualBackend = std::make_shared<ofxIO::HIDVirtualBackend>();
+
+    for (const auto& device: backend->devices())
+        virtualBackend->addDevice(device->settings());
+
+    ofxIO::HIDBackend::set(virtualBackend);
+    listResults.push_back(list("virtual"));
+
+    ofxIO::HIDBackend::set(nullptr);
+
+    for (const auto& result: listResults)
+    {
+        ofLogNotice("ofApp::setup") << "listDevices() with the " << result.name << " backend: "
+                                    << result.devices << " devices in "
+                                    << ofToString(result.microsPerCall, 1) << " us";
+    }
+
+    for (const auto& result: results)
+    {
+        ofLogNotice("ofApp::setup") << result.name << ": "
+                                    << "handles in " << ofToString(result.handleMicros / 1000.0, 2) << " ms, "
+                                    << "strings of " << result.fetched << " devices in "
+                                    << ofToString(result.totalMicros / 1000.0, 1) << " ms";
+    }
+}
+
+
+void ofApp::draw()
+{
+    std::stringstream ss;
+    ss << DEVICE_COUNT << " devices, " << STRING_LATENCY_MICROS / 1000.0 << " ms per string" << std::endl << std::endl;
+    ss << "run                   handles ms  fetched  total ms" << std::endl;
+
+    for (const auto& result: results)
+    {
+        ss << std::left << std::setw(22) << result.name << std::right
+           << ofToString(result.handleMicros / 1000.0, 2, 11, ' ')
+           << ofToString(result.fetched, 9, ' ')
+           << ofToString(result.totalMicros / 1000.0, 1, 10, ' ')
+           << std::endl;
+    }
+
+    ss << std::endl << "listDevices()         devices  us/call" << std::endl;
+
+    for (const auto& result: listResults)
+    {
+        ss << std::left << std::setw(22) << result.name << std::right
+           << ofToString(result.devices, 8, ' ')
+           << ofToString(result.microsPerCall, 1, 9, ' ')
+           << std::endl;
+    }
+
+    ofDrawBitmapString(ss.str(), 20, 20);
+}
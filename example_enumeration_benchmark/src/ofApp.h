@@ -0,0 +1,113 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxHID.h"
+
+
+/// \brief A virtual backend whose string descriptors are slow to read.
+///
+/// On some platforms each string costs a USB control transfer.
+class SlowStringBackend: public ofxIO::HIDVirtualBackend
+{
+public:
+    /// \brief Create a SlowStringBackend.
+    /// \param latencyMicros The time to read one string.
+    SlowStringBackend(uint64_t latencyMicros);
+
+    int getSerialNumberString(hid_device* device,
+                              wchar_t* string,
+                              std::size_t maxLength) override;
+
+    int getManufacturerString(hid_device* device,
+                              wchar_t* string,
+                              std::size_t maxLength) override;
+
+    int getProductString(hid_device* device,
+                         wchar_t* string,
+                         std::size_t maxLength) override;
+
+private:
+    /// \brief The time to read one string.
+    uint64_t _latencyMicros = 0;
+
+};
+
+
+/// \brief Compares eager and lazy device enumeration over a slow backend.
+///
+/// Handles are enumerated with HIDDeviceHandle::fetchStringsFromDevice(),
+/// so each device's strings are read through the slow backend. The eager
+/// run fetches every string serially, as enumeration did before handles
+/// were added. The other runs return handles first, then fetch one device's
+/// strings or all strings on a worker pool.
+///
+/// It also times HIDDeviceUtils::listDevices(), which HIDDevice::setup()
+/// uses, with the hidapi backend and with a virtual backend whose strings
+/// are read during enumeration.
+class ofApp: public ofBaseApp
+{
+public:
+    /// \brief The result of one run.
+    struct Result
+    {
+        /// \brief The name of the run.
+        std::string name;
+
+        /// \brief The time until handles were returned in microseconds.
+        uint64_t handleMicros = 0;
+
+        /// \brief The time until the needed strings were fetched in
+        ///        microseconds.
+        uint64_t totalMicros = 0;
+
+        /// \brief The number of devices whose strings were fetched.
+        std::size_t fetched = 0;
+    };
+
+    /// \brief The result of timing listDevices().
+    struct ListResult
+    {
+        /// \brief The name of the backend.
+        std::string name;
+
+        /// \brief The number of devices listed.
+        std::size_t devices = 0;
+
+        /// \brief The mean time per call in microseconds.
+        double microsPerCall = 0;
+    };
+
+    void setup() override;
+    void draw() override;
+
+    /// \brief Enumerate the devices and fetch their strings.
+    /// \param name The name of the run.
+    /// \param threadCount The fetch threads, or 0 to fetch only the first
+    ///        device's strings.
+    Result run(const std::string& name, std::size_t threadCount);
+
+    /// \brief Time listDevices() with the installed backend.
+    /// \param name The name of the backend.
+    ListResult list(const std::string& name);
+
+    /// \brief The number of virtual devices.
+    static const std::size_t DEVICE_COUNT;
+
+    /// \brief The time to read one string in microseconds.
+    static const uint64_t STRING_LATENCY_MICROS;
+
+    /// \brief The number of listDevices() calls to time.
+    static const std::size_t LIST_CALLS;
+
+    std::vector<Result> results;
+    std::vector<ListResult> listResults;
+
+};
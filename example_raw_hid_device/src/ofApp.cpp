@@ -15,20 +15,24 @@ void ofApp::setup()
 //    auto devices = ofxIO::HIDDeviceUtils::listDevices();
     auto devices = ofxIO::HIDDeviceUtils::listDevicesWithVendorAndProductIds(5824, 1158);
 
-    for (const auto& device: devices)
+    for (const auto& info: devices)
     {
-        std::cout << device.toJSON().dump(4) << std::endl;
-
-        ofxIO::HIDDevice _device;
-
-        if (_device.setup(device))
-        {
-            std::cout << "Success." << std::endl;
-        }
-        else
-        {
-            std::cout << "Failed." << std::endl;
-        }
+        std::cout << info.toJSON().dump(4) << std::endl;
+    }
+
+    if (!devices.empty() && device.setup(devices[0]))
+    {
+        std::cout << "Success." << std::endl;
+
+        // Read reports in the background and receive them once per frame.
+        broadcaster = std::make_unique<ofxIO::HIDReportBroadcaster>(device);
+        dispatcher.addDevice(*broadcaster);
+        ofAddListener(dispatcher.onReports, this, &ofApp::onHIDReports);
+        broadcaster->start();
+    }
+    else
+    {
+        std::cout << "Failed." << std::endl;
     }
 
 
@@ -115,10 +119,38 @@ void ofApp::setup()
 
 void ofApp::exit()
 {
+    ofRemoveListener(dispatcher.onReports, this, &ofApp::onHIDReports);
+
+    if (broadcaster)
+    {
+        dispatcher.removeDevice(*broadcaster);
+        broadcaster->stop();
+    }
 }
 
 
 void ofApp::draw()
 {
+    std::stringstream ss;
+    ss << "Reports this frame: " << lastBatchSize << std::endl;
+    ss << "Reports delivered: " << dispatcher.delivered() << std::endl;
+    ss << "Reports dropped: " << dispatcher.dropped() << std::endl;
+    ss << "Last report:";
+
+    for (auto byte: lastReport)
+        ss << " " << ofToHex(byte);
+
+    ofDrawBitmapString(ss.str(), 20, 20);
+
+    // Batches only arrive on frames with reports, so start the next frame at zero.
+    lastBatchSize = 0;
+}
+
+
+void ofApp::onHIDReports(ofxIO::HIDReportDispatcher::Batch& batch)
+{
+    lastBatchSize = batch.entries.size();
 
+    if (!batch.entries.empty())
+        lastReport = batch.entries.back().report->data;
 }
@@ -19,4 +19,13 @@ public:
     void draw() override;
     void exit() override;
 
+    void onHIDReports(ofxIO::HIDReportDispatcher::Batch& batch);
+
+    ofxIO::HIDDevice device;
+    std::unique_ptr<ofxIO::HIDReportBroadcaster> broadcaster;
+    ofxIO::HIDReportDispatcher dispatcher;
+
+    std::size_t lastBatchSize = 0;
+    std::vector<uint8_t> lastReport;
+
 };
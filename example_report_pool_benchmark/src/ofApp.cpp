@@ -0,0 +1,185 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofApp.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <new>
+
+
+namespace {
+
+
+std::atomic<uint64_t> allocationCount(0);
+
+
+} // namespace
+
+
+void* operator new(std::size_t size)
+{
+    ++allocationCount;
+
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+
+const std::size_t ofApp::REPORT_COUNT = 1000000;
+const std::size_t ofApp::REPORT_SIZE = 64;
+const std::size_t ofApp::QUEUE_CAPACITY = 128;
+
+
+template<typename ReportT, typename MakeT, typename ConsumeT>
+ofApp::Result ofApp::run(const std::string& name, MakeT make, ConsumeT consume)
+{
+    // A bounded ring, allocated before counting starts.
+    std::vector<ReportT> queue(QUEUE_CAPACITY);
+    std::size_t head = 0;
+    std::size_t tail = 0;
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    Result result;
+    result.name = name;
+    result.reports = REPORT_COUNT;
+
+    uint64_t allocationsBefore = allocationCount;
+    uint64_t startMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+    std::thread consumer([&]() {
+        for (std::size_t i = 0; i < REPORT_COUNT; ++i)
+        {
+            ReportT report;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [&]() { return tail != head; });
+                report = std::move(queue[tail % QUEUE_CAPACITY]);
+                ++tail;
+            }
+
+            condition.notify_all();
+            consume(report);
+        }
+    });
+
+    for (std::size_t i = 0; i < REPORT_COUNT; ++i)
+    {
+        ReportT report;
+
+        // Wait for the consumer to return reports if the pool runs dry.
+        while (!make(report, i))
+            std::this_thread::yield();
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&]() { return head - tail < QUEUE_CAPACITY; });
+            queue[head % QUEUE_CAPACITY] = std::move(report);
+            ++head;
+        }
+
+        condition.notify_all();
+    }
+
+    consumer.join();
+
+    uint64_t elapsedMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros() - startMicros;
+
+    // The consumer thread itself allocates once or twice.
+    result.allocations = allocationCount - allocationsBefore;
+    result.reportsPerSecond = REPORT_COUNT * 1000000.0 / std::max<uint64_t>(elapsedMicros, 1);
+    return result;
+}
+
+
+void ofApp::setup()
+{
+    // The raw bytes a reader thread received.
+    std::vector<uint8_t> received(REPORT_SIZE);
+
+    for (std::size_t i = 0; i < received.size(); ++i)
+        received[i] = uint8_t(i);
+
+    uint64_t checksum = 0;
+
+    // The vector path: copy each report into a new shared HIDReport.
+    results.push_back(run<std::shared_ptr<const ofxIO::HIDReport>>("shared HIDReport",
+        [&](std::shared_ptr<const ofxIO::HIDReport>& report, std::size_t i) {
+            auto copy = std::make_shared<ofxIO::HIDReport>();
+            copy->data.assign(received.begin(), received.end());
+            copy->timestampMicros = i;
+            report = std::move(copy);
+            return true;
+        },
+        [&](const std::shared_ptr<const ofxIO::HIDReport>& report) {
+            checksum += report->data[report->data.size() - 1];
+        }));
+
+    // The pooled path: copy each report into a recycled slab.
+    ofxIO::HIDReportPool pool(QUEUE_CAPACITY * 2, REPORT_SIZE);
+
+    results.push_back(run<ofxIO::HIDReportHandle>("pooled HIDReportHandle",
+        [&](ofxIO::HIDReportHandle& report, std::size_t i) {
+            report = pool.acquire();
+
+            if (!report)
+                return false;
+
+            std::memcpy(report->data(), received.data(), received.size());
+            report->setSize(received.size());
+            report->timestampMicros = i;
+            return true;
+        },
+        [&](const ofxIO::HIDReportHandle& report) {
+            checksum += report->data()[report->size() - 1];
+        }));
+
+    for (const auto& result: results)
+    {
+        ofLogNotice("ofApp::setup") << result.name << ": "
+                                    << result.allocations << " allocations for "
+                                    << result.reports << " reports, "
+                                    << ofToString(result.reportsPerSecond / 1e6, 2) << " M reports/s";
+    }
+
+    ofLogVerbose("ofApp::setup") << "Checksum: " << checksum;
+}
+
+
+void ofApp::draw()
+{
+    std::stringstream ss;
+    ss << "path                       allocations   M reports/s" << std::endl;
+
+    for (const auto& result: results)
+    {
+        ss << std::left << std::setw(24) << result.name << std::right
+           << ofToString(result.allocations, 14, ' ')
+           << ofToString(result.reportsPerSecond / 1e6, 2, 14, ' ')
+           << std::endl;
+    }
+
+    ofDrawBitmapString(ss.str(), 20, 20);
+}
@@ -0,0 +1,62 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxHID.h"
+
+
+/// \brief Compares pooled report handles with copied vector reports.
+///
+/// A producer thread fills reports and hands them to a consumer thread
+/// through a fixed-size queue, as a reader thread would hand them to a
+/// pipeline stage. Allocations are counted by replacing the global operator
+/// new, so the counts include every allocation made by either path.
+class ofApp: public ofBaseApp
+{
+public:
+    /// \brief The result of one benchmark run.
+    struct Result
+    {
+        /// \brief The name of the path.
+        std::string name;
+
+        /// \brief The number of reports handed off.
+        std::size_t reports = 0;
+
+        /// \brief The number of heap allocations during the run.
+        uint64_t allocations = 0;
+
+        /// \brief The handoff throughput in reports per second.
+        double reportsPerSecond = 0;
+    };
+
+    void setup() override;
+    void draw() override;
+
+    /// \brief Hand reports off between two threads.
+    ///
+    /// \param name The name of the path.
+    /// \param make Fills the next report, returning false if none is available.
+    /// \param consume Reads a report on the consumer thread.
+    template<typename ReportT, typename MakeT, typename ConsumeT>
+    static Result run(const std::string& name, MakeT make, ConsumeT consume);
+
+    /// \brief The number of reports handed off per run.
+    static const std::size_t REPORT_COUNT;
+
+    /// \brief The report size in bytes, a full-speed RawHID report.
+    static const std::size_t REPORT_SIZE;
+
+    /// \brief The handoff queue capacity.
+    static const std::size_t QUEUE_CAPACITY;
+
+    std::vector<Result> results;
+
+};
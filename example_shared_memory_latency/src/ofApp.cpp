@@ -0,0 +1,202 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofApp.h"
+
+
+#if !defined(TARGET_WIN32)
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+
+const std::size_t ofApp::REPORT_COUNT = 20000;
+const uint64_t ofApp::REPORT_INTERVAL_MICROS = 100;
+const std::size_t ofApp::REPORT_SIZE = 64;
+const uint8_t ofApp::LAST_REPORT_MARKER = 0xFF;
+const uint64_t ofApp::READER_TIMEOUT_MICROS = 1000000;
+
+
+void ofApp::runReader(const std::string& name, int readyFd, int resultFd)
+{
+#if !defined(TARGET_WIN32)
+    Result readerResult;
+
+    ofxIO::HIDSharedMemoryReader reader;
+    bool opened = reader.open(name);
+
+    char ready = opened ? 1 : 0;
+
+    if (::write(readyFd, &ready, 1) != 1 || !opened)
+        return;
+
+    ofxIO::HIDLatencyHistogram latency;
+    ofxIO::HIDSharedMemoryReader::View view;
+
+    uint64_t lastReportMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+    while (true)
+    {
+        if (!reader.peek(view))
+        {
+            // Give the writer the CPU on single core machines.
+            std::this_thread::yield();
+
+            if (ofxIO::HIDDeviceUtils::monotonicTimeMicros() > lastReportMicros + READER_TIMEOUT_MICROS)
+                break;
+
+            continue;
+        }
+
+        uint64_t now = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+        bool last = view.size > 0 && view.data[0] == LAST_REPORT_MARKER;
+        uint64_t stampMicros = view.timestampMicros;
+
+        if (reader.release(view))
+            latency.record(now - stampMicros);
+
+        lastReportMicros = now;
+
+        if (last)
+            break;
+    }
+
+    readerResult.received = latency.count();
+    readerResult.dropped = reader.dropped();
+    readerResult.p50Micros = latency.percentileMicros(50);
+    readerResult.p99Micros = latency.percentileMicros(99);
+    readerResult.maxMicros = latency.maxMicros();
+
+    if (::write(resultFd, &readerResult, sizeof(readerResult)) != ssize_t(sizeof(readerResult)))
+        return;
+#else
+    (void)name;
+    (void)readyFd;
+    (void)resultFd;
+#endif
+}
+
+
+void ofApp::setup()
+{
+#if !defined(TARGET_WIN32)
+    const std::string name = "/ofxHID-latency-" + ofToString(getpid());
+
+    ofxIO::HIDSharedMemoryWriter writer;
+
+    if (!writer.open(name, ofxIO::HIDSharedMemoryWriter::DEFAULT_SLOT_COUNT, REPORT_SIZE))
+    {
+        ofLogError("ofApp::setup") << "Unable to create the ring " << name;
+        return;
+    }
+
+    int readyPipe[2];
+    int resultPipe[2];
+
+    if (pipe(readyPipe) != 0 || pipe(resultPipe) != 0)
+    {
+        ofLogError("ofApp::setup") << "Unable to create pipes.";
+        return;
+    }
+
+    pid_t pid = fork();
+
+    if (pid < 0)
+    {
+        ofLogError("ofApp::setup") << "Unable to start the reader process.";
+        return;
+    }
+
+    if (pid == 0)
+    {
+        // The reader process only touches the ring and the pipes.
+        ::close(readyPipe[0]);
+        ::close(resultPipe[0]);
+        runReader(name, readyPipe[1], resultPipe[1]);
+        _exit(0);
+    }
+
+    ::close(readyPipe[1]);
+    ::close(resultPipe[1]);
+
+    char ready = 0;
+
+    if (::read(readyPipe[0], &ready, 1) == 1 && ready == 1)
+    {
+        std::vector<uint8_t> report(REPORT_SIZE, 0);
+
+        auto next = std::chrono::steady_clock::now();
+
+        for (std::size_t i = 0; i < REPORT_COUNT; ++i)
+        {
+            next += std::chrono::microseconds(REPORT_INTERVAL_MICROS);
+            std::this_thread::sleep_until(next);
+
+            report[0] = (i + 1 == REPORT_COUNT) ? LAST_REPORT_MARKER : 0;
+
+            // Stamp the report as it is written.
+            writer.write(report.data(), report.size(), ofxIO::HIDDeviceUtils::monotonicTimeMicros());
+        }
+
+        if (::read(resultPipe[0], &result, sizeof(result)) == ssize_t(sizeof(result)))
+        {
+            result.written = REPORT_COUNT;
+            completed = true;
+        }
+    }
+    else
+    {
+        ofLogError("ofApp::setup") << "The reader could not map " << name;
+    }
+
+    ::close(readyPipe[0]);
+    ::close(resultPipe[0]);
+    waitpid(pid, nullptr, 0);
+
+    writer.close();
+
+    if (!completed)
+    {
+        ofLogError("ofApp::setup") << "The reader did not report its results.";
+        return;
+    }
+
+    ofLogNotice("ofApp::setup") << result.received << " of " << result.written << " reports, "
+                                << result.dropped << " dropped, "
+                                << "p50 " << result.p50Micros << " us, "
+                                << "p99 " << result.p99Micros << " us, "
+                                << "max " << result.maxMicros << " us";
+#else
+    ofLogError("ofApp::setup") << "Shared-memory export is not available on Windows.";
+#endif
+}
+
+
+void ofApp::draw()
+{
+    std::stringstream ss;
+    ss << REPORT_COUNT << " reports of " << REPORT_SIZE << " bytes, one every "
+       << REPORT_INTERVAL_MICROS << " us" << std::endl << std::endl;
+
+    if (completed)
+    {
+        ss << "received  dropped  p50 us  p99 us  max us" << std::endl;
+        ss << ofToString(result.received, 8, ' ')
+           << ofToString(result.dropped, 9, ' ')
+           << ofToString(result.p50Micros, 8, ' ')
+           << ofToString(result.p99Micros, 8, ' ')
+           << ofToString(result.maxMicros, 8, ' ')
+           << std::endl;
+    }
+    else
+    {
+        ss << "The measurement did not complete." << std::endl;
+    }
+
+    ofDrawBitmapString(ss.str(), 20, 20);
+}
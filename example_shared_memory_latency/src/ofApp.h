@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxHID.h"
+
+
+/// \brief Measures the latency of reports shared with another process.
+///
+/// The app creates a HIDSharedMemoryWriter ring and forks a reader process
+/// that polls it with HIDSharedMemoryReader::peek(). Each report is stamped
+/// with HIDDeviceUtils::monotonicTimeMicros() as it is written, and the
+/// reader records the time from the stamp to its peek(). The reader sends
+/// its results back through a pipe when the last report arrives.
+///
+/// Shared-memory export is not available on Windows.
+class ofApp: public ofBaseApp
+{
+public:
+    /// \brief The measurements made by the reader process.
+    struct Result
+    {
+        /// \brief The number of reports written.
+        uint64_t written = 0;
+
+        /// \brief The number of reports the reader saw intact.
+        uint64_t received = 0;
+
+        /// \brief The number of reports the reader lost or saw overwritten.
+        uint64_t dropped = 0;
+
+        /// \brief The median latency in microseconds.
+        uint64_t p50Micros = 0;
+
+        /// \brief The 99th percentile latency in microseconds.
+        uint64_t p99Micros = 0;
+
+        /// \brief The largest latency in microseconds.
+        uint64_t maxMicros = 0;
+    };
+
+    void setup() override;
+    void draw() override;
+
+    /// \brief Read reports until the last one arrives, then send the results.
+    /// \param name The shared-memory object name.
+    /// \param readyFd The pipe to signal once the ring is mapped.
+    /// \param resultFd The pipe to send the results through.
+    static void runReader(const std::string& name, int readyFd, int resultFd);
+
+    /// \brief The number of reports to write.
+    static const std::size_t REPORT_COUNT;
+
+    /// \brief The time between reports in microseconds.
+    static const uint64_t REPORT_INTERVAL_MICROS;
+
+    /// \brief The size of each report in bytes.
+    static const std::size_t REPORT_SIZE;
+
+    /// \brief The first data byte of the last report.
+    static const uint8_t LAST_REPORT_MARKER;
+
+    /// \brief How long the reader waits for a report before giving up.
+    static const uint64_t READER_TIMEOUT_MICROS;
+
+    Result result;
+
+    /// \brief True if the measurement completed.
+    bool completed = false;
+
+};
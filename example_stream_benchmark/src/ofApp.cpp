@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofApp.h"
+#include <iomanip>
+
+
+const std::size_t ofApp::PAYLOAD_SIZE = 16384;
+const std::size_t ofApp::REPORT_SIZE = 64;
+const uint64_t ofApp::REPORT_INTERVAL_MICROS = 1000;
+
+
+ofApp::Result ofApp::runDirect(ofxIO::HIDDevice& device, std::size_t messageSize)
+{
+    Result result;
+    result.name = "padded reports";
+    result.messageSize = messageSize;
+
+    std::vector<uint8_t> report(REPORT_SIZE, 0);
+    uint64_t writesBefore = virtualDevice->writes();
+    uint64_t startMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+    while (result.payloadBytes < PAYLOAD_SIZE)
+    {
+        // Each message is padded to a full report.
+        std::fill(report.begin(), report.begin() + messageSize, 'x');
+
+        if (device.write(0x00, report) < 0)
+            break;
+
+        result.payloadBytes += messageSize;
+    }
+
+    uint64_t elapsedMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros() - startMicros;
+
+    result.transfers = virtualDevice->writes() - writesBefore;
+    result.bytesPerSecond = result.payloadBytes * 1000000.0 / std::max<uint64_t>(elapsedMicros, 1);
+    return result;
+}
+
+
+ofApp::Result ofApp::runStream(ofxIO::HIDDevice& device, std::size_t messageSize)
+{
+    Result result;
+    result.name = "HIDStream";
+    result.messageSize = messageSize;
+
+    std::string message(messageSize, 'x');
+    uint64_t writesBefore = virtualDevice->writes();
+    uint64_t startMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+    {
+        ofxIO::HIDStream stream(device, REPORT_SIZE);
+
+        while (result.payloadBytes < PAYLOAD_SIZE)
+        {
+            stream << message;
+            result.payloadBytes += messageSize;
+        }
+
+        stream.flush();
+    }
+
+    uint64_t elapsedMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros() - startMicros;
+
+    result.transfers = virtualDevice->writes() - writesBefore;
+    result.bytesPerSecond = result.payloadBytes * 1000000.0 / std::max<uint64_t>(elapsedMicros, 1);
+    return result;
+}
+
+
+void ofApp::setup()
+{
+    auto backend = std::make_shared<ofxIO::HIDVirtualBackend>();
+    ofxIO::HIDBackend::set(backend);
+
+    ofxIO::HIDVirtualDevice::Settings settings;
+    settings.vendorId = 0x16C0;
+    settings.productId = 0x0486;
+    virtualDevice = backend->addDevice(settings);
+
+    // Accept one report per interrupt interval.
+    virtualDevice->setWriteHandler([](const uint8_t*, std::size_t size) {
+        std::this_thread::sleep_for(std::chrono::microseconds(REPORT_INTERVAL_MICROS));
+        return int(size);
+    });
+
+    ofxIO::HIDDevice device;
+
+    if (!device.setup(ofxIO::HIDDeviceInfo(settings.vendorId, settings.productId)))
+    {
+        ofLogError("ofApp::setup") << "Unable to open the virtual device.";
+        return;
+    }
+
+    for (std::size_t messageSize: { 8, 16, 32 })
+    {
+        results.push_back(runDirect(device, messageSize));
+        results.push_back(runStream(device, messageSize));
+    }
+
+    device.close();
+    ofxIO::HIDBackend::set(nullptr);
+
+    for (const auto& result: results)
+    {
+        ofLogNotice("ofApp::setup") << result.name << ", "
+                                    << result.messageSize << " byte messages: "
+                                    << result.transfers << " reports, "
+                                    << ofToString(result.bytesPerSecond / 1000.0, 1) << " kB/s";
+    }
+}
+
+
+void ofApp::draw()
+{
+    std::stringstream ss;
+    ss << "path              message bytes   reports      kB/s" << std::endl;
+
+    for (const auto& result: results)
+    {
+        ss << std::left << std::setw(18) << result.name << std::right
+           << ofToString(result.messageSize, 13, ' ')
+           << ofToString(result.transfers, 10, ' ')
+           << ofToString(result.bytesPerSecond / 1000.0, 1, 10, ' ')
+           << std::endl;
+    }
+
+    ofDrawBitmapString(ss.str(), 20, 20);
+}
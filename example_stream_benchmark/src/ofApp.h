@@ -0,0 +1,67 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxHID.h"
+
+
+/// \brief Measures effective bytes/s for small writes, with and without
+/// HIDStream packing.
+///
+/// The device is a HIDVirtualDevice that accepts one report per interrupt
+/// interval, like a full-speed RawHID endpoint. Each run sends the same
+/// payload as short messages, either one padded report per message or packed
+/// into full reports by a HIDStream.
+class ofApp: public ofBaseApp
+{
+public:
+    /// \brief The result of one benchmark run.
+    struct Result
+    {
+        /// \brief The name of the path.
+        std::string name;
+
+        /// \brief The message size in bytes.
+        std::size_t messageSize = 0;
+
+        /// \brief The number of payload bytes sent.
+        std::size_t payloadBytes = 0;
+
+        /// \brief The number of reports sent.
+        uint64_t transfers = 0;
+
+        /// \brief The effective payload throughput in bytes per second.
+        double bytesPerSecond = 0;
+    };
+
+    void setup() override;
+    void draw() override;
+
+    /// \brief Send the payload as one padded report per message.
+    Result runDirect(ofxIO::HIDDevice& device, std::size_t messageSize);
+
+    /// \brief Send the payload through a HIDStream.
+    Result runStream(ofxIO::HIDDevice& device, std::size_t messageSize);
+
+    /// \brief The number of payload bytes sent per run.
+    static const std::size_t PAYLOAD_SIZE;
+
+    /// \brief The report size in bytes, a full-speed RawHID report.
+    static const std::size_t REPORT_SIZE;
+
+    /// \brief The time the device takes to accept one report.
+    static const uint64_t REPORT_INTERVAL_MICROS;
+
+    /// \brief The virtual device receiving the reports.
+    std::shared_ptr<ofxIO::HIDVirtualDevice> virtualDevice;
+
+    std::vector<Result> results;
+
+};
@@ -0,0 +1,251 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofApp.h"
+#include <algorithm>
+#include <iomanip>
+#include <random>
+
+
+const std::size_t ofApp::REPORT_COUNT = 200000;
+const uint64_t ofApp::REPORT_INTERVAL_MICROS = 1000;
+
+
+namespace {
+
+
+/// \brief Write a little endian 16-bit value.
+void put16(std::vector<uint8_t>& data, std::size_t offset, uint16_t value)
+{
+    data[offset] = uint8_t(value & 0xFF);
+    data[offset + 1] = uint8_t(value >> 8);
+}
+
+
+}
+
+
+std::vector<ofApp::Recorded> ofApp::makeAxes()
+{
+    std::mt19937 random(1);
+    std::normal_distribution<double> step(0, 4);
+    std::uniform_int_distribution<int> jitter(-25, 25);
+
+    std::vector<ofApp::Recorded> reports(REPORT_COUNT);
+    std::vector<double> axes(6, 32768);
+
+    for (std::size_t i = 0; i < reports.size(); ++i)
+    {
+        Recorded& report = reports[i];
+        report.data.assign(64, 0);
+
+        // Sticks wander slowly and the USB frame timing jitters a little.
+        report.timestampMicros = (i + 1) * REPORT_INTERVAL_MICROS + jitter(random);
+
+        for (std::size_t axis = 0; axis < axes.size(); ++axis)
+        {
+            axes[axis] = ofClamp(axes[axis] + step(random), 0, 65535);
+            put16(report.data, 2 * axis, uint16_t(axes[axis]));
+        }
+    }
+
+    return reports;
+}
+
+
+std::vector<ofApp::Recorded> ofApp::makeButtonBursts()
+{
+    std::mt19937 random(2);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::uniform_int_distribution<int> button(0, 31);
+
+    std::vector<ofApp::Recorded> reports(REPORT_COUNT);
+    uint32_t buttons = 0;
+    std::size_t burst = 0;
+
+    for (std::size_t i = 0; i < reports.size(); ++i)
+    {
+        Recorded& report = reports[i];
+        report.data.assign(8, 0);
+        report.timestampMicros = i * REPORT_INTERVAL_MICROS;
+
+        // About one burst of a few dozen presses per second.
+        if (burst == 0 && uniform(random) < 0.001)
+            burst = 50 + std::size_t(uniform(random) * 100);
+
+        if (burst > 0)
+        {
+            --burst;
+
+            if (uniform(random) < 0.3)
+                buttons ^= uint32_t(1) << button(random);
+        }
+        else
+        {
+            buttons = 0;
+        }
+
+        for (std::size_t byte = 0; byte < 4; ++byte)
+            report.data[byte] = uint8_t(buttons >> (8 * byte));
+
+        // A frame counter in the last byte, as many devices send.
+        report.data[7] = uint8_t(i);
+    }
+
+    return reports;
+}
+
+
+std::vector<ofApp::Recorded> ofApp::makeMixed()
+{
+    std::vector<Recorded> axes = makeAxes();
+    std::vector<Recorded> buttons = makeButtonBursts();
+
+    std::vector<Recorded> reports(REPORT_COUNT);
+
+    for (std::size_t i = 0; i < reports.size(); ++i)
+    {
+        const Recorded& source = (i % 2 == 0) ? axes[i / 2] : buttons[i / 2];
+
+        reports[i].data.push_back((i % 2 == 0) ? 1 : 2);
+        reports[i].data.insert(reports[i].data.end(), source.data.begin(), source.data.end());
+        reports[i].timestampMicros = i * REPORT_INTERVAL_MICROS / 2;
+    }
+
+    return reports;
+}
+
+
+std::vector<ofApp::Recorded> ofApp::makeNoise()
+{
+    std::mt19937 random(3);
+    std::uniform_int_distribution<int> byte(0, 255);
+
+    std::vector<ofApp::Recorded> reports(REPORT_COUNT);
+
+    for (std::size_t i = 0; i < reports.size(); ++i)
+    {
+        reports[i].data.resize(64);
+
+        for (auto& value: reports[i].data)
+            value = uint8_t(byte(random));
+
+        reports[i].timestampMicros = i * REPORT_INTERVAL_MICROS;
+    }
+
+    return reports;
+}
+
+
+ofApp::Result ofApp::run(const std::string& name,
+                         const std::vector<Recorded>& reports,
+                         bool numberedReports)
+{
+    Result result;
+    result.name = name;
+
+    std::string path = ofToDataPath("telemetry.hidlog", true);
+    std::string indexPath = ofToDataPath("telemetry.hidindex", true);
+
+    ofxIO::HIDTelemetryWriter writer;
+
+    uint64_t startMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+    if (!writer.open(path, indexPath, ofxIO::HIDTelemetryWriter::DEFAULT_KEYFRAME_INTERVAL, numberedReports))
+    {
+        ofLogError("ofApp::run") << "Unable to create " << path;
+        return result;
+    }
+
+    for (const auto& report: reports)
+        writer.write(report.data.data(), report.data.size(), report.timestampMicros);
+
+    writer.flush();
+
+    uint64_t encodeMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros() - startMicros;
+
+    result.rawBytes = writer.rawBytes();
+    result.encodedBytes = writer.encodedBytes();
+    result.compressionRatio = writer.compressionRatio();
+    writer.close();
+
+    ofxIO::HIDTelemetryReader reader;
+    ofxIO::HIDReport decoded;
+
+    std::size_t count = 0;
+    bool matches = true;
+
+    startMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+    if (!reader.open(path, indexPath))
+    {
+        ofLogError("ofApp::run") << "Unable to open " << path;
+        return result;
+    }
+
+    while (reader.read(decoded))
+    {
+        if (count < reports.size())
+        {
+            matches = matches
+                   && decoded.data == reports[count].data
+                   && decoded.timestampMicros == reports[count].timestampMicros;
+        }
+
+        ++count;
+    }
+
+    uint64_t decodeMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros() - startMicros;
+
+    result.verified = matches && count == reports.size();
+    result.encodeMBPerSecond = result.rawBytes / double(std::max<uint64_t>(encodeMicros, 1));
+    result.decodeMBPerSecond = result.rawBytes / double(std::max<uint64_t>(decodeMicros, 1));
+
+    if (!result.verified)
+        ofLogError("ofApp::run") << name << ": the decoded reports do not match.";
+
+    return result;
+}
+
+
+void ofApp::setup()
+{
+    results.push_back(run("slowly changing axes", makeAxes(), false));
+    results.push_back(run("button bursts", makeButtonBursts(), false));
+    results.push_back(run("axes and buttons, numbered", makeMixed(), true));
+    results.push_back(run("random bytes", makeNoise(), false));
+
+    for (const auto& result: results)
+    {
+        ofLogNotice("ofApp::setup") << result.name << ": "
+                                    << result.rawBytes << " bytes to " << result.encodedBytes << ", "
+                                    << "ratio " << ofToString(result.compressionRatio, 1) << ", "
+                                    << "encode " << ofToString(result.encodeMBPerSecond, 1) << " MB/s, "
+                                    << "decode " << ofToString(result.decodeMBPerSecond, 1) << " MB/s"
+                                    << (result.verified ? "" : ", NOT VERIFIED");
+    }
+}
+
+
+void ofApp::draw()
+{
+    std::stringstream ss;
+    ss << REPORT_COUNT << " reports per stream" << std::endl << std::endl;
+    ss << "stream                        ratio  encode MB/s  decode MB/s  verified" << std::endl;
+
+    for (const auto& result: results)
+    {
+        ss << std::left << std::setw(28) << result.name << std::right
+           << ofToString(result.compressionRatio, 1, 7, ' ')
+           << ofToString(result.encodeMBPerSecond, 1, 13, ' ')
+           << ofToString(result.decodeMBPerSecond, 1, 13, ' ')
+           << std::setw(10) << (result.verified ? "yes" : "NO")
+           << std::endl;
+    }
+
+    ofDrawBitmapString(ss.str(), 20, 20);
+}
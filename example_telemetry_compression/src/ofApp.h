@@ -0,0 +1,92 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxHID.h"
+
+
+/// \brief Measures telemetry log compression and throughput.
+///
+/// Each stream is a recording of REPORT_COUNT synthetic sensor reports,
+/// generated in memory before timing. The stream is written with
+/// HIDTelemetryWriter, then read back with HIDTelemetryReader and compared
+/// with the original reports.
+class ofApp: public ofBaseApp
+{
+public:
+    /// \brief A recorded report.
+    struct Recorded
+    {
+        /// \brief The report data.
+        std::vector<uint8_t> data;
+
+        /// \brief The host monotonic receive time in microseconds.
+        uint64_t timestampMicros = 0;
+    };
+
+    /// \brief The result of one stream.
+    struct Result
+    {
+        /// \brief The name of the stream.
+        std::string name;
+
+        /// \brief The number of raw report bytes.
+        uint64_t rawBytes = 0;
+
+        /// \brief The number of log bytes.
+        uint64_t encodedBytes = 0;
+
+        /// \brief The writer's compression ratio.
+        double compressionRatio = 0;
+
+        /// \brief The raw report bytes encoded per second, in MB.
+        double encodeMBPerSecond = 0;
+
+        /// \brief The raw report bytes decoded per second, in MB.
+        double decodeMBPerSecond = 0;
+
+        /// \brief True if every report was read back unchanged.
+        bool verified = false;
+    };
+
+    void setup() override;
+    void draw() override;
+
+    /// \brief Write a stream to a log, read it back and measure both.
+    /// \param name The name of the stream.
+    /// \param reports The reports to write.
+    /// \param numberedReports True if the first byte of each report is its
+    ///        report id.
+    Result run(const std::string& name,
+               const std::vector<Recorded>& reports,
+               bool numberedReports);
+
+    /// \returns a gamepad whose six 16-bit axes drift slowly.
+    static std::vector<Recorded> makeAxes();
+
+    /// \returns a button box that is idle between bursts of presses.
+    static std::vector<Recorded> makeButtonBursts();
+
+    /// \returns both devices interleaved as numbered reports on one
+    ///          interface.
+    static std::vector<Recorded> makeMixed();
+
+    /// \returns random report bytes, the worst case for the coder.
+    static std::vector<Recorded> makeNoise();
+
+    /// \brief The number of reports in each stream.
+    static const std::size_t REPORT_COUNT;
+
+    /// \brief The time between reports in microseconds.
+    static const uint64_t REPORT_INTERVAL_MICROS;
+
+    std::vector<Result> results;
+
+};
@@ -0,0 +1,203 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofApp.h"
+#include <clocale>
+#include <cstdlib>
+#include <cwchar>
+#include <iomanip>
+
+
+const std::size_t ofApp::CONVERSIONS = 1000000;
+
+
+std::vector<ofApp::Check> ofApp::checks()
+{
+    const bool utf16 = sizeof(wchar_t) == 2;
+
+    // U+1F600 as a single code point where wchar_t is 32 bits.
+    std::wstring grinning = utf16 ? std::wstring({ wchar_t(0xD83D), wchar_t(0xDE00) })
+                                  : std::wstring(1, wchar_t(0x1F600));
+
+    std::vector<Check> result = {
+        { "empty", L"", "" },
+        { "ASCII", L"Teensyduino RawHID", "Teensyduino RawHID" },
+        { "U+007F", std::wstring(1, wchar_t(0x7F)), "\x7F" },
+        { "U+0080", std::wstring(1, wchar_t(0x80)), "\xC2\x80" },
+        { "U+07FF", std::wstring(1, wchar_t(0x7FF)), "\xDF\xBF" },
+        { "U+0800", std::wstring(1, wchar_t(0x800)), "\xE0\xA0\x80" },
+        { "U+FFFD", std::wstring(1, wchar_t(0xFFFD)), "\xEF\xBF\xBD" },
+        { "U+FFFF", std::wstring(1, wchar_t(0xFFFF)), "\xEF\xBF\xBF" },
+        { "Latin-1 product", L"Contr\u00F4leur d'\u00E9clairage", "Contr\xC3\xB4leur d'\xC3\xA9" "clairage" },
+        { "CJK product", L"\u30B2\u30FC\u30E0\u30D1\u30C3\u30C9", "\xE3\x82\xB2\xE3\x83\xBC\xE3\x83\xA0\xE3\x83\x91\xE3\x83\x83\xE3\x83\x89" },
+        { "mixed product", L"Pad " + grinning + L" \u00B5C", "Pad \xF0\x9F\x98\x80 \xC2\xB5" "C" },
+        { "unpaired high surrogate", std::wstring({ L'a', wchar_t(0xD83D), L'b' }), "a\xEF\xBF\xBD" "b" },
+        { "unpaired low surrogate", std::wstring({ L'a', wchar_t(0xDE00), L'b' }), "a\xEF\xBF\xBD" "b" },
+        { "trailing high surrogate", std::wstring({ L'a', wchar_t(0xD83D) }), "a\xEF\xBF\xBD" },
+        { "reversed surrogates", std::wstring({ wchar_t(0xDE00), wchar_t(0xD83D) }), "\xEF\xBF\xBD\xEF\xBF\xBD" }
+    };
+
+    if (utf16)
+    {
+        result.push_back({ "surrogate pair", grinning, "\xF0\x9F\x98\x80" });
+        result.push_back({ "U+10000", std::wstring({ wchar_t(0xD800), wchar_t(0xDC00) }), "\xF0\x90\x80\x80" });
+        result.push_back({ "U+10FFFF", std::wstring({ wchar_t(0xDBFF), wchar_t(0xDFFF) }), "\xF4\x8F\xBF\xBF" });
+    }
+    else
+    {
+        // UTF-16 surrogates are invalid code points in UTF-32.
+        result.push_back({ "surrogate pair", std::wstring({ wchar_t(0xD83D), wchar_t(0xDE00) }), "\xEF\xBF\xBD\xEF\xBF\xBD" });
+        result.push_back({ "U+1F600", grinning, "\xF0\x9F\x98\x80" });
+        result.push_back({ "U+10000", std::wstring(1, wchar_t(0x10000)), "\xF0\x90\x80\x80" });
+        result.push_back({ "U+10FFFF", std::wstring(1, wchar_t(0x10FFFF)), "\xF4\x8F\xBF\xBF" });
+        result.push_back({ "above U+10FFFF", std::wstring({ L'a', wchar_t(0x110000), L'b' }), "a\xEF\xBF\xBD" "b" });
+        result.push_back({ "negative wchar_t", std::wstring({ L'a', wchar_t(-1), L'b' }), "a\xEF\xBF\xBD" "b" });
+    }
+
+    return result;
+}
+
+
+std::string ofApp::wcstombsString(const wchar_t* input)
+{
+    if (input)
+    {
+        std::size_t inputSize = std::wcslen(input);
+
+        if (inputSize > 0)
+        {
+            std::vector<char> output(inputSize * 4);
+            std::size_t size = std::wcstombs(output.data(), input, output.size());
+
+            // wcstombs() fails on characters the locale cannot encode.
+            if (size == static_cast<std::size_t>(-1))
+                return std::string();
+
+            return std::string(output.data(), std::min(size, output.size()));
+        }
+    }
+
+    return std::string();
+}
+
+
+template<typename ConvertT>
+ofApp::Result ofApp::run(const std::string& name,
+                         const std::vector<std::wstring>& inputs,
+                         const std::vector<std::string>& expected,
+                         ConvertT convert)
+{
+    Result result;
+    result.name = name;
+    result.correct = true;
+
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+        result.correct = result.correct && convert(inputs[i].c_str()) == expected[i];
+
+    std::size_t totalSize = 0;
+
+    uint64_t startMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+    for (std::size_t i = 0; i < CONVERSIONS; ++i)
+        totalSize += convert(inputs[i % inputs.size()].c_str()).size();
+
+    uint64_t elapsedMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros() - startMicros;
+
+    result.nanosPerString = elapsedMicros * 1000.0 / CONVERSIONS;
+
+    ofLogVerbose("ofApp::run") << name << " converted " << totalSize << " bytes.";
+
+    return result;
+}
+
+
+void ofApp::setup()
+{
+    for (const auto& check: checks())
+    {
+        std::string output = ofxIO::HIDDeviceUtils::toMultiByteString(check.input.c_str());
+
+        if (output == check.expected)
+        {
+            ++passed;
+        }
+        else
+        {
+            failed.push_back(check.name);
+            ofLogError("ofApp::setup") << "Check failed: " << check.name;
+        }
+    }
+
+    if (ofxIO::HIDDeviceUtils::toMultiByteString(nullptr) == "")
+    {
+        ++passed;
+    }
+    else
+    {
+        failed.push_back("null");
+        ofLogError("ofApp::setup") << "Check failed: null";
+    }
+
+    ofLogNotice("ofApp::setup") << passed << " checks passed, " << failed.size() << " failed.";
+
+    // Typical enumerated strings: serial numbers and product names.
+    std::vector<std::wstring> asciiInputs = { L"12345670", L"Teensyduino", L"Teensyduino RawHID", L"Logitech Gamepad F310" };
+    std::vector<std::string> asciiExpected = { "12345670", "Teensyduino", "Teensyduino RawHID", "Logitech Gamepad F310" };
+
+    std::vector<std::wstring> unicodeInputs = { L"Contr\u00F4leur d'\u00E9clairage", L"\u30B2\u30FC\u30E0\u30D1\u30C3\u30C9", L"Capteur \u00B5" };
+    std::vector<std::string> unicodeExpected = { "Contr\xC3\xB4leur d'\xC3\xA9" "clairage", "\xE3\x82\xB2\xE3\x83\xBC\xE3\x83\xA0\xE3\x83\x91\xE3\x83\x83\xE3\x83\x89", "Capteur \xC2\xB5" };
+
+    auto convert = [](const wchar_t* input) { return ofxIO::HIDDeviceUtils::toMultiByteString(input); };
+
+    results.push_back(run("toMultiByteString, ASCII", asciiInputs, asciiExpected, convert));
+    results.push_back(run("toMultiByteString, non-ASCII", unicodeInputs, unicodeExpected, convert));
+
+    // The previous conversion, in the default "C" locale and a UTF-8 locale.
+    std::string previousLocale = std::setlocale(LC_CTYPE, nullptr);
+
+    std::setlocale(LC_CTYPE, "C");
+    results.push_back(run("wcstombs C, ASCII", asciiInputs, asciiExpected, wcstombsString));
+    results.push_back(run("wcstombs C, non-ASCII", unicodeInputs, unicodeExpected, wcstombsString));
+
+    if (std::setlocale(LC_CTYPE, "C.UTF-8") || std::setlocale(LC_CTYPE, "en_US.UTF-8"))
+    {
+        results.push_back(run("wcstombs UTF-8, ASCII", asciiInputs, asciiExpected, wcstombsString));
+        results.push_back(run("wcstombs UTF-8, non-ASCII", unicodeInputs, unicodeExpected, wcstombsString));
+    }
+
+    std::setlocale(LC_CTYPE, previousLocale.c_str());
+
+    for (const auto& result: results)
+    {
+        ofLogNotice("ofApp::setup") << result.name << ": "
+                                    << ofToString(result.nanosPerString, 1) << " ns/string, "
+                                    << (result.correct ? "correct" : "incorrect") << " output";
+    }
+}
+
+
+void ofApp::draw()
+{
+    std::stringstream ss;
+    ss << passed << " checks passed, " << failed.size() << " failed." << std::endl;
+
+    for (const auto& name: failed)
+        ss << "  failed: " << name << std::endl;
+
+    ss << std::endl;
+    ss << "conversion                    ns/string  output" << std::endl;
+
+    for (const auto& result: results)
+    {
+        ss << std::left << std::setw(28) << result.name << std::right
+           << ofToString(result.nanosPerString, 1, 11, ' ')
+           << "  " << (result.correct ? "correct" : "incorrect")
+           << std::endl;
+    }
+
+    ofDrawBitmapString(ss.str(), 20, 20);
+}
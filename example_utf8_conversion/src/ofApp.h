@@ -0,0 +1,81 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxHID.h"
+
+
+/// \brief Checks and benchmarks HIDDeviceUtils::toMultiByteString().
+///
+/// The checks cover ASCII, each UTF-8 length boundary, non-ASCII product
+/// names, surrogate pairs and invalid code points. Where wchar_t is 32 bits,
+/// surrogates are themselves invalid code points, so the expected output
+/// depends on the platform.
+///
+/// The benchmark compares the conversion with the previous wcstombs() based
+/// conversion, which allocated a 4 * wcslen() buffer and depended on the
+/// locale.
+class ofApp: public ofBaseApp
+{
+public:
+    /// \brief A conversion check.
+    struct Check
+    {
+        /// \brief The name of the check.
+        std::string name;
+
+        /// \brief The input string.
+        std::wstring input;
+
+        /// \brief The expected UTF-8 output.
+        std::string expected;
+    };
+
+    /// \brief The result of one benchmark run.
+    struct Result
+    {
+        /// \brief The name of the run.
+        std::string name;
+
+        /// \brief The time per conversion in nanoseconds.
+        double nanosPerString = 0;
+
+        /// \brief True if the output was correct UTF-8.
+        bool correct = false;
+    };
+
+    void setup() override;
+    void draw() override;
+
+    /// \returns the conversion checks.
+    static std::vector<Check> checks();
+
+    /// \brief The previous locale-dependent conversion.
+    static std::string wcstombsString(const wchar_t* input);
+
+    /// \brief Time a conversion over a set of strings.
+    template<typename ConvertT>
+    static Result run(const std::string& name,
+                      const std::vector<std::wstring>& inputs,
+                      const std::vector<std::string>& expected,
+                      ConvertT convert);
+
+    /// \brief The number of conversions per benchmark run.
+    static const std::size_t CONVERSIONS;
+
+    /// \brief The number of checks that passed.
+    std::size_t passed = 0;
+
+    /// \brief The names of the checks that failed.
+    std::vector<std::string> failed;
+
+    std::vector<Result> results;
+
+};
@@ -0,0 +1,180 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofApp.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+
+const uint64_t ofApp::RUN_MICROS = 3000000;
+const uint64_t ofApp::REPORT_INTERVAL_MICROS = 1000;
+
+
+ofApp::Result ofApp::run(const std::string& name,
+                         const ofxIO::HIDThreadSettings& settings,
+                         bool loaded)
+{
+    Result result;
+    result.name = name;
+
+    // Check the settings on a throwaway thread. The broadcaster applies them
+    // to its own thread the same way.
+    ofxIO::HIDThreadSettings check = settings;
+    check.lockMemory = false;
+    std::thread([&]() { result.applied = check.applyToCurrentThread(); }).join();
+
+    ofxIO::HIDDevice device;
+
+    if (!device.setup(ofxIO::HIDDeviceInfo(virtualDevice->settings().vendorId,
+                                           virtualDevice->settings().productId)))
+    {
+        ofLogError("ofApp::run") << "Unable to open the virtual device.";
+        return result;
+    }
+
+    ofxIO::HIDReportBroadcaster broadcaster(device);
+    broadcaster.setThreadSettings(settings);
+    auto subscriber = broadcaster.subscribe();
+    broadcaster.start();
+
+    std::atomic<bool> running(true);
+    std::vector<std::thread> load;
+
+    if (loaded)
+    {
+        for (unsigned i = 0; i < std::max(1u, std::thread::hardware_concurrency()); ++i)
+        {
+            load.push_back(std::thread([&]() {
+                volatile uint64_t spins = 0;
+
+                while (running)
+                    ++spins;
+            }));
+        }
+    }
+
+    std::thread producer([&]() {
+        std::vector<uint8_t> report(64, 0);
+
+        while (running)
+        {
+            uint64_t pushMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+            std::memcpy(report.data(), &pushMicros, sizeof(pushMicros));
+            virtualDevice->pushInputReport(report);
+
+            std::this_thread::sleep_for(std::chrono::microseconds(REPORT_INTERVAL_MICROS));
+        }
+    });
+
+    std::vector<uint64_t> latencies;
+    ofxIO::HIDReportRing::SharedReport report;
+
+    uint64_t startMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+    while (ofxIO::HIDDeviceUtils::monotonicTimeMicros() < startMicros + RUN_MICROS)
+    {
+        if (subscriber->read(report, 10) && report->data.size() >= sizeof(uint64_t))
+        {
+            uint64_t pushMicros = 0;
+            std::memcpy(&pushMicros, report->data.data(), sizeof(pushMicros));
+            latencies.push_back(report->timestampMicros - pushMicros);
+        }
+    }
+
+    running = false;
+
+    producer.join();
+
+    for (auto& thread: load)
+        thread.join();
+
+    broadcaster.stop();
+    device.close();
+
+    std::sort(latencies.begin(), latencies.end());
+
+    if (!latencies.empty())
+    {
+        auto percentile = [&](double p) {
+            return latencies[std::min(latencies.size() - 1, std::size_t(latencies.size() * p / 100))];
+        };
+
+        result.reports = latencies.size();
+        result.p50Micros = percentile(50);
+        result.p99Micros = percentile(99);
+        result.p999Micros = percentile(99.9);
+        result.maxMicros = latencies.back();
+    }
+
+    return result;
+}
+
+
+void ofApp::setup()
+{
+    auto backend = std::make_shared<ofxIO::HIDVirtualBackend>();
+    ofxIO::HIDBackend::set(backend);
+
+    ofxIO::HIDVirtualDevice::Settings deviceSettings;
+    deviceSettings.vendorId = 0x16C0;
+    deviceSettings.productId = 0x0486;
+    virtualDevice = backend->addDevice(deviceSettings);
+
+    ofxIO::HIDThreadSettings defaults;
+
+    ofxIO::HIDThreadSettings realtime;
+    realtime.schedulingPolicy = ofxIO::HIDThreadSettings::SchedulingPolicy::FIFO;
+    realtime.priority = 80;
+
+    ofxIO::HIDThreadSettings pinned = realtime;
+    pinned.cpuAffinity = { 0 };
+
+    // A real-time thread that never blocks starves everything else on its
+    // CPU, including the thread pushing the reports, so busy polling keeps
+    // the default policy here. Combine it with FIFO only on a dedicated core.
+    ofxIO::HIDThreadSettings busyPoll;
+    busyPoll.cpuAffinity = { int(std::max(1u, std::thread::hardware_concurrency())) - 1 };
+    busyPoll.waitMode = ofxIO::HIDThreadSettings::WaitMode::BUSY_POLL;
+
+    results.push_back(run("default, idle", defaults, false));
+    results.push_back(run("default, loaded", defaults, true));
+    results.push_back(run("FIFO 80, loaded", realtime, true));
+    results.push_back(run("FIFO 80 + CPU 0, loaded", pinned, true));
+    results.push_back(run("busy poll + last CPU, loaded", busyPoll, true));
+
+    ofxIO::HIDBackend::set(nullptr);
+
+    for (const auto& result: results)
+    {
+        ofLogNotice("ofApp::setup") << result.name << (result.applied ? "" : " (not applied)") << ": "
+                                    << "p50 " << result.p50Micros << " us, "
+                                    << "p99 " << result.p99Micros << " us, "
+                                    << "p99.9 " << result.p999Micros << " us, "
+                                    << "max " << result.maxMicros << " us";
+    }
+}
+
+
+void ofApp::draw()
+{
+    std::stringstream ss;
+    ss << "reader thread                    applied   p50 us   p99 us p99.9 us   max us" << std::endl;
+
+    for (const auto& result: results)
+    {
+        ss << std::left << std::setw(32) << result.name << std::right
+           << std::setw(8) << (result.applied ? "yes" : "no")
+           << ofToString(result.p50Micros, 9, ' ')
+           << ofToString(result.p99Micros, 9, ' ')
+           << ofToString(result.p999Micros, 9, ' ')
+           << ofToString(result.maxMicros, 9, ' ')
+           << std::endl;
+    }
+
+    ofDrawBitmapString(ss.str(), 20, 20);
+}
@@ -0,0 +1,76 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxHID.h"
+
+
+/// \brief Measures reader thread wake-up latency with and without
+/// HIDThreadSettings on a loaded machine.
+///
+/// A HIDVirtualDevice receives an input report every millisecond, stamped
+/// with the time it was pushed. A HIDReportBroadcaster reads the device with
+/// the settings under test and stamps each report when its read returns. The
+/// difference is the time the reader thread took to wake up.
+///
+/// Each loaded run starts one spinning thread per CPU. Real-time scheduling
+/// usually needs elevated privileges, e.g. CAP_SYS_NICE or an rtprio limit
+/// on Linux. Runs whose settings could not be applied are marked.
+class ofApp: public ofBaseApp
+{
+public:
+    /// \brief The result of one run.
+    struct Result
+    {
+        /// \brief The name of the run.
+        std::string name;
+
+        /// \brief True if the thread settings could be applied.
+        bool applied = false;
+
+        /// \brief The number of reports measured.
+        std::size_t reports = 0;
+
+        /// \brief The median wake-up latency in microseconds.
+        uint64_t p50Micros = 0;
+
+        /// \brief The 99th percentile wake-up latency in microseconds.
+        uint64_t p99Micros = 0;
+
+        /// \brief The 99.9th percentile wake-up latency in microseconds.
+        uint64_t p999Micros = 0;
+
+        /// \brief The largest wake-up latency in microseconds.
+        uint64_t maxMicros = 0;
+    };
+
+    void setup() override;
+    void draw() override;
+
+    /// \brief Measure the wake-up latency of a reader thread.
+    /// \param name The name of the run.
+    /// \param settings The reader thread settings.
+    /// \param loaded True to load every CPU while measuring.
+    Result run(const std::string& name,
+               const ofxIO::HIDThreadSettings& settings,
+               bool loaded);
+
+    /// \brief The length of each run.
+    static const uint64_t RUN_MICROS;
+
+    /// \brief The time between input reports.
+    static const uint64_t REPORT_INTERVAL_MICROS;
+
+    /// \brief The virtual device.
+    std::shared_ptr<ofxIO::HIDVirtualDevice> virtualDevice;
+
+    std::vector<Result> results;
+
+};
@@ -0,0 +1,180 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofApp.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+
+const uint64_t ofApp::REPORT_MICROS = 1000;
+const uint64_t ofApp::URGENT_INTERVAL_MICROS = 25000;
+const uint64_t ofApp::RUN_MICROS = 3000000;
+const uint8_t ofApp::COMMAND_MARKER = 0xE5;
+
+
+ofApp::Result ofApp::run(const std::string& name,
+                         ofxIO::HIDWriteScheduler::Lane commandLane)
+{
+    Result result;
+    result.name = name;
+
+    std::mutex mutex;
+    std::vector<uint64_t> latencies;
+    std::atomic<uint64_t> accepted(0);
+    std::atomic<uint64_t> bulkReports(0);
+
+    // A slow device. Written reports start with the report id.
+    virtualDevice->setWriteHandler([&](const uint8_t* data, std::size_t size) {
+        std::this_thread::sleep_for(std::chrono::microseconds(REPORT_MICROS));
+
+        if (size >= 18 && data[1] == COMMAND_MARKER)
+        {
+            uint64_t enqueueMicros = 0;
+            uint64_t enqueueAccepted = 0;
+            std::memcpy(&enqueueMicros, data + 2, sizeof(enqueueMicros));
+            std::memcpy(&enqueueAccepted, data + 10, sizeof(enqueueAccepted));
+
+            std::unique_lock<std::mutex> lock(mutex);
+            latencies.push_back(ofxIO::HIDDeviceUtils::monotonicTimeMicros() - enqueueMicros);
+            result.maxReportsAhead = std::max(result.maxReportsAhead, accepted - enqueueAccepted);
+        }
+        else
+        {
+            ++bulkReports;
+        }
+
+        ++accepted;
+        return int(size);
+    });
+
+    ofxIO::HIDDevice device;
+
+    if (!device.setup(ofxIO::HIDDeviceInfo(virtualDevice->settings().vendorId,
+                                           virtualDevice->settings().productId)))
+    {
+        ofLogError("ofApp::run") << "Unable to open the virtual device.";
+        return result;
+    }
+
+    ofxIO::HIDWriteScheduler scheduler;
+    scheduler.addDevice(device);
+    scheduler.start();
+
+    std::atomic<bool> running(true);
+
+    std::thread bulk([&]() {
+        std::vector<uint8_t> report(64, 0);
+        uint64_t sequence = 0;
+
+        while (running)
+        {
+            // Vary the data, so the output report cache sends every report.
+            std::memcpy(report.data() + 1, &sequence, sizeof(sequence));
+
+            if (scheduler.enqueue(device, 0x00, report, ofxIO::HIDWriteScheduler::Lane::BULK))
+                ++sequence;
+            else
+                std::this_thread::sleep_for(std::chrono::microseconds(REPORT_MICROS / 4));
+        }
+    });
+
+    uint64_t startMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+
+    std::vector<uint8_t> command(64, 0);
+    command[0] = COMMAND_MARKER;
+
+    while (ofxIO::HIDDeviceUtils::monotonicTimeMicros() < startMicros + RUN_MICROS)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(URGENT_INTERVAL_MICROS));
+
+        uint64_t enqueueMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros();
+        uint64_t enqueueAccepted = accepted;
+        std::memcpy(command.data() + 1, &enqueueMicros, sizeof(enqueueMicros));
+        std::memcpy(command.data() + 9, &enqueueAccepted, sizeof(enqueueAccepted));
+
+        // A full FIFO rejects the command, so retry until it is queued.
+        while (!scheduler.enqueue(device, 0x00, command, commandLane))
+            std::this_thread::sleep_for(std::chrono::microseconds(REPORT_MICROS / 4));
+    }
+
+    uint64_t elapsedMicros = ofxIO::HIDDeviceUtils::monotonicTimeMicros() - startMicros;
+
+    running = false;
+    bulk.join();
+    scheduler.stop();
+    scheduler.removeDevice(device);
+    device.close();
+
+    virtualDevice->setWriteHandler(nullptr);
+
+    std::sort(latencies.begin(), latencies.end());
+
+    if (!latencies.empty())
+    {
+        result.commands = latencies.size();
+        result.p50Micros = latencies[latencies.size() / 2];
+        result.p99Micros = latencies[std::min(latencies.size() - 1, std::size_t(latencies.size() * 0.99))];
+        result.maxMicros = latencies.back();
+    }
+
+    result.bulkReportsPerSecond = bulkReports * 1000000.0 / std::max<uint64_t>(elapsedMicros, 1);
+    return result;
+}
+
+
+void ofApp::setup()
+{
+    auto backend = std::make_shared<ofxIO::HIDVirtualBackend>();
+    ofxIO::HIDBackend::set(backend);
+
+    ofxIO::HIDVirtualDevice::Settings settings;
+    settings.vendorId = 0x16C0;
+    settings.productId = 0x0486;
+    virtualDevice = backend->addDevice(settings);
+
+    results.push_back(run("bulk lane (FIFO)", ofxIO::HIDWriteScheduler::Lane::BULK));
+    results.push_back(run("urgent lane", ofxIO::HIDWriteScheduler::Lane::URGENT));
+
+    ofxIO::HIDBackend::set(nullptr);
+
+    // An urgent command should wait for at most the report being written.
+    if (results.back().maxReportsAhead > 1)
+        ofLogError("ofApp::setup") << "Urgent commands waited behind " << results.back().maxReportsAhead << " reports.";
+
+    for (const auto& result: results)
+    {
+        ofLogNotice("ofApp::setup") << result.name << ": "
+                                    << result.commands << " commands, "
+                                    << "p50 " << result.p50Micros << " us, "
+                                    << "p99 " << result.p99Micros << " us, "
+                                    << "max " << result.maxMicros << " us, "
+                                    << result.maxReportsAhead << " max reports ahead, "
+                                    << ofToString(result.bulkReportsPerSecond, 0) << " bulk reports/s";
+    }
+}
+
+
+void ofApp::draw()
+{
+    std::stringstream ss;
+    ss << "commands on           count   p50 us   p99 us   max us   ahead  bulk/s" << std::endl;
+
+    for (const auto& result: results)
+    {
+        ss << std::left << std::setw(20) << result.name << std::right
+           << ofToString(result.commands, 7, ' ')
+           << ofToString(result.p50Micros, 9, ' ')
+           << ofToString(result.p99Micros, 9, ' ')
+           << ofToString(result.maxMicros, 9, ' ')
+           << ofToString(result.maxReportsAhead, 8, ' ')
+           << ofToString(result.bulkReportsPerSecond, 0, 8, ' ')
+           << std::endl;
+    }
+
+    ofDrawBitmapString(ss.str(), 20, 20);
+}
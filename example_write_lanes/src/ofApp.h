@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxHID.h"
+
+
+/// \brief Measures urgent report latency while bulk reports saturate a
+/// slow device.
+///
+/// The device is a HIDVirtualDevice that takes REPORT_MICROS to accept each
+/// report. A bulk thread keeps the HIDWriteScheduler's bulk lane full, and
+/// an urgent command is queued every URGENT_INTERVAL_MICROS. Each command
+/// carries its enqueue time and the number of reports the device had
+/// accepted, and the device records the latency and the number of reports
+/// ahead of it when the command arrives.
+///
+/// The run is repeated with the commands queued on the bulk lane, as a plain
+/// FIFO would send them, and on the urgent lane.
+class ofApp: public ofBaseApp
+{
+public:
+    /// \brief The result of one run.
+    struct Result
+    {
+        /// \brief The name of the run.
+        std::string name;
+
+        /// \brief The number of urgent commands received.
+        std::size_t commands = 0;
+
+        /// \brief The median command latency in microseconds.
+        uint64_t p50Micros = 0;
+
+        /// \brief The 99th percentile command latency in microseconds.
+        uint64_t p99Micros = 0;
+
+        /// \brief The largest command latency in microseconds.
+        uint64_t maxMicros = 0;
+
+        /// \brief The most reports the device accepted between queuing a
+        ///        command and receiving it.
+        ///
+        /// Unlike the latencies, this does not depend on how precisely the
+        /// simulated device sleeps.
+        uint64_t maxReportsAhead = 0;
+
+        /// \brief The bulk reports received per second.
+        double bulkReportsPerSecond = 0;
+    };
+
+    void setup() override;
+    void draw() override;
+
+    /// \brief Run the scheduler with commands on the given lane.
+    Result run(const std::string& name, ofxIO::HIDWriteScheduler::Lane commandLane);
+
+    /// \brief The time the device takes to accept a report.
+    static const uint64_t REPORT_MICROS;
+
+    /// \brief The time between urgent commands.
+    static const uint64_t URGENT_INTERVAL_MICROS;
+
+    /// \brief The length of each run.
+    static const uint64_t RUN_MICROS;
+
+    /// \brief The first data byte of urgent commands.
+    static const uint8_t COMMAND_MARKER;
+
+    /// \brief The virtual device receiving the reports.
+    std::shared_ptr<ofxIO::HIDVirtualDevice> virtualDevice;
+
+    std::vector<Result> results;
+
+};
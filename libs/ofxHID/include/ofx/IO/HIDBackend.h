@@ -0,0 +1,117 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "hidapi/hidapi.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief The calls ofxHID makes to enumerate, open and talk to devices.
+///
+/// The default backend forwards each call to hidapi. Install another backend
+/// with set() to drive HIDDevice, HIDDeviceHandle and HIDDeviceUtils without
+/// hardware, e.g. with HIDVirtualBackend.
+///
+/// A HIDDevice keeps the backend that opened it until it is closed, so a
+/// backend may be replaced while devices are open.
+class HIDBackend
+{
+public:
+    /// \brief Destroy the backend.
+    virtual ~HIDBackend();
+
+    /// \brief List the devices matching a vendor and product id.
+    ///
+    /// A value of 0 matches any id.
+    ///
+    /// \returns a list that must be freed with freeEnumeration().
+    virtual hid_device_info* enumerate(unsigned short vendorId,
+                                       unsigned short productId);
+
+    /// \brief Free a list returned by enumerate().
+    virtual void freeEnumeration(hid_device_info* devices);
+
+    /// \returns a handle to the device at the path, or nullptr on failure.
+    virtual hid_device* openPath(const char* path);
+
+    /// \brief Close a handle returned by openPath().
+    virtual void close(hid_device* device);
+
+    /// \returns the hid_write() result.
+    virtual int write(hid_device* device,
+                      const unsigned char* data,
+                      std::size_t length);
+
+    /// \returns the hid_read_timeout() result.
+    virtual int readTimeout(hid_device* device,
+                            unsigned char* data,
+                            std::size_t length,
+                            int milliseconds);
+
+    /// \returns the hid_send_feature_report() result.
+    virtual int sendFeatureReport(hid_device* device,
+                                  const unsigned char* data,
+                                  std::size_t length);
+
+    /// \returns the hid_get_feature_report() result.
+    virtual int getFeatureReport(hid_device* device,
+                                 unsigned char* data,
+                                 std::size_t length);
+
+    /// \returns the hid_get_serial_number_string() result.
+    virtual int getSerialNumberString(hid_device* device,
+                                      wchar_t* string,
+                                      std::size_t maxLength);
+
+    /// \returns the hid_get_manufacturer_string() result.
+    virtual int getManufacturerString(hid_device* device,
+                                      wchar_t* string,
+                                      std::size_t maxLength);
+
+    /// \returns the hid_get_product_string() result.
+    virtual int getProductString(hid_device* device,
+                                 wchar_t* string,
+                                 std::size_t maxLength);
+
+    /// \brief Get the report descriptor of the device at the path.
+    ///
+    /// hidapi has no call for this, so the default backend returns false and
+    /// HIDDeviceUtils::getReportDescriptor() asks the operating system.
+    ///
+    /// \param path The device path.
+    /// \param descriptor The descriptor bytes.
+    /// \returns true if the backend supplied the descriptor.
+    virtual bool getReportDescriptor(const std::string& path,
+                                     std::vector<uint8_t>& descriptor);
+
+    /// \returns the installed backend.
+    static std::shared_ptr<HIDBackend> get();
+
+    /// \brief Install a backend.
+    /// \param backend The backend, or nullptr to restore the hidapi backend.
+    static void set(std::shared_ptr<HIDBackend> backend);
+
+private:
+    /// \brief Guards the installed backend.
+    static std::mutex _backendMutex;
+
+    /// \brief The installed backend, or nullptr for the hidapi backend.
+    static std::shared_ptr<HIDBackend> _backend;
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,280 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "ofx/IO/HIDDevice.h"
+#include "ofx/IO/HIDReport.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Maps a device's tick counter onto the host monotonic timebase.
+///
+/// The clock sync pings the device periodically. Each response carries the
+/// device tick count, which is paired with the midpoint of the host send and
+/// receive times. Samples with the shortest round trips carry the least USB
+/// and scheduling jitter, so only those are used to fit the offset and drift.
+/// Outliers among them are rejected before a final least squares fit.
+///
+/// Responses start with a one byte sequence number followed by the tick count
+/// in little endian order:
+///
+///     [sequence][tick 0][tick 1]...[tick tickBytes - 1]
+///
+/// With Mode::FEATURE_REPORT, each ping reads the response feature report and
+/// the device should latch its tick count when the request arrives. With
+/// Mode::OUTPUT_REPORT, each ping writes an output report holding the
+/// sequence number and the device answers with an input report, which the
+/// application passes to handleReport().
+class HIDClockSync
+{
+public:
+    /// \brief How the device is pinged.
+    enum class Mode
+    {
+        /// \brief Read a feature report holding the device ticks.
+        FEATURE_REPORT,
+        /// \brief Write an output report and wait for an input report.
+        OUTPUT_REPORT
+    };
+
+    /// \brief Clock sync settings.
+    struct Settings
+    {
+        /// \brief How the device is pinged.
+        Mode mode = Mode::FEATURE_REPORT;
+
+        /// \brief The output report id of pings, for Mode::OUTPUT_REPORT.
+        uint8_t pingReportId = 0x00;
+
+        /// \brief The feature or input report id of responses.
+        ///
+        /// Input reports are expected to start with this id if it is not 0x00.
+        uint8_t responseReportId = 0x00;
+
+        /// \brief The size of the device tick counter in bytes, up to 8.
+        std::size_t tickBytes = 4;
+
+        /// \brief The number of device ticks per second.
+        double ticksPerSecond = 1000000;
+
+        /// \brief The time between pings in microseconds.
+        uint64_t intervalMicros = 100000;
+
+        /// \brief The time after which an unanswered ping is discarded.
+        uint64_t timeoutMicros = 1000000;
+
+        /// \brief The number of recent samples kept.
+        std::size_t windowSize = 64;
+
+        /// \brief The fraction of samples with the shortest round trips used
+        ///        for the fit.
+        double selectFraction = 0.25;
+    };
+
+    /// \brief The current mapping from device time to host time.
+    struct Estimate
+    {
+        /// \brief True once at least one sample has been fit.
+        bool synchronized = false;
+
+        /// \brief The host time at the reference point in microseconds.
+        double hostReferenceMicros = 0;
+
+        /// \brief The device time at the reference point in microseconds,
+        ///        relative to the first sample.
+        double deviceReferenceMicros = 0;
+
+        /// \brief Host microseconds per device microsecond.
+        double drift = 1;
+
+        /// \brief The RMS residual of the fit in microseconds.
+        double residualMicros = 0;
+
+        /// \brief The shortest round trip in the window in microseconds.
+        uint64_t minRoundTripMicros = 0;
+
+        /// \brief The number of samples used by the fit.
+        std::size_t samplesUsed = 0;
+    };
+
+    /// \brief Create a HIDClockSync.
+    HIDClockSync();
+
+    /// \brief Destroy the HIDClockSync, stopping its thread.
+    ~HIDClockSync();
+
+    /// \brief Set up the clock sync for a device with default settings.
+    /// \param device The device to ping. Must outlive the clock sync.
+    /// \returns true if the settings are valid.
+    bool setup(HIDDevice& device);
+
+    /// \brief Set up the clock sync for a device.
+    /// \param device The device to ping. Must outlive the clock sync.
+    /// \param settings The clock sync settings.
+    /// \returns true if the settings are valid.
+    bool setup(HIDDevice& device, const Settings& settings);
+
+    /// \brief Start pinging the device from a background thread.
+    void start();
+
+    /// \brief Stop the background thread.
+    void stop();
+
+    /// \returns true if the background thread is running.
+    bool isRunning() const;
+
+    /// \brief Ping the device once.
+    ///
+    /// With Mode::FEATURE_REPORT the sample is added before returning. With
+    /// Mode::OUTPUT_REPORT the sample is added when the response is passed to
+    /// handleReport().
+    ///
+    /// \returns true if the ping was sent.
+    bool ping();
+
+    /// \brief Handle an input report that may be a ping response.
+    /// \param report The input report.
+    /// \returns true if the report answered an outstanding ping.
+    bool handleReport(const HIDReport& report);
+
+    /// \brief Handle an input report that may be a ping response.
+    /// \param data The report data as returned by HIDDevice::read().
+    /// \param size The size of the report data in bytes.
+    /// \param receiveMicros The host monotonic time the report was received.
+    /// \returns true if the report answered an outstanding ping.
+    bool handleReport(const uint8_t* data,
+                      std::size_t size,
+                      uint64_t receiveMicros);
+
+    /// \brief Add a sample and update the estimate.
+    /// \param sendMicros The host monotonic time the ping was sent.
+    /// \param receiveMicros The host monotonic time the response was received.
+    /// \param deviceTicks The device tick count in the response.
+    void addSample(uint64_t sendMicros,
+                   uint64_t receiveMicros,
+                   uint64_t deviceTicks);
+
+    /// \brief Reset all samples, e.g. after the device restarts.
+    void reset();
+
+    /// \returns true once the device time can be translated.
+    bool isSynchronized() const;
+
+    /// \brief Translate a device tick count into host monotonic time.
+    ///
+    /// Tick counts narrower than 64 bits are unwrapped relative to the most
+    /// recent sample, so they must be within half a wrap period of it.
+    ///
+    /// \param deviceTicks The device tick count.
+    /// \returns the host monotonic time in microseconds, or 0 if the clock is
+    ///          not yet synchronized.
+    uint64_t toHostMicros(uint64_t deviceTicks) const;
+
+    /// \returns the current estimate.
+    Estimate estimate() const;
+
+    /// \returns the number of pings sent.
+    uint64_t pingsSent() const;
+
+    /// \returns the number of samples added.
+    uint64_t samplesAdded() const;
+
+    /// \returns the number of pings that failed or timed out.
+    uint64_t pingsFailed() const;
+
+private:
+    /// \brief A single ping exchange.
+    struct Sample
+    {
+        /// \brief The host midpoint, relative to the base, in microseconds.
+        double hostMicros = 0;
+
+        /// \brief The device time, relative to the base, in microseconds.
+        double deviceMicros = 0;
+
+        /// \brief The round trip time in microseconds.
+        uint64_t roundTripMicros = 0;
+    };
+
+    /// \brief Unwrap a tick count relative to the last sample. The mutex must be held.
+    int64_t _unwrap(uint64_t deviceTicks) const;
+
+    /// \brief Refit the estimate from the window. The mutex must be held.
+    void _fit();
+
+    /// \brief The ping loop.
+    void _run();
+
+    /// \brief The device.
+    HIDDevice* _device = nullptr;
+
+    /// \brief The settings.
+    Settings _settings;
+
+    /// \brief The tick counter mask.
+    uint64_t _tickMask = 0;
+
+    /// \brief The next ping sequence number.
+    uint8_t _sequence = 0;
+
+    /// \brief The send time of each outstanding ping by sequence, or 0.
+    std::array<uint64_t, 256> _pending;
+
+    /// \brief True once the bases have been set by the first sample.
+    bool _hasBase = false;
+
+    /// \brief The host time of the first sample in microseconds.
+    uint64_t _hostBaseMicros = 0;
+
+    /// \brief The raw device ticks of the most recent sample.
+    uint64_t _lastTicks = 0;
+
+    /// \brief The unwrapped device ticks of the most recent sample, relative
+    ///        to the first sample.
+    int64_t _lastUnwrappedTicks = 0;
+
+    /// \brief The recent samples.
+    std::deque<Sample> _samples;
+
+    /// \brief The current estimate, relative to the bases.
+    Estimate _estimate;
+
+    /// \brief The number of pings sent.
+    uint64_t _pingsSent = 0;
+
+    /// \brief The number of samples added.
+    uint64_t _samplesAdded = 0;
+
+    /// \brief The number of pings that failed or timed out.
+    uint64_t _pingsFailed = 0;
+
+    /// \brief True while the ping thread should keep running.
+    bool _running = false;
+
+    /// \brief The ping thread.
+    std::thread _thread;
+
+    /// \brief The mutex protecting the state.
+    mutable std::mutex _mutex;
+
+    /// \brief Wakes the ping thread.
+    std::condition_variable _condition;
+
+};
+
+
+} } // namespace ofx::IO
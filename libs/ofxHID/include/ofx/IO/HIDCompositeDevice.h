@@ -0,0 +1,177 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <thread>
+#include "ofx/IO/HIDDevice.h"
+#include "ofx/IO/HIDReportFilter.h"
+#include "ofx/IO/HIDReportSubscriber.h"
+#include "ofx/IO/HIDThreadSettings.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief All HID interfaces of one physical device, opened together.
+///
+/// Composite devices such as Teensy boards expose several HID interfaces,
+/// e.g. RawHID (usage page 0xFFAB) and debug (usage page 0xFFC9). A
+/// HIDCompositeDevice opens every interface with the same vendor id, product
+/// id, serial number and USB port, and merges their input reports into one
+/// time-ordered stream. Each report is tagged with HIDReport::interfaceIndex.
+///
+/// A single background thread services all interfaces by polling them in
+/// turn. When no interface has a report, it sleeps for the poll interval, or
+/// keeps polling in HIDThreadSettings::WaitMode::BUSY_POLL.
+///
+/// Where the USB port cannot be determined, interfaces are grouped by serial
+/// number only.
+class HIDCompositeDevice
+{
+public:
+    /// \brief Create a HIDCompositeDevice.
+    /// \param capacity The number of reports retained for slow subscribers.
+    HIDCompositeDevice(std::size_t capacity = HIDReportRing::DEFAULT_CAPACITY);
+
+    /// \brief Destroy the HIDCompositeDevice, stopping its thread and
+    ///        closing all interfaces.
+    ~HIDCompositeDevice();
+
+    /// \brief Open all interfaces of the first physical device matching the
+    ///        given descriptor.
+    /// \param descriptor A descriptor matching any interface of the device.
+    /// \returns true if all interfaces were opened.
+    bool setup(const HIDDeviceInfo& descriptor);
+
+    /// \brief Stop the reader thread and close all interfaces.
+    void close();
+
+    /// \returns true if the interfaces are open.
+    bool isOpen() const;
+
+    /// \returns the number of interfaces.
+    std::size_t interfaceCount() const;
+
+    /// \brief Get the info of an interface.
+    /// \param index The interface index.
+    /// \returns the interface info.
+    const HIDDeviceInfo& interfaceInfo(std::size_t index) const;
+
+    /// \brief Get the device of an interface.
+    ///
+    /// The device can be used for writes and feature reports. Its input
+    /// reports are read by the composite device's thread.
+    ///
+    /// \param index The interface index.
+    /// \returns the interface device.
+    HIDDevice& interfaceDevice(std::size_t index);
+
+    /// \brief Find an interface by its top-level usage.
+    /// \param usagePage The usage page.
+    /// \param usage The usage, or HIDDeviceInfo::UNDEFINED_USAGE for any.
+    /// \returns the interface index, or -1 if there is none.
+    int findInterface(uint16_t usagePage,
+                      uint16_t usage = HIDDeviceInfo::UNDEFINED_USAGE) const;
+
+    /// \brief Write an output report to an interface.
+    /// \param index The interface index.
+    /// \param reportId The numbered report id.
+    /// \param reportData The report data to write.
+    /// \returns the number of data bytes written, or -1 on error.
+    std::streamsize writeReport(std::size_t index,
+                                uint8_t reportId,
+                                const std::vector<uint8_t>& reportData);
+
+    /// \brief Start the reader thread.
+    /// \returns true if the thread was started or is already running.
+    bool start();
+
+    /// \brief Stop the reader thread and wait for it to exit.
+    void stop();
+
+    /// \returns true if the reader thread is running.
+    bool isRunning() const;
+
+    /// \brief Set the reader thread settings.
+    ///
+    /// The settings are applied when the reader thread starts.
+    ///
+    /// \param settings The reader thread settings.
+    void setThreadSettings(const HIDThreadSettings& settings);
+
+    /// \brief Set the time to sleep when no interface has a report.
+    /// \param pollIntervalMicros The poll interval in microseconds.
+    void setPollIntervalMicros(uint64_t pollIntervalMicros);
+
+    /// \returns the time to sleep when no interface has a report.
+    uint64_t getPollIntervalMicros() const;
+
+    /// \brief Filter reports before they are published.
+    ///
+    /// Reports dropped by the filter never reach subscribers. This must be
+    /// called while the reader thread is stopped.
+    ///
+    /// \param filter The filter, or nullptr to publish every report.
+    void setFilter(std::shared_ptr<HIDReportFilter> filter);
+
+    /// \returns the filter, or nullptr if every report is published.
+    std::shared_ptr<HIDReportFilter> filter() const;
+
+    /// \brief Create a new subscriber to the merged stream.
+    /// \returns a new subscriber.
+    std::unique_ptr<HIDReportSubscriber> subscribe() const;
+
+    /// \returns the shared report ring.
+    std::shared_ptr<HIDReportRing> ring() const;
+
+    /// \brief Group the interfaces of physical devices.
+    /// \param devices The interfaces to group, e.g. from HIDDeviceUtils.
+    /// \returns the interfaces of each physical device, ordered by interface
+    ///          number.
+    static std::vector<HIDDeviceInfo::DeviceList> groupInterfaces(const HIDDeviceInfo::DeviceList& devices);
+
+    /// \brief The default poll interval in microseconds.
+    static const uint64_t DEFAULT_POLL_INTERVAL_MICROS;
+
+private:
+    /// \brief The reader thread loop.
+    void _run();
+
+    /// \brief The interface infos.
+    HIDDeviceInfo::DeviceList _infos;
+
+    /// \brief The interface devices.
+    std::vector<std::unique_ptr<HIDDevice>> _devices;
+
+    /// \brief The shared report ring.
+    std::shared_ptr<HIDReportRing> _ring;
+
+    /// \brief The optional receive path filter.
+    std::shared_ptr<HIDReportFilter> _filter;
+
+    /// \brief The reader thread settings.
+    HIDThreadSettings _threadSettings;
+
+    /// \brief The mutex protecting the reader thread settings.
+    mutable std::mutex _threadSettingsMutex;
+
+    /// \brief The poll interval in microseconds.
+    std::atomic<uint64_t> _pollIntervalMicros;
+
+    /// \brief True while the reader thread should keep running.
+    std::atomic<bool> _running;
+
+    /// \brief The reader thread.
+    std::thread _thread;
+
+};
+
+
+} } // namespace ofx::IO
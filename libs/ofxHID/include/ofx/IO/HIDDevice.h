@@ -8,16 +8,35 @@
 #pragma once
 
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include "hidapi/hidapi.h"
 #include "ofConstants.h"
 #include "ofLog.h"
+#include "ofx/IO/HIDBackend.h"
 #include "ofx/IO/HIDDeviceInfo.h"
+#include "ofx/IO/HIDOutputReportCache.h"
+#include "ofx/IO/HIDReportLayout.h"
 
 
 namespace ofx {
 namespace IO {
 
 
+/// \brief A connection to a HID device.
+///
+/// HIDDevice is thread-safe. Reads, writes and feature reports each use an
+/// independent lock, so one thread can read while another writes. Calls on
+/// the same path are serialized, and feature reports are serialized with each
+/// other.
+///
+/// close() and setup() may be called while other threads are reading or
+/// writing. They wait for calls that are in flight to return before the
+/// handle is released, so close() may block for up to the read timeout.
+/// Calls that start after close() begins fail as if no device were open.
+/// Reads and writes do not take a lock to check the handle.
 class HIDDevice
 {
 public:
@@ -47,7 +66,23 @@ public:
     /// \returns true if successfully opened.
     bool setup(const HIDDeviceInfo& descriptor);
 
+    /// \brief Open a device directly by its path, without enumerating.
+    ///
+    /// Paths can be reassigned when devices are reconnected, so the opened
+    /// device is validated against the defined serial number, manufacturer
+    /// and product strings of the info. On platforms where the report
+    /// descriptor is available, the usage page and usage are validated too.
+    ///
+    /// \param info The device info, including the path to open.
+    /// \returns true if the device was opened and matched the info.
+    bool setupWithPath(const HIDDeviceInfo& info);
+
     /// \brief Close any open connection.
+    ///
+    /// Calls in progress on other threads are allowed to finish first. Reads
+    /// block in slices of at most READ_SLICE_MILLIS and give up when the
+    /// device is closing, so even a read with INFINITE_TIMEOUT delays close()
+    /// by no more than one slice.
     void close();
 
     /// \returns true if a device is connected.
@@ -58,9 +93,14 @@ public:
     /// Will send via the first OUT endpoint if it exists, otherwise it will use
     /// the first CONTROL endpoint (endpoint 0).
     ///
+    /// If the output report cache is enabled, unchanged reports are not sent
+    /// and small changes may be sent as delta reports. In both cases the
+    /// return value is the same as if the full report had been written.
+    ///
     /// \param reportId The numbered report id.
     /// \param reportData The report data to write.
     /// \returns the number of data bytes written, or -1 on error.
+    /// \sa setOutputReportCacheMode()
     std::streamsize writeReport(uint8_t reportId,
                                 const std::vector<uint8_t>& reportData);
 
@@ -93,11 +133,12 @@ public:
     ///
     /// \param reportId The report id to query.
     /// \param reportData A vector of data to be filled.
-    /// \param readBufferSize The read buffer size.
+    /// \param readBufferSize The read buffer size, or 0 to use
+    ///        getFeaturePacketSize().
     /// \returns the number of report data bytes read, or -1 on failure.
     std::streamsize readFeatureReport(uint8_t reportId,
                                       std::vector<uint8_t>& reportData,
-                                      std::size_t readBufferSize = DEFAULT_READ_BUFFER_SIZE);
+                                      std::size_t readBufferSize = 0);
 
     /// \brief Read the default feature report.
     ///
@@ -109,10 +150,11 @@ public:
     /// returned. Failure is indicated by a return value of -1.
     ///
     /// \param reportData A vector of data to be filled.
-    /// \param readBufferSize The read buffer size.
+    /// \param readBufferSize The read buffer size, or 0 to use
+    ///        getFeaturePacketSize().
     /// \returns the number of report data bytes read, or -1 on failure.
     std::streamsize readFeatureReport(std::vector<uint8_t>& reportData,
-                                      std::size_t readBufferSize = DEFAULT_READ_BUFFER_SIZE);
+                                      std::size_t readBufferSize = 0);
 
 
     /// \brief Read data from the HID device.
@@ -122,11 +164,47 @@ public:
     /// uses numbered reports.
     ///
     /// \param buffer The buffer to fill.
-    /// \param readBufferSize The read buffer size.
+    /// \param readBufferSize The read buffer size, or 0 to use
+    ///        getReadPacketSize().
     /// \returns the number of bytes read.
     std::streamsize read(std::vector<uint8_t>& buffer,
-                         std::size_t readBufferSize = DEFAULT_READ_BUFFER_SIZE);
+                         std::size_t readBufferSize = 0);
+
+    /// \brief Read data from the HID device with an explicit timeout.
+    ///
+    /// This behaves like read(), but uses the given timeout instead of the
+    /// device read timeout. A timeout of 0 polls without blocking.
+    ///
+    /// \param buffer The buffer to fill.
+    /// \param timeoutMillis The read timeout in milliseconds.
+    /// \param readBufferSize The read buffer size, or 0 to use
+    ///        getReadPacketSize().
+    /// \returns the number of bytes read.
+    std::streamsize readWithTimeout(std::vector<uint8_t>& buffer,
+                                    uint64_t timeoutMillis,
+                                    std::size_t readBufferSize = 0);
+
 
+    /// \brief Read data from the HID device into a caller-provided buffer.
+    ///
+    /// This behaves like read(), but does not allocate.
+    ///
+    /// \param buffer The buffer to fill.
+    /// \param size The size of the buffer in bytes.
+    /// \returns the number of bytes read, or -1 on error.
+    std::streamsize read(uint8_t* buffer, std::size_t size);
+
+    /// \brief Read a report with a fixed layout.
+    ///
+    /// The report type must provide a Layout typedef describing a
+    /// HIDReportLayout and an unpack() member, e.g. HIDTypedReport. Reports
+    /// with a different report id or size are discarded and 0 is returned.
+    ///
+    /// \param report The report to fill.
+    /// \returns the number of report data bytes read, 0 if no matching report
+    ///          was read, or -1 on error.
+    template<typename ReportT>
+    std::streamsize read(ReportT& report);
 
     /// \brief Write data to the HID device.
     ///
@@ -134,14 +212,39 @@ public:
     /// does not, it will send the data through the Control Endpoint
     /// (Endpoint 0).
     ///
+    /// The report is always sent, but it is remembered by the output report
+    /// cache so that a later writeReport() compares against it.
+    ///
     /// \param reportId The report id to write.
     /// \param reportData The data to write.
     /// \returns the number of report data bytes written.
     std::streamsize write(uint8_t reportId, const std::vector<uint8_t>& reportData);
 
+    /// \brief Write a buffer that already starts with the report id.
+    ///
+    /// This behaves like write(), but does not allocate. The output report
+    /// cache forgets the report id, so the next writeReport() is sent in full.
+    ///
+    /// \param buffer The report id followed by the report data.
+    /// \param size The size of the buffer in bytes.
+    /// \returns the number of report data bytes written, or -1 on error.
+    std::streamsize write(const uint8_t* buffer, std::size_t size);
+
+    /// \brief Write a report with a fixed layout.
+    ///
+    /// The report type must provide a Layout typedef describing a
+    /// HIDReportLayout and a pack() member, e.g. HIDTypedReport. Bits not
+    /// covered by a field are sent as zero.
+    ///
+    /// \param report The report to write.
+    /// \returns the number of report data bytes written, or -1 on error.
+    template<typename ReportT>
+    std::streamsize write(const ReportT& report);
+
     /// \brief Set the read timeout in milliseconds.
     ///
-    /// INIFINITE_TIMEOUT causes reads to block.
+    /// INIFINITE_TIMEOUT causes reads to block until a report arrives or
+    /// the device is closed.
     ///
     /// \param readTimeoutMillis The number of read timeout millis.
     void setReadTimeoutMillis(uint64_t readTimeoutMillis);
@@ -150,6 +253,14 @@ public:
     uint64_t getReadTimeoutMillis() const;
 
     /// \brief Set the read packet size in number of bytes.
+    ///
+    /// This is the buffer size used by read() and readWithTimeout() when no
+    /// size is given. It should include the report id byte if the device
+    /// uses numbered reports.
+    ///
+    /// setup() derives the packet sizes from the device's report descriptor
+    /// where available, and otherwise uses DEFAULT_READ_BUFFER_SIZE.
+    ///
     /// \param size The packet size in number of bytes.
     void setReadPacketSize(std::size_t size);
 
@@ -157,19 +268,72 @@ public:
     std::size_t getReadPacketSize() const;
 
     /// \brief Set the write packet size in number of bytes.
+    ///
+    /// This is the size of the longest output report, including the report
+    /// id byte. It can be used to size output buffers.
+    ///
     /// \param size The packet size in number of bytes.
     void setWritePacketSize(std::size_t size);
 
     /// \returns the write packet size in number of bytes.
     std::size_t getWritePacketSize() const;
 
+    /// \brief Set the feature packet size in number of bytes.
+    ///
+    /// This is the buffer size used by readFeatureReport() when no size is
+    /// given, including the report id byte.
+    ///
+    /// \param size The packet size in number of bytes.
+    void setFeaturePacketSize(std::size_t size);
+
+    /// \returns the feature packet size in number of bytes.
+    std::size_t getFeaturePacketSize() const;
+
+    /// \returns the info of the most recently opened device, or nullptr if
+    ///          no device has been opened. The pointer is invalidated by
+    ///          setup().
+    const HIDDeviceInfo* deviceInfo() const;
+
+    /// \brief Set the mode of the output report cache used by writeReport().
+    ///
+    /// The cache is disabled by default. It is cleared when the device is
+    /// opened or closed, and when the mode changes.
+    ///
+    /// \param mode The cache mode.
+    void setOutputReportCacheMode(HIDOutputReportCache::Mode mode);
+
+    /// \brief Configure delta reports for the output report cache.
+    /// \param deltaReportId The firmware-agreed delta report id.
+    /// \param maxDeltaRatio The maximum delta to full report size ratio.
+    void setOutputReportCacheDelta(uint8_t deltaReportId, float maxDeltaRatio);
+
+    /// \brief Forget all reports remembered by the output report cache.
+    void clearOutputReportCache();
+
+    /// \brief Reset the output report cache counters to zero.
+    void resetOutputReportCacheCounters();
+
+    /// \brief Get the output report cache used by writeReport().
+    ///
+    /// Its settings and counters may be read from any thread while writes
+    /// are in flight. Use the HIDDevice methods above to change it.
+    ///
+    /// \returns the output report cache used by writeReport().
+    const HIDOutputReportCache& outputReportCache() const;
+
     /// \brief The value for a blocking timeout.
     static const uint64_t INFINITE_TIMEOUT;
 
     /// \brief The default value for read timeout in milliseconds.
     static const uint64_t DEFAULT_READ_TIMEOUT;
 
-    /// \brief The default read buffer size in bytes.
+    /// \brief The longest single blocking read in milliseconds.
+    ///
+    /// Longer reads are split into slices, and close() waits for at most one.
+    static const uint64_t READ_SLICE_MILLIS;
+
+    /// \brief The default read buffer size in bytes, used when the report
+    ///        descriptor is not available.
     static const std::size_t DEFAULT_READ_BUFFER_SIZE;
 
 protected:
@@ -180,8 +344,41 @@ protected:
     const hid_device* device() const;
 
 private:
+    /// \brief Holds the device handle open for the duration of a call.
+    ///
+    /// close() waits for all leases to be released before closing the handle.
+    class HandleLease
+    {
+    public:
+        /// \brief Lease the handle of the given device.
+        HandleLease(const HIDDevice& device);
+
+        /// \brief Release the lease.
+        ~HandleLease();
+
+        /// \returns the leased handle, or nullptr if no device is open.
+        hid_device* get() const;
+
+    private:
+        /// \brief The device whose handle is leased.
+        const HIDDevice& _device;
+
+        /// \brief The leased handle.
+        hid_device* _handle = nullptr;
+
+    };
+
     /// \brief The read timeout in milliseconds
-    uint64_t _readTimeoutMillis = DEFAULT_READ_TIMEOUT;
+    std::atomic<uint64_t> _readTimeoutMillis;
+
+    /// \brief The read packet size in bytes.
+    std::atomic<std::size_t> _readPacketSize;
+
+    /// \brief The write packet size in bytes.
+    std::atomic<std::size_t> _writePacketSize;
+
+    /// \brief The feature packet size in bytes.
+    std::atomic<std::size_t> _featurePacketSize;
 
 //    /// \brief The write buffer, used for write operations.
 //    std::vector<uint8_t> _writeBuffer;
@@ -189,13 +386,107 @@ private:
 //    /// \brief The read buffer, used for read operations.
 //    std::vector<uint8_t> _readBuffer;
 
+    /// \brief Read into a buffer with the given timeout.
+    /// \returns the hid_read_timeout() result.
+    std::streamsize _read(hid_device* handle,
+                          uint8_t* buffer,
+                          std::size_t size,
+                          uint64_t timeoutMillis);
+
+    /// \brief Write a report id followed by report data.
+    ///
+    /// The write mutex must be held.
+    ///
+    /// \returns the hid_write() result.
+    std::streamsize _write(hid_device* handle,
+                           uint8_t reportId,
+                           const std::vector<uint8_t>& reportData);
+
+    /// \brief Close the handle. The lifecycle mutex must be held.
+    void _close();
+
+    /// \brief Derive the packet sizes from the device's report descriptor.
+    void _configurePacketSizes(const std::string& path);
+
+    /// \brief The output report cache used by writeReport().
+    HIDOutputReportCache _outputReportCache;
+
+    /// \brief The backend that opened the device handle.
+    ///
+    /// Only replaced while no handle is open, so calls holding a lease can
+    /// use it without locking.
+    std::shared_ptr<HIDBackend> _backend = nullptr;
+
     /// \brief The HID device handle.
-    hid_device* _deviceHandle = nullptr;
+    std::atomic<hid_device*> _deviceHandle;
 
     /// \brief The HID device info.
     std::unique_ptr<HIDDeviceInfo> _deviceInfo = nullptr;
 
+    /// \brief The number of calls using the handle.
+    mutable std::atomic<uint32_t> _inFlight;
+
+    /// \brief True while close() waits for calls in flight.
+    mutable std::atomic<bool> _closing;
+
+    /// \brief Serializes setup() and close().
+    std::mutex _lifecycleMutex;
+
+    /// \brief Serializes reads.
+    std::mutex _readMutex;
+
+    /// \brief Serializes writes and guards the output report cache.
+    std::mutex _writeMutex;
+
+    /// \brief Serializes feature reports.
+    std::mutex _featureMutex;
+
+    /// \brief Guards the close condition.
+    mutable std::mutex _closeMutex;
+
+    /// \brief Signals close() when the last call in flight returns.
+    mutable std::condition_variable _closeCondition;
+
 };
 
 
+template<typename ReportT>
+std::streamsize HIDDevice::read(ReportT& report)
+{
+    typedef typename ReportT::Layout Layout;
+
+    const std::size_t offset = (Layout::REPORT_ID == 0x00) ? 0 : 1;
+
+    // Leave room for one extra byte to detect oversized reports.
+    std::array<uint8_t, Layout::SIZE + 2> buffer;
+
+    std::streamsize result = read(buffer.data(), offset + Layout::SIZE + 1);
+
+    if (result <= 0)
+        return result;
+
+    if (std::size_t(result) != offset + Layout::SIZE
+    ||  (offset == 1 && buffer[0] != Layout::REPORT_ID))
+    {
+        ofLogVerbose("HIDDevice::read") << "Discarding report that does not match the layout.";
+        return 0;
+    }
+
+    report.unpack(buffer.data() + offset);
+    return std::streamsize(Layout::SIZE);
+}
+
+
+template<typename ReportT>
+std::streamsize HIDDevice::write(const ReportT& report)
+{
+    typedef typename ReportT::Layout Layout;
+
+    std::array<uint8_t, Layout::SIZE + 1> buffer = {};
+    buffer[0] = Layout::REPORT_ID;
+    report.pack(buffer.data() + 1);
+    return write(buffer.data(), buffer.size());
+}
+
+
 } } // namespace ofx::IO
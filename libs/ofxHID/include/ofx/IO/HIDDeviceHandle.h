@@ -0,0 +1,152 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include "ofx/IO/HIDDeviceInfo.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A lightweight handle to an enumerated HID device.
+///
+/// The path, ids, usage and interface number are available immediately. The
+/// serial number, manufacturer and product strings may need USB control
+/// requests, so they are fetched only on first use, or in parallel with
+/// HIDDeviceUtils::fetchStrings(). They are fetched at most once and shared
+/// by all copies of the handle.
+class HIDDeviceHandle
+{
+public:
+    /// \brief The string properties of a device.
+    struct Strings
+    {
+        /// \brief The product serial number.
+        std::string serialNumber;
+
+        /// \brief The manufacturer string.
+        std::string manufacturer;
+
+        /// \brief The product string.
+        std::string product;
+    };
+
+    /// \brief A function that fetches the strings of a device.
+    typedef std::function<Strings(const HIDDeviceHandle&)> StringFetcher;
+
+    /// \brief Create a HIDDeviceHandle.
+    /// \param vendorId The Vendor ID, assigned by USB organization.
+    /// \param productId The product ID, assigned by the manufactuer.
+    /// \param usagePage The top level usage page.
+    /// \param usage The top level usage.
+    /// \param path The platform-specific device path.
+    /// \param interfaceNumber The interface number for composite devices.
+    /// \param fetcher The function used to fetch the strings on first use.
+    HIDDeviceHandle(uint16_t vendorId,
+                    uint16_t productId,
+                    uint16_t usagePage,
+                    uint16_t usage,
+                    const std::string& path,
+                    int interfaceNumber,
+                    StringFetcher fetcher);
+
+    /// \brief Destroy the HIDDeviceHandle.
+    ~HIDDeviceHandle();
+
+    /// \returns the Vendor ID, assigned by USB organization.
+    uint16_t vendorId() const;
+
+    /// \returns the product ID, assigned by the manufactuer.
+    uint16_t productId() const;
+
+    /// \returns the top level usage page.
+    uint16_t usagePage() const;
+
+    /// \returns the top level usage.
+    uint16_t usage() const;
+
+    /// \returns the platform-specific device path.
+    std::string path() const;
+
+    /// \returns the interface number for composite devices.
+    int interfaceNumber() const;
+
+    /// \brief Get the device strings, fetching them on first use.
+    ///
+    /// Concurrent callers wait for a single fetch.
+    ///
+    /// \returns the device strings.
+    const Strings& strings() const;
+
+    /// \returns true if the strings have already been fetched.
+    bool hasStrings() const;
+
+    /// \returns the product serial number, fetching it on first use.
+    std::string serialNumber() const;
+
+    /// \returns the manufacturer string, fetching it on first use.
+    std::string manufacturer() const;
+
+    /// \returns the product string, fetching it on first use.
+    std::string product() const;
+
+    /// \returns a fully-defined HIDDeviceInfo, fetching strings on first use.
+    HIDDeviceInfo toDeviceInfo() const;
+
+    /// \brief Fetch strings by opening the device and querying it.
+    /// \param handle The device to query.
+    /// \returns the strings, with undefined values for any that failed.
+    static Strings fetchStringsFromDevice(const HIDDeviceHandle& handle);
+
+private:
+    /// \brief The state shared by all copies of a handle.
+    struct State
+    {
+        /// \brief The Vendor ID.
+        uint16_t vendorId = HIDDeviceInfo::UNDEFINED_VENDOR_ID;
+
+        /// \brief The product ID.
+        uint16_t productId = HIDDeviceInfo::UNDEFINED_PRODUCT_ID;
+
+        /// \brief The top level usage page.
+        uint16_t usagePage = HIDDeviceInfo::UNDEFINED_USAGE_PAGE;
+
+        /// \brief The top level usage.
+        uint16_t usage = HIDDeviceInfo::UNDEFINED_USAGE;
+
+        /// \brief The platform-specific device path.
+        std::string path;
+
+        /// \brief The interface number.
+        int interfaceNumber = HIDDeviceInfo::UNDEFINED_INTERFACE_NUMBER;
+
+        /// \brief The function used to fetch the strings.
+        StringFetcher fetcher;
+
+        /// \brief Guards the single fetch.
+        std::once_flag once;
+
+        /// \brief True once the strings have been fetched.
+        std::atomic<bool> fetched;
+
+        /// \brief The memoized strings.
+        Strings strings;
+    };
+
+    /// \brief The shared state.
+    std::shared_ptr<State> _state;
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,110 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofJson.h"
+#include "ofx/IO/HIDDevice.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Remembers where known devices were last seen.
+///
+/// The registry stores the full HIDDeviceInfo of each device it has opened,
+/// keyed by vendor id, product id, serial number, usage page, usage and
+/// interface number. On the next launch, open() tries the cached paths
+/// directly and validates the device, falling back to a full enumeration
+/// only when no cached path matches.
+///
+/// The registry is not thread-safe.
+class HIDDeviceRegistry
+{
+public:
+    /// \brief Create an empty HIDDeviceRegistry.
+    HIDDeviceRegistry();
+
+    /// \brief Destroy the HIDDeviceRegistry.
+    ~HIDDeviceRegistry();
+
+    /// \brief Load the registry from a JSON file, replacing its contents.
+    /// \param path The JSON file path.
+    /// \returns true if the file was loaded.
+    bool load(const std::string& path);
+
+    /// \brief Save the registry to a JSON file.
+    /// \param path The JSON file path.
+    /// \returns true if the file was saved.
+    bool save(const std::string& path) const;
+
+    /// \brief Open a device matching the query.
+    ///
+    /// Matching cached paths are tried first. On a miss, the device is opened
+    /// with HIDDevice::setup() and remembered.
+    ///
+    /// \param device The device to open.
+    /// \param query A partially defined HIDDeviceInfo to match.
+    /// \returns true if the device was opened.
+    bool open(HIDDevice& device, const HIDDeviceInfo& query);
+
+    /// \brief Remember a fully defined device, replacing any entry with the
+    ///        same identity.
+    /// \param info The device info.
+    void remember(const HIDDeviceInfo& info);
+
+    /// \brief Forget all devices matching the query.
+    /// \param query A partially defined HIDDeviceInfo to match.
+    void forget(const HIDDeviceInfo& query);
+
+    /// \brief Remove all devices.
+    void clear();
+
+    /// \brief Find cached devices matching the query.
+    /// \param query A partially defined HIDDeviceInfo to match.
+    /// \returns the matching cached devices.
+    HIDDeviceInfo::DeviceList find(const HIDDeviceInfo& query) const;
+
+    /// \returns all cached devices.
+    const HIDDeviceInfo::DeviceList& devices() const;
+
+    /// \returns the number of opens that used a cached path.
+    uint64_t hits() const;
+
+    /// \returns the number of opens that needed an enumeration.
+    uint64_t misses() const;
+
+    /// \returns the JSON representation of the registry.
+    ofJson toJSON() const;
+
+    /// \brief Replace the registry contents from JSON.
+    /// \param json The JSON representation of a registry.
+    void fromJSON(const ofJson& json);
+
+private:
+    /// \returns true if two devices have the same identity.
+    static bool _sameIdentity(const HIDDeviceInfo& a, const HIDDeviceInfo& b);
+
+    /// \returns true if the device matches all defined fields of the query,
+    ///          except the path.
+    static bool _matches(const HIDDeviceInfo& query, const HIDDeviceInfo& device);
+
+    /// \brief The cached devices.
+    HIDDeviceInfo::DeviceList _devices;
+
+    /// \brief The number of opens that used a cached path.
+    uint64_t _hits = 0;
+
+    /// \brief The number of opens that needed an enumeration.
+    uint64_t _misses = 0;
+
+};
+
+
+} } // namespace ofx::IO
@@ -8,6 +8,7 @@
 #pragma once
 
 
+#include "ofx/IO/HIDDeviceHandle.h"
 #include "ofx/IO/HIDDeviceInfo.h"
 
 
@@ -45,17 +46,106 @@ public:
     /// Will match all set elements of the HIDDeviceInfo, with the exception of
     /// the platform specific path.
     ///
+    /// Devices are first matched on their ids, usage and interface number.
+    /// Strings are then fetched in parallel for the remaining candidates only.
+    ///
     /// \returns a list of matching devices, or none if matching failed.
     static HIDDeviceInfo::DeviceList listDevicesWithInfo(const HIDDeviceInfo& info);
 
-    /// \brief Convert a wchar_t string to a multi-byte string.
+    /// \brief List lightweight handles to available HID devices.
+    ///
+    /// Handles are returned without converting or fetching any strings. The
+    /// strings are fetched on first use with the given fetcher.
+    ///
+    /// \param vendorId The vendor id to match, or UNDEFINED_VENDOR_ID for any.
+    /// \param productId The product id to match, or UNDEFINED_PRODUCT_ID for any.
+    /// \param fetcher The string fetcher, or an empty function to use the
+    ///        strings reported during enumeration.
+    /// \returns a list of device handles.
+    static std::vector<HIDDeviceHandle> listDeviceHandles(uint16_t vendorId = HIDDeviceInfo::UNDEFINED_VENDOR_ID,
+                                                          uint16_t productId = HIDDeviceInfo::UNDEFINED_PRODUCT_ID,
+                                                          HIDDeviceHandle::StringFetcher fetcher = HIDDeviceHandle::StringFetcher());
+
+    /// \brief Fetch the strings of many devices in parallel.
+    ///
+    /// Handles whose strings were already fetched are skipped. The worker
+    /// threads are started on first use and reused by later calls.
+    ///
+    /// \param handles The device handles.
+    /// \param threadCount The number of worker threads, or 0 to use the
+    ///        number of hardware threads.
+    static void fetchStrings(const std::vector<HIDDeviceHandle>& handles,
+                             std::size_t threadCount = 0);
+
+    /// \brief Get the USB port path of the device at the given HID path.
+    ///
+    /// The USB port path identifies the physical port chain, e.g. "1-1.2" for
+    /// port 2 of the hub on port 1 of bus 1. It is found through sysfs and is
+    /// only available on Linux.
+    ///
+    /// \param path The platform-specific HID device path.
+    /// \returns the USB port path, or an empty string if unknown.
+    static std::string getUSBPortPath(const std::string& path);
+
+    /// \brief Get the USB port path of the hub the device is attached to.
+    ///
+    /// Devices attached directly to a root port return the bus root hub, e.g.
+    /// "usb1".
+    ///
+    /// \param path The platform-specific HID device path.
+    /// \returns the hub port path, or an empty string if unknown.
+    static std::string getUSBHubPath(const std::string& path);
+
+    /// \brief Get the polling interval of the device's interrupt OUT endpoint.
     ///
-    /// This will typically result in a UTF8-encoded string if the user's locale
-    /// is set to use UTF-8.
+    /// This is only available on Linux.
+    ///
+    /// \param path The platform-specific HID device path.
+    /// \returns the interval in microseconds, or 0 if unknown or if output
+    ///          reports are sent on the control endpoint.
+    static uint64_t getOutputIntervalMicros(const std::string& path);
+
+    /// \brief Read the raw report descriptor of a HID device.
+    ///
+    /// The installed HIDBackend is asked first. Otherwise this is currently
+    /// only supported on Linux, where it is read from sysfs without opening
+    /// the device.
+    ///
+    /// \param path The platform-specific HID device path.
+    /// \param descriptor The vector to fill with the descriptor bytes.
+    /// \returns true if the descriptor was read.
+    static bool getReportDescriptor(const std::string& path,
+                                    std::vector<uint8_t>& descriptor);
+
+    /// \brief Reset the USB device that a HID device belongs to.
+    ///
+    /// This is equivalent to unplugging and reconnecting the device. All open
+    /// handles to the device become invalid and the device may re-enumerate
+    /// with a new path. Currently only supported on Linux, where it usually
+    /// requires write access to /dev/bus/usb.
+    ///
+    /// \param path The platform-specific HID device path.
+    /// \returns true if the reset was requested.
+    static bool resetUSBDevice(const std::string& path);
+
+    /// \brief Convert a wchar_t string to a UTF-8 encoded string.
+    ///
+    /// The input is treated as UTF-32 or UTF-16, depending on the size of
+    /// wchar_t, and the result does not depend on the user's locale. Invalid
+    /// code points and unpaired surrogates are replaced with U+FFFD.
     ///
     /// \param input The wchar_t string input.
+    /// \returns the UTF-8 encoded string, or an empty string if input is null.
     static std::string toMultiByteString(const wchar_t* input);
 
+    /// \brief Get the host monotonic time in microseconds.
+    ///
+    /// This clock is used to timestamp reports. It is not related to wall
+    /// clock time and is not affected by system time changes.
+    ///
+    /// \returns the host monotonic time in microseconds.
+    static uint64_t monotonicTimeMicros();
+
 };
 
 
@@ -0,0 +1,273 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include "ofEvents.h"
+#include "ofx/IO/HIDReportBroadcaster.h"
+#include "ofx/IO/HIDThreadSettings.h"
+#include "ofx/IO/HIDTimerWheel.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Detects devices that stop sending reports and tries to recover them.
+///
+/// The watchdog learns each device's report cadence from its broadcaster and
+/// flags a stall when no report arrives within a few expected intervals.
+/// Recovery escalates from a feature report poke, to closing and reopening
+/// the device, to a USB reset where available. Later attempts alternate
+/// between reopening and resetting until reports resume.
+///
+/// All devices share a single thread and timer wheel. Recovery actions run on
+/// that thread, and events are notified from it.
+class HIDDeviceWatchdog
+{
+public:
+    /// \brief The recovery stage of a device.
+    enum class Stage
+    {
+        /// \brief Reports are arriving.
+        HEALTHY,
+        /// \brief Reports stopped and no recovery action is enabled.
+        STALLED,
+        /// \brief A feature report was requested to wake the device.
+        POKE,
+        /// \brief The device was closed and reopened.
+        REOPEN,
+        /// \brief The USB device was reset.
+        USB_RESET
+    };
+
+    /// \brief Watchdog settings for a single device.
+    struct DeviceSettings
+    {
+        /// \brief The number of expected intervals without a report that is a stall.
+        double stallIntervals = 4;
+
+        /// \brief The minimum stall timeout in microseconds.
+        uint64_t minimumStallMicros = 20000;
+
+        /// \brief The stall timeout used until the cadence has been learned.
+        uint64_t initialStallMicros = 1000000;
+
+        /// \brief The number of report intervals needed to learn the cadence.
+        std::size_t learningReports = 8;
+
+        /// \brief The feature report id to poke, or -1 to skip the poke.
+        int pokeFeatureReportId = -1;
+
+        /// \brief True if the device may be closed and reopened.
+        bool reopen = true;
+
+        /// \brief True if the USB device may be reset.
+        bool usbReset = true;
+
+        /// \brief The time allowed for a reopen or reset to take effect.
+        uint64_t recoveryMicros = 2000000;
+    };
+
+    /// \brief Health counters for a single device.
+    struct DeviceStats
+    {
+        /// \brief The platform-specific device path.
+        std::string path;
+
+        /// \brief The current recovery stage.
+        Stage stage = Stage::HEALTHY;
+
+        /// \brief The learned report interval in microseconds, or 0 if not yet learned.
+        uint64_t expectedIntervalMicros = 0;
+
+        /// \brief The current stall timeout in microseconds.
+        uint64_t stallTimeoutMicros = 0;
+
+        /// \brief The host monotonic time of the last report.
+        uint64_t lastReportMicros = 0;
+
+        /// \brief The number of reports seen.
+        uint64_t reports = 0;
+
+        /// \brief The number of stalls detected.
+        uint64_t stalls = 0;
+
+        /// \brief The number of stalls that recovered.
+        uint64_t recoveries = 0;
+
+        /// \brief The number of feature report pokes.
+        uint64_t pokes = 0;
+
+        /// \brief The number of reopens.
+        uint64_t reopens = 0;
+
+        /// \brief The number of USB resets.
+        uint64_t usbResets = 0;
+
+        /// \brief The number of recovery actions that failed.
+        uint64_t failedActions = 0;
+    };
+
+    /// \brief Arguments for watchdog events.
+    struct EventArgs
+    {
+        /// \brief The broadcaster of the affected device.
+        HIDReportBroadcaster* broadcaster = nullptr;
+
+        /// \brief The device counters at the time of the event.
+        DeviceStats stats;
+    };
+
+    /// \brief Create a HIDDeviceWatchdog.
+    /// \param tickMicros The timer wheel resolution in microseconds.
+    HIDDeviceWatchdog(uint64_t tickMicros = HIDTimerWheel::DEFAULT_TICK_MICROS);
+
+    /// \brief Destroy the HIDDeviceWatchdog, stopping its thread.
+    ~HIDDeviceWatchdog();
+
+    /// \brief Watch a device with the default settings.
+    /// \param broadcaster The device's broadcaster. Must outlive the watch.
+    /// \returns true if the device was added.
+    bool addDevice(HIDReportBroadcaster& broadcaster);
+
+    /// \brief Watch a device.
+    /// \param broadcaster The device's broadcaster. Must outlive the watch.
+    /// \param settings The watchdog settings for the device.
+    /// \returns true if the device was added.
+    bool addDevice(HIDReportBroadcaster& broadcaster,
+                   const DeviceSettings& settings);
+
+    /// \brief Stop watching a device.
+    ///
+    /// Waits for any recovery action on the device to finish.
+    ///
+    /// \param broadcaster The device's broadcaster.
+    void removeDevice(HIDReportBroadcaster& broadcaster);
+
+    /// \brief Start the watchdog thread.
+    void start();
+
+    /// \brief Stop the watchdog thread and wait for it to exit.
+    void stop();
+
+    /// \returns true if the watchdog thread is running.
+    bool isRunning() const;
+
+    /// \brief Set the watchdog thread settings.
+    ///
+    /// The settings are applied when the thread starts.
+    ///
+    /// \param settings The thread settings.
+    void setThreadSettings(const HIDThreadSettings& settings);
+
+    /// \returns the counters for all watched devices.
+    std::vector<DeviceStats> stats() const;
+
+    /// \brief Notified when a device stalls.
+    ofEvent<EventArgs> onStall;
+
+    /// \brief Notified after each recovery action.
+    ofEvent<EventArgs> onRecoveryAction;
+
+    /// \brief Notified when a stalled device sends reports again.
+    ofEvent<EventArgs> onRecovered;
+
+private:
+    /// \brief The state of a watched device.
+    struct Device
+    {
+        /// \brief The device's broadcaster.
+        HIDReportBroadcaster* broadcaster = nullptr;
+
+        /// \brief The subscriber used to observe reports.
+        std::unique_ptr<HIDReportSubscriber> subscriber;
+
+        /// \brief The device info used to reopen the device.
+        std::unique_ptr<HIDDeviceInfo> info;
+
+        /// \brief The device settings.
+        DeviceSettings settings;
+
+        /// \brief The device counters.
+        DeviceStats stats;
+
+        /// \brief The timestamp of the previous report, or 0 after a gap.
+        uint64_t previousReportMicros = 0;
+
+        /// \brief The ring sequence of the previous report.
+        uint64_t previousSequence = 0;
+
+        /// \brief The smoothed report interval in microseconds.
+        double intervalMicros = 0;
+
+        /// \brief The smoothed interval deviation in microseconds.
+        double deviationMicros = 0;
+
+        /// \brief The number of intervals learned.
+        std::size_t intervals = 0;
+    };
+
+    /// \brief The watchdog thread loop.
+    void _run();
+
+    /// \brief Check a device whose timer expired. Called with the lock held.
+    void _check(uint64_t id,
+                uint64_t nowMicros,
+                std::unique_lock<std::mutex>& lock);
+
+    /// \brief Learn from a report. Called with the lock held.
+    void _learn(Device& device, const HIDReport& report);
+
+    /// \returns the stall timeout for a device.
+    static uint64_t _stallTimeoutMicros(const Device& device);
+
+    /// \returns the time of the next check for a healthy device.
+    static uint64_t _nextCheckMicros(const Device& device, uint64_t nowMicros);
+
+    /// \returns true if the stage's action is enabled for a device.
+    static bool _isEnabled(const Device& device, Stage stage);
+
+    /// \brief The watched devices by id.
+    std::map<uint64_t, std::unique_ptr<Device>> _devices;
+
+    /// \brief The ids of watched devices by broadcaster.
+    std::map<HIDReportBroadcaster*, uint64_t> _ids;
+
+    /// \brief The next device id.
+    uint64_t _nextId = 0;
+
+    /// \brief The id of the device with a recovery action in flight, or 0.
+    uint64_t _activeId = 0;
+
+    /// \brief The check timers.
+    HIDTimerWheel _wheel;
+
+    /// \brief The watchdog thread settings.
+    HIDThreadSettings _threadSettings;
+
+    /// \brief True while the watchdog thread should keep running.
+    bool _running = false;
+
+    /// \brief The watchdog thread.
+    std::thread _thread;
+
+    /// \brief The mutex protecting the devices and wheel.
+    mutable std::mutex _mutex;
+
+    /// \brief Signals device removal and shutdown.
+    std::condition_variable _condition;
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <array>
+#include "ofConstants.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Describes where axes and buttons are found in a gamepad input report.
+///
+/// Bit offsets are relative to the report data, not including the report id.
+struct HIDGamepadMapping
+{
+    /// \brief An axis field.
+    struct Axis
+    {
+        /// \brief The offset of the first bit.
+        std::size_t bitOffset = 0;
+
+        /// \brief The number of bits, up to 32.
+        std::size_t bitWidth = 8;
+
+        /// \brief True if the raw value is two's complement.
+        bool isSigned = false;
+
+        /// \brief The raw value mapped to -1.
+        int32_t minimum = 0;
+
+        /// \brief The raw value mapped to 1.
+        int32_t maximum = 255;
+    };
+
+    /// \brief The report id carrying the gamepad state, or 0x00 if the device
+    ///        does not use numbered reports.
+    uint8_t reportId = 0x00;
+
+    /// \brief The axes, in order.
+    std::vector<Axis> axes;
+
+    /// \brief The bit offset of each button, in order.
+    std::vector<std::size_t> buttons;
+
+};
+
+
+/// \brief An immutable snapshot of a gamepad's state.
+///
+/// Snapshots have a fixed size so they can be copied without allocation.
+/// Press and release counters never reset, so comparing two snapshots
+/// reveals every edge between them, even if several frames were skipped.
+struct HIDGamepadState
+{
+    /// \brief The maximum number of axes.
+    static const std::size_t MAX_AXES = 16;
+
+    /// \brief The maximum number of buttons.
+    static const std::size_t MAX_BUTTONS = 64;
+
+    /// \returns true if the button is currently pressed.
+    bool isPressed(std::size_t button) const;
+
+    /// \returns the number of presses of the button since the previous snapshot.
+    uint32_t pressesSince(std::size_t button, const HIDGamepadState& previous) const;
+
+    /// \returns the number of releases of the button since the previous snapshot.
+    uint32_t releasesSince(std::size_t button, const HIDGamepadState& previous) const;
+
+    /// \returns true if the button was pressed at least once since the previous snapshot.
+    bool wasPressed(std::size_t button, const HIDGamepadState& previous) const;
+
+    /// \returns true if the button was released at least once since the previous snapshot.
+    bool wasReleased(std::size_t button, const HIDGamepadState& previous) const;
+
+    /// \brief The number of valid axes.
+    std::size_t axisCount = 0;
+
+    /// \brief The number of valid buttons.
+    std::size_t buttonCount = 0;
+
+    /// \brief The raw axis values.
+    std::array<int32_t, MAX_AXES> rawAxes = {};
+
+    /// \brief The axis values normalized to [-1, 1].
+    std::array<float, MAX_AXES> axes = {};
+
+    /// \brief The button state, one bit per button.
+    uint64_t buttons = 0;
+
+    /// \brief The total number of presses of each button.
+    std::array<uint32_t, MAX_BUTTONS> pressCounts = {};
+
+    /// \brief The total number of releases of each button.
+    std::array<uint32_t, MAX_BUTTONS> releaseCounts = {};
+
+    /// \brief The number of reports decoded into this state.
+    uint64_t reportCount = 0;
+
+    /// \brief The host monotonic time of the last decoded report in microseconds.
+    uint64_t timestampMicros = 0;
+
+};
+
+
+} } // namespace ofx::IO
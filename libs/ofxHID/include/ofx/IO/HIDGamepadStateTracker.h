@@ -0,0 +1,101 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <thread>
+#include "ofx/IO/HIDGamepadState.h"
+#include "ofx/IO/HIDReportBroadcaster.h"
+#include "ofx/IO/HIDTripleBuffer.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Tracks the latest state of a gamepad or joystick.
+///
+/// A background thread consumes every input report from a
+/// HIDReportBroadcaster, decodes axes and buttons and publishes an immutable
+/// HIDGamepadState through a lock-free triple buffer. A single consumer
+/// thread, typically the draw thread, calls latest() to get the newest state
+/// in constant time without locks.
+///
+/// Button edges are counted on the background thread, so presses and
+/// releases between two calls to latest() are never lost.
+class HIDGamepadStateTracker
+{
+public:
+    /// \brief Create a HIDGamepadStateTracker.
+    /// \param broadcaster The report source. Must outlive the tracker.
+    /// \param mapping The location of axes and buttons in the report.
+    HIDGamepadStateTracker(HIDReportBroadcaster& broadcaster,
+                           const HIDGamepadMapping& mapping);
+
+    /// \brief Destroy the HIDGamepadStateTracker, stopping its thread.
+    ~HIDGamepadStateTracker();
+
+    /// \brief Start decoding reports.
+    ///
+    /// Only reports published after this call are decoded.
+    void start();
+
+    /// \brief Stop decoding reports and wait for the thread to exit.
+    void stop();
+
+    /// \returns true if reports are being decoded.
+    bool isRunning() const;
+
+    /// \brief Get the newest state.
+    ///
+    /// The returned reference remains valid and unchanged until the next call
+    /// to latest(). This must always be called from the same thread.
+    ///
+    /// \returns the newest state.
+    const HIDGamepadState& latest();
+
+    /// \brief Decode a report into a state, updating edge counters.
+    /// \param mapping The location of axes and buttons in the report.
+    /// \param data The report data as returned by HIDDevice::read().
+    /// \param size The report size in bytes.
+    /// \param state The state to update.
+    /// \returns true if the report matched the mapping and was decoded.
+    static bool decode(const HIDGamepadMapping& mapping,
+                       const uint8_t* data,
+                       std::size_t size,
+                       HIDGamepadState& state);
+
+private:
+    /// \brief The decoding thread loop.
+    void _run();
+
+    /// \brief The report source.
+    HIDReportBroadcaster& _broadcaster;
+
+    /// \brief The location of axes and buttons in the report.
+    HIDGamepadMapping _mapping;
+
+    /// \brief The report subscription.
+    std::unique_ptr<HIDReportSubscriber> _subscriber;
+
+    /// \brief The state owned by the decoding thread.
+    HIDGamepadState _current;
+
+    /// \brief The states shared with the consumer.
+    HIDTripleBuffer<HIDGamepadState> _states;
+
+    /// \brief True while the decoding thread should keep running.
+    std::atomic<bool> _running;
+
+    /// \brief The decoding thread.
+    std::thread _thread;
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,84 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <vector>
+#include "ofConstants.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A log-linear histogram of latencies in microseconds.
+///
+/// Each power of two is split into eight equal buckets, so any recorded value
+/// is reported within 12.5% of its true value. Recording is constant time and
+/// does not allocate. The histogram is not synchronized.
+class HIDLatencyHistogram
+{
+public:
+    /// \brief Create an empty HIDLatencyHistogram.
+    HIDLatencyHistogram();
+
+    /// \brief Record a latency.
+    /// \param micros The latency in microseconds.
+    void record(uint64_t micros);
+
+    /// \brief Add all latencies recorded by another histogram.
+    /// \param other The other histogram.
+    void merge(const HIDLatencyHistogram& other);
+
+    /// \brief Remove all recorded latencies.
+    void reset();
+
+    /// \returns the number of recorded latencies.
+    uint64_t count() const;
+
+    /// \returns the smallest recorded latency, or 0 if empty.
+    uint64_t minMicros() const;
+
+    /// \returns the largest recorded latency, or 0 if empty.
+    uint64_t maxMicros() const;
+
+    /// \returns the mean recorded latency, or 0 if empty.
+    double meanMicros() const;
+
+    /// \brief Get a latency percentile.
+    /// \param percentile The percentile from 0 to 100.
+    /// \returns the upper bound of the bucket holding the percentile, or 0 if
+    ///          empty.
+    uint64_t percentileMicros(double percentile) const;
+
+private:
+    /// \returns the bucket index for a value.
+    static std::size_t _bucket(uint64_t micros);
+
+    /// \returns the largest value in a bucket.
+    static uint64_t _upperBound(std::size_t bucket);
+
+    /// \brief The bucket counts.
+    std::vector<uint64_t> _buckets;
+
+    /// \brief The number of recorded latencies.
+    uint64_t _count = 0;
+
+    /// \brief The smallest recorded latency.
+    uint64_t _min = 0;
+
+    /// \brief The largest recorded latency.
+    uint64_t _max = 0;
+
+    /// \brief The sum of recorded latencies.
+    double _sum = 0;
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,190 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <map>
+#include "ofConstants.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Remembers the last output report sent for each report id.
+///
+/// When enabled, the cache lets HIDDevice::writeReport() skip frames that are
+/// identical to the last one sent, or replace a mostly unchanged frame with a
+/// small delta report.
+///
+/// Delta reports must be understood by the device firmware. A delta report is
+/// sent with the configured delta report id and has the following payload:
+///
+///     [target report id][patch count]
+///     [offset lo][offset hi][length][length bytes of data] ... per patch
+///
+/// Offsets are relative to the start of the target report data and do not
+/// include the report id byte.
+///
+/// The settings and counters may be read from any thread. Everything else
+/// must be serialized by the owner, e.g. HIDDevice's write lock.
+class HIDOutputReportCache
+{
+public:
+    /// \brief The output report cache mode.
+    enum class Mode
+    {
+        /// \brief Every report is sent in full.
+        DISABLED,
+        /// \brief Reports identical to the last one sent are skipped.
+        SKIP_UNCHANGED,
+        /// \brief Identical reports are skipped and small changes are sent as deltas.
+        DELTA
+    };
+
+    /// \brief What the caller should transmit for a report.
+    enum class Action
+    {
+        /// \brief Send the full report.
+        SEND_FULL,
+        /// \brief Send nothing, the report is unchanged.
+        SKIP,
+        /// \brief Send the encoded delta report.
+        SEND_DELTA
+    };
+
+    /// \brief Create a disabled HIDOutputReportCache.
+    HIDOutputReportCache();
+
+    /// \brief Destroy the HIDOutputReportCache.
+    ~HIDOutputReportCache();
+
+    /// \brief Set the cache mode.
+    ///
+    /// Changing the mode clears all remembered reports.
+    ///
+    /// \param mode The cache mode.
+    void setMode(Mode mode);
+
+    /// \returns the cache mode.
+    Mode getMode() const;
+
+    /// \brief Set the report id used for delta reports.
+    /// \param reportId The firmware-agreed delta report id.
+    void setDeltaReportId(uint8_t reportId);
+
+    /// \returns the report id used for delta reports.
+    uint8_t getDeltaReportId() const;
+
+    /// \brief Set the largest delta, as a fraction of the full report size.
+    ///
+    /// Deltas larger than this are sent as full reports instead.
+    ///
+    /// \param ratio The maximum delta to full report size ratio.
+    void setMaxDeltaRatio(float ratio);
+
+    /// \returns the largest delta, as a fraction of the full report size.
+    float getMaxDeltaRatio() const;
+
+    /// \brief Decide what to transmit for a report.
+    ///
+    /// If the action is Action::SEND_DELTA, delta will hold the delta report
+    /// payload to be sent with getDeltaReportId().
+    ///
+    /// \param reportId The report id.
+    /// \param reportData The report data.
+    /// \param delta The delta payload to fill.
+    /// \returns the action to take.
+    Action process(uint8_t reportId,
+                   const std::vector<uint8_t>& reportData,
+                   std::vector<uint8_t>& delta) const;
+
+    /// \brief Record the outcome of a write.
+    ///
+    /// The report is only remembered if the write succeeded, so a failed
+    /// write is never skipped on the next frame.
+    ///
+    /// \param reportId The report id.
+    /// \param reportData The report data.
+    /// \param action The action that was taken.
+    /// \param success True if the write succeeded.
+    void commit(uint8_t reportId,
+                const std::vector<uint8_t>& reportData,
+                Action action,
+                bool success);
+
+    /// \brief Forget the remembered report for a report id.
+    ///
+    /// The next report for the report id will be sent in full.
+    ///
+    /// \param reportId The report id.
+    void invalidate(uint8_t reportId);
+
+    /// \brief Forget all remembered reports.
+    ///
+    /// The next report for each report id will be sent in full.
+    void clear();
+
+    /// \brief Reset all counters to zero.
+    void resetCounters();
+
+    /// \returns the number of reports sent in full.
+    uint64_t fullCount() const;
+
+    /// \returns the number of reports skipped.
+    uint64_t skippedCount() const;
+
+    /// \returns the number of reports sent as deltas.
+    uint64_t deltaCount() const;
+
+    /// \returns the fraction of reports that were skipped.
+    double skipRatio() const;
+
+    /// \returns the fraction of reports that were sent as deltas.
+    double deltaRatio() const;
+
+    /// \brief The default delta report id.
+    static const uint8_t DEFAULT_DELTA_REPORT_ID;
+
+    /// \brief The default maximum delta to full report size ratio.
+    static const float DEFAULT_MAX_DELTA_RATIO;
+
+private:
+    /// \brief Encode the differences between two equally sized reports.
+    /// \returns false if the delta would be too large.
+    bool _encodeDelta(uint8_t reportId,
+                      const std::vector<uint8_t>& previous,
+                      const std::vector<uint8_t>& current,
+                      std::vector<uint8_t>& delta) const;
+
+    /// \brief The cache mode.
+    std::atomic<Mode> _mode;
+
+    /// \brief The delta report id.
+    std::atomic<uint8_t> _deltaReportId;
+
+    /// \brief The maximum delta to full report size ratio.
+    std::atomic<float> _maxDeltaRatio;
+
+    /// \brief The last report sent for each report id.
+    std::map<uint8_t, std::vector<uint8_t>> _lastReports;
+
+    /// \brief The number of reports sent in full.
+    std::atomic<uint64_t> _fullCount;
+
+    /// \brief The number of reports skipped.
+    std::atomic<uint64_t> _skippedCount;
+
+    /// \brief The number of reports sent as deltas.
+    std::atomic<uint64_t> _deltaCount;
+
+};
+
+
+} } // namespace ofx::IO
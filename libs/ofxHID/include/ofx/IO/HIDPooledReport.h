@@ -0,0 +1,259 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include "ofConstants.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+class HIDReportPool;
+
+
+/// \brief A fixed-capacity report slab owned by a HIDReportPool.
+///
+/// Slabs are reference counted intrusively and are returned to their pool
+/// when the last HIDReportHandle is released. They are never copied.
+class HIDPooledReport
+{
+public:
+    /// \returns a pointer to the report data.
+    uint8_t* data();
+
+    /// \returns a const pointer to the report data.
+    const uint8_t* data() const;
+
+    /// \returns the number of valid report bytes.
+    std::size_t size() const;
+
+    /// \brief Set the number of valid report bytes, clamped to capacity().
+    /// \param size The number of valid report bytes.
+    void setSize(std::size_t size);
+
+    /// \returns the maximum number of report bytes.
+    std::size_t capacity() const;
+
+    /// \brief The report id, or 0x00 if the device does not use numbered reports.
+    uint8_t reportId = 0;
+
+    /// \brief The host monotonic time the report was received in microseconds.
+    uint64_t timestampMicros = 0;
+
+private:
+    friend class HIDReportPool;
+    friend class HIDReportHandle;
+
+    /// \brief Create a slab backed by the given storage.
+    HIDPooledReport(HIDReportPool* pool, uint8_t* data, std::size_t capacity);
+
+    HIDPooledReport(const HIDPooledReport&) = delete;
+    HIDPooledReport& operator = (const HIDPooledReport&) = delete;
+
+    /// \brief Add a reference.
+    void _retain();
+
+    /// \brief Remove a reference, returning the slab to its pool at zero.
+    void _release();
+
+    /// \brief The owning pool.
+    HIDReportPool* _pool = nullptr;
+
+    /// \brief The slab storage.
+    uint8_t* _data = nullptr;
+
+    /// \brief The number of valid report bytes.
+    std::size_t _size = 0;
+
+    /// \brief The slab capacity.
+    std::size_t _capacity = 0;
+
+    /// \brief The number of handles referencing this slab.
+    std::atomic<uint32_t> _references;
+
+};
+
+
+/// \brief A reference-counted handle to a pooled report.
+///
+/// Copying a handle shares the same slab without copying report data, so
+/// handles can be passed between threads and pipeline stages cheaply. The
+/// slab returns to its pool when the last handle is destroyed or reset.
+class HIDReportHandle
+{
+public:
+    /// \brief Create an empty handle.
+    HIDReportHandle();
+
+    /// \brief Create a handle taking a new reference to the report.
+    explicit HIDReportHandle(HIDPooledReport* report);
+
+    /// \brief Share another handle's report.
+    HIDReportHandle(const HIDReportHandle& other);
+
+    /// \brief Take another handle's report, leaving it empty.
+    HIDReportHandle(HIDReportHandle&& other) noexcept;
+
+    /// \brief Release the report.
+    ~HIDReportHandle();
+
+    /// \brief Share another handle's report.
+    HIDReportHandle& operator = (const HIDReportHandle& other);
+
+    /// \brief Take another handle's report, leaving it empty.
+    HIDReportHandle& operator = (HIDReportHandle&& other) noexcept;
+
+    /// \brief Release the report, leaving this handle empty.
+    void reset();
+
+    /// \returns the report, or nullptr if empty.
+    HIDPooledReport* get() const;
+
+    /// \returns the report.
+    HIDPooledReport* operator -> () const;
+
+    /// \returns the report.
+    HIDPooledReport& operator * () const;
+
+    /// \returns true if the handle references a report.
+    explicit operator bool () const;
+
+private:
+    /// \brief The referenced report, or nullptr.
+    HIDPooledReport* _report = nullptr;
+
+};
+
+
+inline uint8_t* HIDPooledReport::data()
+{
+    return _data;
+}
+
+
+inline const uint8_t* HIDPooledReport::data() const
+{
+    return _data;
+}
+
+
+inline std::size_t HIDPooledReport::size() const
+{
+    return _size;
+}
+
+
+inline void HIDPooledReport::setSize(std::size_t size)
+{
+    _size = std::min(size, _capacity);
+}
+
+
+inline std::size_t HIDPooledReport::capacity() const
+{
+    return _capacity;
+}
+
+
+inline void HIDPooledReport::_retain()
+{
+    _references.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+inline HIDReportHandle::HIDReportHandle()
+{
+}
+
+
+inline HIDReportHandle::HIDReportHandle(HIDPooledReport* report): _report(report)
+{
+    if (_report)
+        _report->_retain();
+}
+
+
+inline HIDReportHandle::HIDReportHandle(const HIDReportHandle& other): HIDReportHandle(other._report)
+{
+}
+
+
+inline HIDReportHandle::HIDReportHandle(HIDReportHandle&& other) noexcept: _report(other._report)
+{
+    other._report = nullptr;
+}
+
+
+inline HIDReportHandle::~HIDReportHandle()
+{
+    reset();
+}
+
+
+inline HIDReportHandle& HIDReportHandle::operator = (const HIDReportHandle& other)
+{
+    if (other._report)
+        other._report->_retain();
+
+    reset();
+    _report = other._report;
+    return *this;
+}
+
+
+inline HIDReportHandle& HIDReportHandle::operator = (HIDReportHandle&& other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        _report = other._report;
+        other._report = nullptr;
+    }
+
+    return *this;
+}
+
+
+inline void HIDReportHandle::reset()
+{
+    if (_report)
+    {
+        _report->_release();
+        _report = nullptr;
+    }
+}
+
+
+inline HIDPooledReport* HIDReportHandle::get() const
+{
+    return _report;
+}
+
+
+inline HIDPooledReport* HIDReportHandle::operator -> () const
+{
+    return _report;
+}
+
+
+inline HIDPooledReport& HIDReportHandle::operator * () const
+{
+    return *_report;
+}
+
+
+inline HIDReportHandle::operator bool () const
+{
+    return _report != nullptr;
+}
+
+
+} } // namespace ofx::IO
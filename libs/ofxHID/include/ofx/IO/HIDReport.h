@@ -0,0 +1,40 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofConstants.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief An input report received from an HID device.
+struct HIDReport
+{
+    /// \brief The report data as returned by HIDDevice::read().
+    ///
+    /// The first byte will contain the report number if the device uses
+    /// numbered reports.
+    std::vector<uint8_t> data;
+
+    /// \brief The host monotonic time the report was received in microseconds.
+    uint64_t timestampMicros = 0;
+
+    /// \brief The sequence number assigned to the report when published.
+    uint64_t sequence = 0;
+
+    /// \brief The index of the interface that sent the report, for reports
+    ///        from a HIDCompositeDevice. Otherwise 0.
+    std::size_t interfaceIndex = 0;
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,164 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <thread>
+#include "ofx/IO/HIDDevice.h"
+#include "ofx/IO/HIDReportFilter.h"
+#include "ofx/IO/HIDReportSubscriber.h"
+#include "ofx/IO/HIDSharedMemoryWriter.h"
+#include "ofx/IO/HIDThreadSettings.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Reads input reports from a device and broadcasts them.
+///
+/// A single background thread calls HIDDevice::read() and publishes each
+/// report once into a shared HIDReportRing. Any number of subscribers can
+/// consume the same reports without copying them.
+///
+/// The reader thread uses the device's read timeout, so stop() may take up
+/// to HIDDevice::getReadTimeoutMillis() to return. The read timeout should not
+/// be HIDDevice::INFINITE_TIMEOUT.
+class HIDReportBroadcaster
+{
+public:
+    /// \brief Create a HIDReportBroadcaster for the given device.
+    /// \param device The device to read. Must outlive the broadcaster.
+    /// \param capacity The number of reports retained for slow subscribers.
+    HIDReportBroadcaster(HIDDevice& device,
+                         std::size_t capacity = HIDReportRing::DEFAULT_CAPACITY);
+
+    /// \brief Destroy the HIDReportBroadcaster, stopping the reader thread.
+    ~HIDReportBroadcaster();
+
+    /// \brief Start the reader thread.
+    /// \returns true if the thread was started or is already running.
+    bool start();
+
+    /// \brief Stop the reader thread and wait for it to exit.
+    void stop();
+
+    /// \returns true if the reader thread is running.
+    bool isRunning() const;
+
+    /// \brief Set the reader thread settings.
+    ///
+    /// The settings are applied when the reader thread starts. In
+    /// HIDThreadSettings::WaitMode::BUSY_POLL the reader polls the device
+    /// without blocking instead of waiting for the device read timeout.
+    ///
+    /// \param settings The reader thread settings.
+    void setThreadSettings(const HIDThreadSettings& settings);
+
+    /// \returns the reader thread settings.
+    HIDThreadSettings getThreadSettings() const;
+
+    /// \brief Create a new subscriber.
+    ///
+    /// The subscriber will receive all reports published after this call.
+    ///
+    /// \returns a new subscriber.
+    std::unique_ptr<HIDReportSubscriber> subscribe() const;
+
+    /// \brief Publish a report that was read elsewhere.
+    ///
+    /// This can be used to inject reports when the reader thread is not
+    /// running.
+    ///
+    /// \param data The report data.
+    /// \param timestampMicros The host monotonic receive time.
+    void publish(const std::vector<uint8_t>& data, uint64_t timestampMicros);
+
+    /// \brief Also publish every report into a named shared-memory ring.
+    ///
+    /// Other processes can consume the reports with HIDSharedMemoryReader.
+    /// This must be called while the reader thread is stopped.
+    ///
+    /// \param name The shared-memory object name, e.g. "/ofxHID-teensy".
+    /// \param slotCount The number of reports retained in the ring.
+    /// \param slotSize The maximum report size in bytes, or 0 to use the
+    ///        device's read packet size.
+    /// \returns true if the shared-memory ring was created.
+    bool exportToSharedMemory(const std::string& name,
+                              std::size_t slotCount = HIDSharedMemoryWriter::DEFAULT_SLOT_COUNT,
+                              std::size_t slotSize = 0);
+
+    /// \brief Stop publishing into shared memory and unlink the ring.
+    ///
+    /// This must be called while the reader thread is stopped.
+    void stopSharedMemoryExport();
+
+    /// \brief Filter reports before they are published.
+    ///
+    /// Reports dropped by the filter never reach subscribers or shared memory,
+    /// but still update lastReceiveMicros(), so a HIDDeviceWatchdog does not
+    /// mistake a quiet filter for a stalled device. This must be called while
+    /// the reader thread is stopped.
+    ///
+    /// \param filter The filter, or nullptr to publish every report.
+    void setFilter(std::shared_ptr<HIDReportFilter> filter);
+
+    /// \returns the filter, or nullptr if every report is published.
+    std::shared_ptr<HIDReportFilter> filter() const;
+
+    /// \returns the number of reports published.
+    uint64_t published() const;
+
+    /// \returns the host monotonic time of the last report received, including
+    /// reports dropped by the filter, or 0 if none was received.
+    uint64_t lastReceiveMicros() const;
+
+    /// \returns the shared report ring.
+    std::shared_ptr<HIDReportRing> ring() const;
+
+    /// \returns the device being read.
+    HIDDevice& device() const;
+
+private:
+    /// \brief The reader thread loop.
+    void _run();
+
+    /// \brief Publish a report to all consumers.
+    void _publish(std::shared_ptr<HIDReport> report);
+
+    /// \brief The device to read.
+    HIDDevice& _device;
+
+    /// \brief The shared report ring.
+    std::shared_ptr<HIDReportRing> _ring;
+
+    /// \brief The reader thread settings.
+    HIDThreadSettings _threadSettings;
+
+    /// \brief The mutex protecting the reader thread settings.
+    mutable std::mutex _threadSettingsMutex;
+
+    /// \brief The optional receive path filter.
+    std::shared_ptr<HIDReportFilter> _filter;
+
+    /// \brief The optional shared-memory export.
+    HIDSharedMemoryWriter _sharedMemoryWriter;
+
+    /// \brief The receive time of the last report, taken before filtering.
+    std::atomic<uint64_t> _lastReceiveMicros;
+
+    /// \brief True while the reader thread should keep running.
+    std::atomic<bool> _running;
+
+    /// \brief The reader thread.
+    std::thread _thread;
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,113 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <map>
+#include <vector>
+#include "ofConstants.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief The report lengths declared by a HID report descriptor.
+///
+/// Only the items needed to compute report lengths and the top-level usage
+/// are interpreted: Usage Page, Usage, Report Size, Report Count, Report ID,
+/// Push, Pop, Collection and the Input, Output and Feature main items.
+class HIDReportDescriptor
+{
+public:
+    /// \brief The type of a report.
+    enum class ReportType
+    {
+        INPUT,
+        OUTPUT,
+        FEATURE
+    };
+
+    /// \brief Create an empty HIDReportDescriptor.
+    HIDReportDescriptor();
+
+    /// \brief Destroy the HIDReportDescriptor.
+    ~HIDReportDescriptor();
+
+    /// \brief Parse a raw report descriptor.
+    /// \param descriptor The raw report descriptor bytes.
+    /// \returns true if the descriptor was parsed without errors.
+    bool parse(const std::vector<uint8_t>& descriptor);
+
+    /// \returns true if the device uses numbered reports.
+    bool usesReportIds() const;
+
+    /// \returns the usage page of the first top-level collection, or
+    ///          HIDDeviceInfo::UNDEFINED_USAGE_PAGE if there is none.
+    uint16_t usagePage() const;
+
+    /// \returns the usage of the first top-level collection, or
+    ///          HIDDeviceInfo::UNDEFINED_USAGE if there is none.
+    uint16_t usage() const;
+
+    /// \returns the usage page and usage of every top-level collection, in
+    ///          descriptor order.
+    const std::vector<std::pair<uint16_t, uint16_t>>& topLevelUsages() const;
+
+    /// \brief Determine if any top-level collection has a usage.
+    ///
+    /// HIDDeviceInfo::UNDEFINED_USAGE_PAGE and HIDDeviceInfo::UNDEFINED_USAGE
+    /// match any usage page and usage.
+    ///
+    /// \param usagePage The usage page.
+    /// \param usage The usage.
+    /// \returns true if a top-level collection matches.
+    bool hasTopLevelUsage(uint16_t usagePage, uint16_t usage) const;
+
+    /// \brief Get the length of a report.
+    /// \param type The report type.
+    /// \param reportId The report id, or 0x00 for unnumbered reports.
+    /// \returns the report data length in bytes, not including the report id,
+    ///          or 0 if the report is not declared.
+    std::size_t reportLength(ReportType type, uint8_t reportId) const;
+
+    /// \brief Get the length of the longest report of a type.
+    /// \param type The report type.
+    /// \returns the report data length in bytes, not including the report id.
+    std::size_t maxReportLength(ReportType type) const;
+
+    /// \brief Get the buffer size needed to transfer any report of a type.
+    ///
+    /// Output and feature transfers always carry a report id byte. Input
+    /// reports carry one only if the device uses numbered reports.
+    ///
+    /// \param type The report type.
+    /// \returns the buffer size in bytes, or 0 if no report of the type is
+    ///          declared.
+    std::size_t maxTransferSize(ReportType type) const;
+
+private:
+    /// \brief The report lengths in bits by type and report id.
+    std::map<std::pair<ReportType, uint8_t>, std::size_t> _reportBits;
+
+    /// \brief True if any Report ID item was found.
+    bool _usesReportIds = false;
+
+    /// \brief The usage page of the first top-level collection.
+    uint16_t _usagePage;
+
+    /// \brief The usage of the first top-level collection.
+    uint16_t _usage;
+
+    /// \brief The usage page and usage of every top-level collection.
+    std::vector<std::pair<uint16_t, uint16_t>> _topLevelUsages;
+
+};
+
+
+} } // namespace ofx::IO
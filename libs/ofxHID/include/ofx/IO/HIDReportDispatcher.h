@@ -0,0 +1,148 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <functional>
+#include "ofEvents.h"
+#include "ofx/IO/HIDReportBroadcaster.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Delivers reports to the main thread once per frame.
+///
+/// Each device's HIDReportBroadcaster collects reports on its own background
+/// thread. On every ofEvents().update the dispatcher drains the devices'
+/// subscribers and notifies onReports once with all new reports, so handler
+/// overhead is per frame rather than per report.
+///
+/// Reports beyond the batch limit stay queued for the next frame. If a
+/// device's ring overflows in the meantime, the oldest reports are dropped
+/// and counted.
+///
+/// The dispatcher must only be used from the main thread.
+class HIDReportDispatcher
+{
+public:
+    /// \brief A function that returns true for reports to deliver.
+    typedef std::function<bool(const HIDReport&)> Filter;
+
+    /// \brief A report and the device it came from.
+    struct Entry
+    {
+        /// \brief The broadcaster of the device that sent the report.
+        HIDReportBroadcaster* broadcaster = nullptr;
+
+        /// \brief The report.
+        HIDReportRing::SharedReport report;
+    };
+
+    /// \brief The reports delivered in one frame.
+    struct Batch
+    {
+        /// \brief The reports, in order of arrival for each device.
+        std::vector<Entry> entries;
+
+        /// \brief The number of reports dropped since the previous batch.
+        uint64_t dropped = 0;
+    };
+
+    /// \brief Create a HIDReportDispatcher listening to ofEvents().update.
+    HIDReportDispatcher();
+
+    /// \brief Destroy the HIDReportDispatcher.
+    ~HIDReportDispatcher();
+
+    /// \brief Deliver reports from a device.
+    /// \param broadcaster The device's broadcaster. Must outlive the dispatcher
+    ///        or be removed first.
+    /// \param filter An optional filter applied before delivery.
+    void addDevice(HIDReportBroadcaster& broadcaster, Filter filter = Filter());
+
+    /// \brief Stop delivering reports from a device.
+    /// \param broadcaster The device's broadcaster.
+    void removeDevice(HIDReportBroadcaster& broadcaster);
+
+    /// \brief Set the maximum number of reports in a batch.
+    /// \param size The maximum batch size, or 0 for no limit.
+    void setMaxBatchSize(std::size_t size);
+
+    /// \returns the maximum number of reports in a batch, or 0 for no limit.
+    std::size_t getMaxBatchSize() const;
+
+    /// \brief Collect and deliver a batch now.
+    ///
+    /// This is called automatically on ofEvents().update, and can be called
+    /// directly when there is no openFrameworks main loop.
+    void update();
+
+    /// \returns the number of reports delivered.
+    uint64_t delivered() const;
+
+    /// \returns the number of reports dropped before delivery.
+    uint64_t dropped() const;
+
+    /// \returns the number of reports removed by filters.
+    uint64_t filtered() const;
+
+    /// \brief Notified on the main thread once per frame with new reports.
+    ///
+    /// Not notified when there are no new reports.
+    ofEvent<Batch> onReports;
+
+    /// \brief The default maximum batch size.
+    static const std::size_t DEFAULT_MAX_BATCH_SIZE;
+
+private:
+    /// \brief A device that reports are delivered from.
+    struct Device
+    {
+        /// \brief The device's broadcaster.
+        HIDReportBroadcaster* broadcaster = nullptr;
+
+        /// \brief The subscriber used to collect reports.
+        std::unique_ptr<HIDReportSubscriber> subscriber;
+
+        /// \brief The optional filter.
+        Filter filter;
+
+        /// \brief The subscriber drop count already reported.
+        uint64_t dropped = 0;
+    };
+
+    /// \brief The ofEvents().update callback.
+    void _update(ofEventArgs& args);
+
+    /// \brief The devices.
+    std::vector<Device> _devices;
+
+    /// \brief The batch, reused between frames.
+    Batch _batch;
+
+    /// \brief The maximum batch size.
+    std::size_t _maxBatchSize = DEFAULT_MAX_BATCH_SIZE;
+
+    /// \brief The device to collect from first, rotated for fairness.
+    std::size_t _firstDevice = 0;
+
+    /// \brief The number of reports delivered.
+    uint64_t _delivered = 0;
+
+    /// \brief The number of reports dropped.
+    uint64_t _dropped = 0;
+
+    /// \brief The number of reports filtered.
+    uint64_t _filtered = 0;
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,232 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <map>
+#include <mutex>
+#include "ofx/IO/HIDReport.h"
+#include "ofx/IO/HIDReportDescriptor.h"
+#include "ofx/IO/HIDReportLayout.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Drops input reports that the application does not need.
+///
+/// A filter is installed on the receive path of a HIDReportBroadcaster or a
+/// HIDCompositeDevice, so reports it drops are never published. Each report
+/// id can have its own rule. Within a rule, reports are first decimated,
+/// then throttled to a minimum interval, and finally compared with the last
+/// report that passed:
+///
+/// - With dropUnchanged, a report identical to the last one is dropped.
+/// - With deadband fields, changes within a field's deadband are ignored.
+///   Bits outside of the fields must still match for a report to be dropped.
+///
+/// Reports are compared against the last report that passed, so slow drift
+/// eventually exceeds a deadband. Reports of each interface of a composite
+/// device are filtered independently.
+class HIDReportFilter
+{
+public:
+    /// \brief A numeric field compared with a deadband.
+    struct Field
+    {
+        /// \brief How the field bits are interpreted.
+        enum class Type
+        {
+            /// \brief An unsigned integer.
+            UNSIGNED,
+            /// \brief A two's complement signed integer.
+            SIGNED,
+            /// \brief A byte aligned 32 or 64 bit IEEE 754 float.
+            ///
+            /// Float fields of any other width or alignment are logged and
+            /// ignored by setRule().
+            FLOAT
+        };
+
+        /// \brief The offset of the first bit, relative to the report data.
+        std::size_t bitOffset = 0;
+
+        /// \brief The number of bits used by the field, up to 64.
+        std::size_t bitWidth = 8;
+
+        /// \brief How the field bits are interpreted.
+        Type type = Type::UNSIGNED;
+
+        /// \brief The largest change that is ignored.
+        double deadband = 0;
+    };
+
+    /// \brief The filter rule for a report id.
+    struct Rule
+    {
+        /// \brief True if reports identical to the last passed report are dropped.
+        bool dropUnchanged = false;
+
+        /// \brief The fields compared with a deadband.
+        std::vector<Field> fields;
+
+        /// \brief Pass one of every N reports. 0 and 1 pass all reports.
+        std::size_t decimation = 1;
+
+        /// \brief The minimum time between passed reports in microseconds.
+        uint64_t minIntervalMicros = 0;
+    };
+
+    /// \brief The filter counters.
+    struct Stats
+    {
+        /// \brief The number of reports that passed.
+        uint64_t passed = 0;
+
+        /// \brief The number of reports dropped as unchanged or within deadbands.
+        uint64_t unchanged = 0;
+
+        /// \brief The number of reports dropped by decimation.
+        uint64_t decimated = 0;
+
+        /// \brief The number of reports dropped by the minimum interval.
+        uint64_t throttled = 0;
+
+        /// \returns the total number of reports dropped.
+        uint64_t filtered() const;
+    };
+
+    /// \brief Create a HIDReportFilter.
+    ///
+    /// Unnumbered devices such as a Teensy RawHID carry report data in the
+    /// first byte, so filters assume unnumbered reports unless told otherwise.
+    ///
+    /// \param numberedReports True if the first report byte is the report id.
+    HIDReportFilter(bool numberedReports = false);
+
+    /// \brief Create a HIDReportFilter for a device's report descriptor.
+    /// \param descriptor The parsed report descriptor of the device.
+    HIDReportFilter(const HIDReportDescriptor& descriptor);
+
+    /// \brief Destroy the HIDReportFilter.
+    ~HIDReportFilter();
+
+    /// \brief Set the rule for a report id.
+    /// \param reportId The report id, or 0x00 for unnumbered reports.
+    /// \param rule The rule.
+    void setRule(uint8_t reportId, const Rule& rule);
+
+    /// \brief Set the rule for report ids without their own rule.
+    /// \param rule The rule.
+    void setDefaultRule(const Rule& rule);
+
+    /// \brief Remove all rules and state. All reports will pass.
+    void clear();
+
+    /// \brief Decide whether a report passes the filter.
+    ///
+    /// This updates the filter state, so each report must be passed once.
+    ///
+    /// \param report The report.
+    /// \returns true if the report should be published.
+    bool accept(const HIDReport& report);
+
+    /// \returns the counters for all report ids.
+    Stats stats() const;
+
+    /// \param reportId The report id.
+    /// \returns the counters for a report id.
+    Stats stats(uint8_t reportId) const;
+
+    /// \brief Reset all counters.
+    void resetStats();
+
+    /// \brief Describe a HIDReportField as a deadband field.
+    /// \tparam FieldT The HIDReportField type.
+    /// \param deadband The largest change that is ignored.
+    /// \returns the field.
+    template<typename FieldT>
+    static Field field(double deadband);
+
+private:
+    /// \brief The filter state for an interface and report id.
+    struct State
+    {
+        /// \brief The last report data that passed.
+        std::vector<uint8_t> last;
+
+        /// \brief True once a report has passed.
+        bool hasLast = false;
+
+        /// \brief The time the last report passed.
+        uint64_t lastMicros = 0;
+
+        /// \brief The number of reports since the last decimated pass.
+        std::size_t count = 0;
+
+        /// \brief The counters.
+        Stats stats;
+    };
+
+    /// \brief A rule with the bits covered by its fields.
+    struct Entry
+    {
+        /// \brief The rule.
+        Rule rule;
+
+        /// \brief The payload bits covered by deadband fields.
+        std::vector<uint8_t> covered;
+    };
+
+    /// \returns an entry for the rule.
+    static Entry _makeEntry(const Rule& rule);
+
+    /// \returns true if the payload differs from the last passed payload.
+    static bool _changed(const Entry& entry,
+                         const uint8_t* last,
+                         const uint8_t* data,
+                         std::size_t size);
+
+    /// \returns a field's value.
+    static double _value(const Field& field, const uint8_t* data);
+
+    /// \brief True if the first report byte is the report id.
+    bool _numberedReports = false;
+
+    /// \brief The rules by report id.
+    std::map<uint8_t, Entry> _rules;
+
+    /// \brief The rule for report ids without their own rule.
+    Entry _defaultRule;
+
+    /// \brief The state by interface index and report id.
+    std::map<std::pair<std::size_t, uint8_t>, State> _states;
+
+    /// \brief The mutex protecting the rules and state.
+    mutable std::mutex _mutex;
+
+};
+
+
+template<typename FieldT>
+HIDReportFilter::Field HIDReportFilter::field(double deadband)
+{
+    typedef typename FieldT::Type T;
+
+    Field result;
+    result.bitOffset = FieldT::BIT_OFFSET;
+    result.bitWidth = FieldT::BIT_WIDTH;
+    result.type = std::is_floating_point<T>::value ? Field::Type::FLOAT
+                : (std::is_signed<T>::value ? Field::Type::SIGNED : Field::Type::UNSIGNED);
+    result.deadband = deadband;
+    return result;
+}
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,323 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "ofConstants.h"
+
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "HIDReportLayout assumes a little-endian host.");
+#endif
+
+
+namespace ofx {
+namespace IO {
+
+
+namespace HIDReportLayoutDetail {
+
+
+/// \brief The unsigned type used to pack unaligned integral fields.
+template<typename T, bool = std::is_integral<T>::value && !std::is_same<T, bool>::value>
+struct UnsignedType
+{
+    typedef typename std::make_unsigned<T>::type type;
+};
+
+
+template<typename T>
+struct UnsignedType<T, false>
+{
+    typedef uint8_t type;
+};
+
+
+} // namespace HIDReportLayoutDetail
+
+
+/// \brief A field in a fixed report layout.
+///
+/// HID report fields are little-endian and may start at any bit. Fields that
+/// start on a byte boundary and use the full width of their type are copied
+/// with std::memcpy. Other fields are packed with shifts and masks. Signed
+/// fields narrower than their type are sign-extended when unpacked.
+///
+/// \tparam T The arithmetic type of the field.
+/// \tparam BitOffset The offset of the first bit, relative to the report data.
+/// \tparam BitWidth The number of bits used by the field.
+template<typename T, std::size_t BitOffset, std::size_t BitWidth = sizeof(T) * 8>
+struct HIDReportField
+{
+    static_assert(std::is_arithmetic<T>::value, "Report fields must be arithmetic types.");
+    static_assert(BitWidth > 0 && BitWidth <= sizeof(T) * 8, "The bit width must fit in the field type.");
+    static_assert(std::is_integral<T>::value || (BitOffset % 8 == 0 && BitWidth == sizeof(T) * 8),
+                  "Floating point fields must be byte aligned and use the full width of their type.");
+    static_assert((BitOffset % 8) + BitWidth <= 64, "Unaligned fields must span at most 8 bytes.");
+
+    /// \brief The field type.
+    typedef T Type;
+
+    /// \brief The offset of the first bit.
+    static constexpr std::size_t BIT_OFFSET = BitOffset;
+
+    /// \brief The number of bits used by the field.
+    static constexpr std::size_t BIT_WIDTH = BitWidth;
+
+    /// \brief The offset one past the last bit.
+    static constexpr std::size_t BIT_END = BitOffset + BitWidth;
+
+    /// \brief True if the field can be copied with std::memcpy.
+    static constexpr bool IS_BYTE_ALIGNED = (BitOffset % 8 == 0) && (BitWidth == sizeof(T) * 8);
+
+    /// \brief Unpack the field from report data.
+    /// \param data The report data, not including the report id.
+    /// \returns the field value.
+    static T unpack(const uint8_t* data)
+    {
+        return _unpack(data, std::integral_constant<bool, IS_BYTE_ALIGNED>());
+    }
+
+    /// \brief Pack the field into report data.
+    ///
+    /// Bits outside of the field are not modified.
+    ///
+    /// \param data The report data, not including the report id.
+    /// \param value The field value.
+    static void pack(uint8_t* data, T value)
+    {
+        _pack(data, value, std::integral_constant<bool, IS_BYTE_ALIGNED>());
+    }
+
+private:
+    typedef typename HIDReportLayoutDetail::UnsignedType<T>::type UnsignedType;
+
+    static constexpr std::size_t FIRST_BYTE = BitOffset / 8;
+    static constexpr std::size_t BYTE_COUNT = ((BitOffset % 8) + BitWidth + 7) / 8;
+    static constexpr std::size_t SHIFT = BitOffset % 8;
+    static constexpr uint64_t MASK = (BitWidth == 64) ? ~uint64_t(0) : ((uint64_t(1) << BitWidth) - 1);
+
+    static T _unpack(const uint8_t* data, std::true_type)
+    {
+        T value;
+        std::memcpy(&value, data + FIRST_BYTE, sizeof(T));
+        return value;
+    }
+
+    static T _unpack(const uint8_t* data, std::false_type)
+    {
+        uint64_t bits = 0;
+
+        for (std::size_t i = 0; i < BYTE_COUNT; ++i)
+            bits |= uint64_t(data[FIRST_BYTE + i]) << (8 * i);
+
+        bits = (bits >> SHIFT) & MASK;
+
+        // Sign-extend narrow signed fields.
+        if (std::is_signed<T>::value && BitWidth < 64 && (bits >> (BitWidth - 1)) & 1)
+            bits |= ~MASK;
+
+        return T(UnsignedType(bits));
+    }
+
+    static void _pack(uint8_t* data, T value, std::true_type)
+    {
+        std::memcpy(data + FIRST_BYTE, &value, sizeof(T));
+    }
+
+    static void _pack(uint8_t* data, T value, std::false_type)
+    {
+        uint64_t bits = (uint64_t(UnsignedType(value)) & MASK) << SHIFT;
+        uint64_t mask = MASK << SHIFT;
+
+        for (std::size_t i = 0; i < BYTE_COUNT; ++i)
+        {
+            uint8_t byteMask = uint8_t(mask >> (8 * i));
+            data[FIRST_BYTE + i] = uint8_t((data[FIRST_BYTE + i] & ~byteMask) | (uint8_t(bits >> (8 * i)) & byteMask));
+        }
+    }
+
+};
+
+
+namespace HIDReportLayoutDetail {
+
+
+/// \returns true if all fields end within the given number of bits.
+template<typename... Fields>
+constexpr bool fieldsFit(std::size_t bits)
+{
+    const std::size_t ends[] = { 0, Fields::BIT_END... };
+
+    for (std::size_t end: ends)
+    {
+        if (end > bits)
+            return false;
+    }
+
+    return true;
+}
+
+
+/// \returns true if no two fields share a bit.
+template<typename... Fields>
+constexpr bool fieldsDisjoint()
+{
+    const std::size_t begins[] = { 0, Fields::BIT_OFFSET... };
+    const std::size_t ends[] = { 0, Fields::BIT_END... };
+
+    for (std::size_t i = 1; i < sizeof(begins) / sizeof(begins[0]); ++i)
+    {
+        for (std::size_t j = i + 1; j < sizeof(begins) / sizeof(begins[0]); ++j)
+        {
+            if (begins[i] < ends[j] && begins[j] < ends[i])
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+} // namespace HIDReportLayoutDetail
+
+
+/// \brief A report layout that is fixed at compile time.
+///
+/// For example, a gamepad input report with id 1, two 16-bit axes and eight
+/// buttons packed into one byte:
+///
+///     typedef HIDReportLayout<0x01, 5,
+///                             HIDReportField<int16_t, 0>,
+///                             HIDReportField<int16_t, 16>,
+///                             HIDReportField<uint8_t, 32>> GamepadLayout;
+///
+///     HIDTypedReport<GamepadLayout> report;
+///
+///     if (device.read(report) > 0)
+///         int16_t x = report.get<0>();
+///
+/// Fields that overlap or do not fit in the report are compile-time errors.
+///
+/// \tparam ReportId The report id, or 0x00 if the device does not use
+///         numbered reports.
+/// \tparam Size The size of the report data in bytes, not including the
+///         report id.
+/// \tparam Fields The HIDReportField types in the report.
+template<uint8_t ReportId, std::size_t Size, typename... Fields>
+struct HIDReportLayout
+{
+    static_assert(Size > 0, "The report size must be greater than zero.");
+    static_assert(HIDReportLayoutDetail::fieldsFit<Fields...>(Size * 8), "A field extends past the end of the report.");
+    static_assert(HIDReportLayoutDetail::fieldsDisjoint<Fields...>(), "Report fields must not overlap.");
+
+    /// \brief The report id.
+    static constexpr uint8_t REPORT_ID = ReportId;
+
+    /// \brief The size of the report data in bytes, not including the report id.
+    static constexpr std::size_t SIZE = Size;
+
+    /// \brief The number of fields.
+    static constexpr std::size_t FIELD_COUNT = sizeof...(Fields);
+
+    /// \brief The field type at the given index.
+    template<std::size_t I>
+    using Field = typename std::tuple_element<I, std::tuple<Fields...>>::type;
+
+    /// \brief A tuple holding one value per field.
+    typedef std::tuple<typename Fields::Type...> Values;
+
+    /// \brief Pack all values into report data.
+    ///
+    /// Bits not covered by a field are not modified.
+    ///
+    /// \param values The field values.
+    /// \param data The report data, not including the report id.
+    static void pack(const Values& values, uint8_t* data)
+    {
+        _pack(values, data, std::index_sequence_for<Fields...>());
+    }
+
+    /// \brief Unpack all values from report data.
+    /// \param data The report data, not including the report id.
+    /// \param values The field values to fill.
+    static void unpack(const uint8_t* data, Values& values)
+    {
+        _unpack(data, values, std::index_sequence_for<Fields...>());
+    }
+
+private:
+    template<std::size_t... I>
+    static void _pack(const Values& values, uint8_t* data, std::index_sequence<I...>)
+    {
+        const int expand[] = { 0, (Field<I>::pack(data, std::get<I>(values)), 0)... };
+        (void)expand;
+    }
+
+    template<std::size_t... I>
+    static void _unpack(const uint8_t* data, Values& values, std::index_sequence<I...>)
+    {
+        const int expand[] = { 0, (std::get<I>(values) = Field<I>::unpack(data), 0)... };
+        (void)expand;
+    }
+
+};
+
+
+/// \brief A report whose values are described by a HIDReportLayout.
+///
+/// Any type with a nested Layout typedef and matching pack() and unpack()
+/// members can be used with the typed HIDDevice::read() and HIDDevice::write()
+/// overloads.
+///
+/// \tparam LayoutType The report layout.
+template<typename LayoutType>
+class HIDTypedReport
+{
+public:
+    /// \brief The report layout.
+    typedef LayoutType Layout;
+
+    /// \returns the value of the field at the given index.
+    template<std::size_t I>
+    typename Layout::template Field<I>::Type& get()
+    {
+        return std::get<I>(values);
+    }
+
+    /// \returns the value of the field at the given index.
+    template<std::size_t I>
+    const typename Layout::template Field<I>::Type& get() const
+    {
+        return std::get<I>(values);
+    }
+
+    /// \brief Pack the report values into report data.
+    /// \param data The report data, not including the report id.
+    void pack(uint8_t* data) const
+    {
+        Layout::pack(values, data);
+    }
+
+    /// \brief Unpack the report values from report data.
+    /// \param data The report data, not including the report id.
+    void unpack(const uint8_t* data)
+    {
+        Layout::unpack(data, values);
+    }
+
+    /// \brief The field values.
+    typename Layout::Values values;
+
+};
+
+
+} } // namespace ofx::IO
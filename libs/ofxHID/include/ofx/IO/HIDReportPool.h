@@ -0,0 +1,103 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <mutex>
+#include "ofx/IO/HIDDevice.h"
+#include "ofx/IO/HIDPooledReport.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A per-device arena of fixed-capacity report slabs.
+///
+/// All slab storage is allocated once, up front. Each slab starts on its own
+/// 64-byte cache line. Acquiring and releasing a slab does not allocate. The pool must outlive every report acquired from
+/// it.
+class HIDReportPool
+{
+public:
+    /// \brief Create a HIDReportPool.
+    /// \param slabCount The number of slabs.
+    /// \param slabCapacity The capacity of each slab in bytes.
+    HIDReportPool(std::size_t slabCount = DEFAULT_SLAB_COUNT,
+                  std::size_t slabCapacity = HIDDevice::DEFAULT_READ_BUFFER_SIZE);
+
+    /// \brief Create a HIDReportPool sized for a device's input reports.
+    /// \param device The open device whose read packet size is used.
+    /// \param slabCount The number of slabs.
+    HIDReportPool(const HIDDevice& device,
+                  std::size_t slabCount = DEFAULT_SLAB_COUNT);
+
+    /// \brief Destroy the HIDReportPool.
+    ~HIDReportPool();
+
+    /// \brief Acquire an empty slab.
+    /// \returns a handle to the slab, or an empty handle if the pool is exhausted.
+    HIDReportHandle acquire();
+
+    /// \brief Read the next input report from a device into a new slab.
+    ///
+    /// The slab holds the same bytes as HIDDevice::read(). The report id is
+    /// set from the first byte if numberedReports is true.
+    ///
+    /// \param device The device to read.
+    /// \param numberedReports True if the device uses numbered reports.
+    /// \returns a handle to the report, or an empty handle if no report was
+    ///          read or the pool is exhausted.
+    HIDReportHandle read(HIDDevice& device, bool numberedReports = false);
+
+    /// \returns the number of slabs.
+    std::size_t slabCount() const;
+
+    /// \returns the capacity of each slab in bytes.
+    std::size_t slabCapacity() const;
+
+    /// \returns the number of slabs available.
+    std::size_t available() const;
+
+    /// \returns the number of times acquire() failed because the pool was exhausted.
+    uint64_t exhaustedCount() const;
+
+    /// \brief The default number of slabs.
+    static const std::size_t DEFAULT_SLAB_COUNT;
+
+private:
+    friend class HIDPooledReport;
+
+    HIDReportPool(const HIDReportPool&) = delete;
+    HIDReportPool& operator = (const HIDReportPool&) = delete;
+
+    /// \brief Return a slab whose last reference was released.
+    void _release(HIDPooledReport* report);
+
+    /// \brief The storage for all slabs.
+    std::vector<uint8_t> _storage;
+
+    /// \brief The slab headers.
+    std::vector<std::unique_ptr<HIDPooledReport>> _slabs;
+
+    /// \brief The slabs available for acquisition.
+    std::vector<HIDPooledReport*> _free;
+
+    /// \brief The capacity of each slab in bytes.
+    std::size_t _slabCapacity = 0;
+
+    /// \brief The number of times the pool was exhausted.
+    uint64_t _exhaustedCount = 0;
+
+    /// \brief The mutex protecting the free list.
+    mutable std::mutex _mutex;
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,94 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include "ofConstants.h"
+#include "ofx/IO/HIDReport.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A single-producer, multi-consumer broadcast ring of reports.
+///
+/// Each published report is stored once and shared by all consumers. The
+/// producer never waits for consumers. Consumers that fall more than
+/// capacity() reports behind lose the oldest reports.
+///
+/// Consumers do not register with the ring. Each keeps its own cursor, which
+/// is a sequence number, and reads with read().
+class HIDReportRing
+{
+public:
+    /// \brief A shared, immutable report.
+    typedef std::shared_ptr<const HIDReport> SharedReport;
+
+    /// \brief Create a HIDReportRing with the given capacity.
+    /// \param capacity The number of reports retained for slow consumers.
+    HIDReportRing(std::size_t capacity = DEFAULT_CAPACITY);
+
+    /// \brief Destroy the HIDReportRing.
+    ~HIDReportRing();
+
+    /// \brief Publish a report to all consumers.
+    ///
+    /// The report's sequence number will be assigned by the ring.
+    ///
+    /// \param report The report to publish.
+    void publish(std::shared_ptr<HIDReport> report);
+
+    /// \brief Read the report at the given cursor.
+    ///
+    /// If the report at the cursor has already been overwritten, the cursor
+    /// will be advanced to the oldest retained report and the number of
+    /// skipped reports will be added to dropped.
+    ///
+    /// \param cursor The consumer cursor, advanced on success.
+    /// \param report The report to fill.
+    /// \param dropped The consumer's dropped report counter.
+    /// \param timeoutMillis The time to wait for a report, or 0 to not wait.
+    /// \returns true if a report was read.
+    bool read(uint64_t& cursor,
+              SharedReport& report,
+              uint64_t& dropped,
+              uint64_t timeoutMillis);
+
+    /// \brief Wake any consumers waiting in read().
+    void interrupt();
+
+    /// \returns the sequence number of the next published report.
+    uint64_t head() const;
+
+    /// \returns the number of reports retained for slow consumers.
+    std::size_t capacity() const;
+
+    /// \brief The default ring capacity.
+    static const std::size_t DEFAULT_CAPACITY;
+
+private:
+    /// \brief The retained reports, indexed by sequence % capacity.
+    std::vector<SharedReport> _slots;
+
+    /// \brief The sequence number of the next published report.
+    std::atomic<uint64_t> _head;
+
+    /// \brief The mutex protecting the slots.
+    mutable std::mutex _mutex;
+
+    /// \brief Signaled when a report is published.
+    std::condition_variable _condition;
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,72 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofx/IO/HIDReportRing.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A consumer of reports published to a HIDReportRing.
+///
+/// Each subscriber keeps its own cursor and counters, so subscribers can
+/// consume at different rates without affecting each other. A subscriber is
+/// not thread-safe and should be used by a single consumer thread.
+class HIDReportSubscriber
+{
+public:
+    /// \brief Create a HIDReportSubscriber for the given ring.
+    ///
+    /// The subscriber will receive reports published after it is created.
+    ///
+    /// \param ring The ring to consume.
+    HIDReportSubscriber(std::shared_ptr<HIDReportRing> ring);
+
+    /// \brief Destroy the HIDReportSubscriber.
+    ~HIDReportSubscriber();
+
+    /// \brief Read the next report without waiting.
+    /// \param report The report to fill.
+    /// \returns true if a report was read.
+    bool tryRead(HIDReportRing::SharedReport& report);
+
+    /// \brief Read the next report, waiting up to the given timeout.
+    /// \param report The report to fill.
+    /// \param timeoutMillis The maximum time to wait in milliseconds.
+    /// \returns true if a report was read.
+    bool read(HIDReportRing::SharedReport& report, uint64_t timeoutMillis);
+
+    /// \returns the number of published reports not yet read.
+    uint64_t lag() const;
+
+    /// \returns the number of reports lost because this subscriber fell behind.
+    uint64_t dropped() const;
+
+    /// \returns the number of reports read by this subscriber.
+    uint64_t received() const;
+
+private:
+    /// \brief The ring being consumed.
+    std::shared_ptr<HIDReportRing> _ring;
+
+    /// \brief The sequence number of the next report to read.
+    uint64_t _cursor = 0;
+
+    /// \brief The number of reports lost.
+    uint64_t _dropped = 0;
+
+    /// \brief The number of reports read.
+    uint64_t _received = 0;
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,95 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include "ofConstants.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief The layout of a shared-memory report ring.
+///
+/// A ring consists of a Header followed by slotCount slots. Each slot is a
+/// Slot header followed by slotSize bytes of report data. Slots are protected
+/// by a per-slot seqlock, so a single writer never waits for readers and
+/// readers detect torn or overwritten slots.
+///
+/// Report n is stored in slot n % slotCount. While it is being written the
+/// slot lock is 2n + 1. When it is complete the slot lock is 2n + 2.
+namespace HIDSharedMemory {
+
+
+/// \brief The ring header.
+struct Header
+{
+    /// \brief The layout identifier, equal to MAGIC.
+    uint32_t magic;
+
+    /// \brief The layout version, equal to VERSION.
+    uint32_t version;
+
+    /// \brief The number of slots.
+    uint32_t slotCount;
+
+    /// \brief The maximum number of report bytes per slot.
+    uint32_t slotSize;
+
+    /// \brief The sequence number of the next report to be written.
+    std::atomic<uint64_t> head;
+
+};
+
+
+/// \brief The header of each slot.
+struct Slot
+{
+    /// \brief The slot seqlock.
+    std::atomic<uint64_t> lock;
+
+    /// \brief The host monotonic time the report was received in microseconds.
+    uint64_t timestampMicros;
+
+    /// \brief The number of valid report bytes following this header.
+    uint32_t size;
+
+    /// \brief Padding to keep the report data 8-byte aligned.
+    uint32_t reserved;
+
+};
+
+
+/// \brief The layout identifier.
+const uint32_t MAGIC = 0x44494846; // "FHID"
+
+/// \brief The layout version.
+const uint32_t VERSION = 1;
+
+/// \returns the size in bytes of one slot, including its header.
+inline std::size_t slotStride(std::size_t slotSize)
+{
+    return sizeof(Slot) + ((slotSize + 7) & ~std::size_t(7));
+}
+
+/// \returns the size in bytes of a ring with the given dimensions.
+inline std::size_t mappedSize(std::size_t slotCount, std::size_t slotSize)
+{
+    return sizeof(Header) + slotCount * slotStride(slotSize);
+}
+
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Shared-memory rings require lock-free 64-bit atomics.");
+
+
+} // namespace HIDSharedMemory
+
+
+} } // namespace ofx::IO
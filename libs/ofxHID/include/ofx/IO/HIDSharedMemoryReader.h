@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofx/IO/HIDReport.h"
+#include "ofx/IO/HIDSharedMemory.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Consumes reports published by a HIDSharedMemoryWriter.
+///
+/// The reader maps the ring read-only. read() copies each report directly
+/// from shared memory into the caller's report, reusing its storage. For
+/// zero-copy access, peek() returns a view into the ring and release()
+/// reports whether the view stayed intact while it was used. Readers never
+/// block the writer. A reader that falls more than a ring's worth of reports
+/// behind skips the lost reports and counts them as dropped.
+class HIDSharedMemoryReader
+{
+public:
+    /// \brief A report viewed in place in shared memory.
+    struct View
+    {
+        /// \brief The report data, with the same layout as HIDDevice::read().
+        const uint8_t* data = nullptr;
+
+        /// \brief The report size in bytes.
+        std::size_t size = 0;
+
+        /// \brief The host monotonic time the report was received.
+        uint64_t timestampMicros = 0;
+
+        /// \brief The ring sequence number of the report.
+        uint64_t sequence = 0;
+
+    };
+
+    /// \brief Create an unopened HIDSharedMemoryReader.
+    HIDSharedMemoryReader();
+
+    /// \brief Destroy the HIDSharedMemoryReader, closing the ring.
+    ~HIDSharedMemoryReader();
+
+    /// \brief Map an existing shared-memory ring.
+    ///
+    /// The reader will receive reports published after this call.
+    ///
+    /// \param name The shared-memory object name.
+    /// \returns true if the ring was mapped.
+    bool open(const std::string& name);
+
+    /// \brief Unmap the ring.
+    void close();
+
+    /// \returns true if the ring is open.
+    bool isOpen() const;
+
+    /// \brief Read the next report without waiting.
+    ///
+    /// The report data has the same layout as HIDDevice::read().
+    ///
+    /// \param report The report to fill.
+    /// \returns true if a report was read.
+    bool read(HIDReport& report);
+
+    /// \brief View the next report in place without waiting or copying.
+    ///
+    /// The writer may overwrite the slot at any time, so the view data must be
+    /// treated as tentative until release() confirms it. Each successful
+    /// peek() must be followed by release() before the next peek() or read().
+    ///
+    /// \param view The view to fill.
+    /// \returns true if a report is available.
+    bool peek(View& view);
+
+    /// \brief Finish with a view returned by peek().
+    ///
+    /// If the writer overwrote the slot while the view was in use, the report
+    /// is counted as dropped and any results derived from it must be
+    /// discarded.
+    ///
+    /// \param view The view returned by peek().
+    /// \returns true if the view data was intact.
+    bool release(const View& view);
+
+    /// \returns the number of published reports not yet read.
+    uint64_t lag() const;
+
+    /// \returns the number of reports lost because this reader fell behind.
+    uint64_t dropped() const;
+
+private:
+    /// \returns the ring header.
+    const HIDSharedMemory::Header* _header() const;
+
+    /// \brief The mapped ring, or nullptr if not open.
+    uint8_t* _memory = nullptr;
+
+    /// \brief The mapped size in bytes.
+    std::size_t _size = 0;
+
+    /// \brief The size of each slot including its header.
+    std::size_t _slotStride = 0;
+
+    /// \brief The sequence number of the next report to read.
+    uint64_t _cursor = 0;
+
+    /// \brief The number of reports lost.
+    uint64_t _dropped = 0;
+
+};
+
+
+} } // namespace ofx::IO
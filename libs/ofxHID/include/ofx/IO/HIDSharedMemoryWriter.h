@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofx/IO/HIDSharedMemory.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Publishes reports into a named POSIX shared-memory ring.
+///
+/// Other processes can consume the reports with HIDSharedMemoryReader. There
+/// must be only one writer per ring. The shared-memory object is unlinked
+/// when the writer is closed.
+///
+/// Shared-memory export is not available on Windows.
+class HIDSharedMemoryWriter
+{
+public:
+    /// \brief Create an unopened HIDSharedMemoryWriter.
+    HIDSharedMemoryWriter();
+
+    /// \brief Destroy the HIDSharedMemoryWriter, closing the ring.
+    ~HIDSharedMemoryWriter();
+
+    /// \brief Create and map a shared-memory ring.
+    ///
+    /// Opening fails if a ring with the same name already exists, because it
+    /// may belong to a running writer. A ring left behind by a crashed process
+    /// can be removed with unlink().
+    ///
+    /// \param name The shared-memory object name, e.g. "/ofxHID-teensy".
+    /// \param slotCount The number of reports retained in the ring.
+    /// \param slotSize The maximum report size in bytes.
+    /// \returns true if the ring was created.
+    bool open(const std::string& name,
+              std::size_t slotCount = DEFAULT_SLOT_COUNT,
+              std::size_t slotSize = DEFAULT_SLOT_SIZE);
+
+    /// \brief Unmap and unlink the ring.
+    void close();
+
+    /// \returns true if the ring is open.
+    bool isOpen() const;
+
+    /// \brief Publish a report.
+    ///
+    /// Reports larger than the slot size are rejected and counted by
+    /// oversized(), rather than published truncated.
+    ///
+    /// \param data The report data.
+    /// \param size The report size in bytes.
+    /// \param timestampMicros The host monotonic receive time.
+    /// \returns true if the report was published.
+    bool write(const uint8_t* data, std::size_t size, uint64_t timestampMicros);
+
+    /// \returns the shared-memory object name.
+    std::string name() const;
+
+    /// \returns the maximum report size in bytes, or 0 if not open.
+    std::size_t slotSize() const;
+
+    /// \returns the number of reports rejected because they did not fit a slot.
+    uint64_t oversized() const;
+
+    /// \brief Remove a named ring left behind by a crashed writer.
+    ///
+    /// Readers that already mapped the ring keep their mapping.
+    ///
+    /// \param name The shared-memory object name.
+    /// \returns true if the ring was removed.
+    static bool unlink(const std::string& name);
+
+    /// \brief The default number of slots.
+    static const std::size_t DEFAULT_SLOT_COUNT;
+
+    /// \brief The default maximum report size in bytes.
+    static const std::size_t DEFAULT_SLOT_SIZE;
+
+private:
+    /// \brief The shared-memory object name.
+    std::string _name;
+
+    /// \brief The mapped ring, or nullptr if not open.
+    uint8_t* _memory = nullptr;
+
+    /// \brief The mapped size in bytes.
+    std::size_t _size = 0;
+
+    /// \brief The number of reports rejected because they did not fit a slot.
+    uint64_t _oversized = 0;
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,56 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <iostream>
+#include "ofx/IO/HIDStreamBuffer.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A std::iostream over a HIDStreamBuffer.
+///
+/// For example:
+///
+///     ofxIO::HIDStream stream(device);
+///     stream << "led " << 3 << " on" << std::endl;
+///
+///     int value;
+///     stream >> value;
+///
+/// std::endl and std::flush send a partially filled report immediately.
+class HIDStream: public std::iostream
+{
+public:
+    /// \brief Create a HIDStream.
+    /// \param device The device to read and write. Must outlive the stream.
+    /// \param reportSize The report size in bytes, not including the report id.
+    /// \param framing How stream bytes are placed in reports.
+    /// \param reportId The report id to write.
+    HIDStream(HIDDevice& device,
+              std::size_t reportSize = HIDStreamBuffer::DEFAULT_REPORT_SIZE,
+              HIDStreamBuffer::Framing framing = HIDStreamBuffer::Framing::LENGTH_PREFIXED,
+              uint8_t reportId = 0x00);
+
+    /// \brief Destroy the HIDStream, flushing pending output.
+    virtual ~HIDStream();
+
+    /// \returns the stream buffer.
+    HIDStreamBuffer& buffer();
+
+private:
+    /// \brief The stream buffer.
+    HIDStreamBuffer _buffer;
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,178 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <condition_variable>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#include "ofx/IO/HIDDevice.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A std::streambuf that carries a byte stream over fixed-size reports.
+///
+/// Output is packed into full reports. A partially filled report is sent
+/// when it fills, on an explicit flush, or when its first byte has waited
+/// longer than the flush latency. Input reports are unpacked into a
+/// contiguous get area for std::istream parsing.
+///
+/// With Framing::LENGTH_PREFIXED, the first byte of each report holds the
+/// number of payload bytes that follow, so binary data survives padding.
+/// With Framing::RAW, every report byte is payload and partial reports are
+/// padded with zeros, which the peer receives as data.
+///
+/// If the flusher thread fails to send a report, it keeps the report and
+/// retries with an exponential backoff of up to MAX_RETRY_MICROS, logging
+/// only the first failure of each run.
+///
+/// Writes may come from any thread. Reads must come from a single thread.
+/// Input blocks for up to the device read timeout and then returns end of
+/// file, so an std::istream needs clear() after a timeout.
+class HIDStreamBuffer: public std::streambuf
+{
+public:
+    /// \brief How stream bytes are placed in reports.
+    enum class Framing
+    {
+        /// \brief The first byte of each report is the payload length.
+        LENGTH_PREFIXED,
+        /// \brief Every report byte is payload.
+        RAW
+    };
+
+    /// \brief Create a HIDStreamBuffer.
+    /// \param device The device to read and write. Must outlive the buffer.
+    /// \param reportSize The report size in bytes, not including the report id.
+    /// \param framing How stream bytes are placed in reports.
+    /// \param reportId The report id to write, and to strip from input
+    ///        reports if not 0x00.
+    HIDStreamBuffer(HIDDevice& device,
+                    std::size_t reportSize = DEFAULT_REPORT_SIZE,
+                    Framing framing = Framing::LENGTH_PREFIXED,
+                    uint8_t reportId = 0x00);
+
+    /// \brief Destroy the HIDStreamBuffer, flushing pending output.
+    virtual ~HIDStreamBuffer();
+
+    /// \brief Set the maximum time output may wait for a report to fill.
+    ///
+    /// A background thread enforces the deadline. 0 disables it, so partial
+    /// reports are only sent on flush.
+    ///
+    /// \param latencyMicros The flush latency in microseconds.
+    void setFlushLatencyMicros(uint64_t latencyMicros);
+
+    /// \returns the flush latency in microseconds.
+    uint64_t getFlushLatencyMicros() const;
+
+    /// \returns the number of reports written.
+    uint64_t reportsWritten() const;
+
+    /// \returns the number of payload bytes written.
+    uint64_t bytesWritten() const;
+
+    /// \returns the number of reports read.
+    uint64_t reportsRead() const;
+
+    /// \returns the number of failed report writes.
+    uint64_t writeErrors() const;
+
+    /// \brief The default report size in bytes, as used by Teensy RawHID.
+    static const std::size_t DEFAULT_REPORT_SIZE;
+
+    /// \brief The default flush latency in microseconds.
+    static const uint64_t DEFAULT_FLUSH_LATENCY_MICROS;
+
+    /// \brief The longest time the flusher waits before retrying a failed write.
+    static const uint64_t MAX_RETRY_MICROS;
+
+protected:
+    std::streamsize xsputn(const char_type* s, std::streamsize count) override;
+    int_type overflow(int_type ch) override;
+    int sync() override;
+    int_type underflow() override;
+
+private:
+    /// \brief Send the pending output. The mutex must be held.
+    bool _send();
+
+    /// \brief The deadline flusher loop.
+    void _run();
+
+    /// \brief The device.
+    HIDDevice& _device;
+
+    /// \brief The report size in bytes.
+    std::size_t _reportSize = DEFAULT_REPORT_SIZE;
+
+    /// \brief The framing.
+    Framing _framing = Framing::LENGTH_PREFIXED;
+
+    /// \brief The report id.
+    uint8_t _reportId = 0x00;
+
+    /// \brief The payload capacity of one report.
+    std::size_t _payloadSize = 0;
+
+    /// \brief The report being assembled, starting at the payload.
+    std::vector<uint8_t> _output;
+
+    /// \brief The number of pending output bytes.
+    std::size_t _outputSize = 0;
+
+    /// \brief The time the first pending byte was written.
+    uint64_t _outputMicros = 0;
+
+    /// \brief The last input report.
+    std::vector<uint8_t> _input;
+
+    /// \brief The flush latency in microseconds.
+    uint64_t _flushLatencyMicros = DEFAULT_FLUSH_LATENCY_MICROS;
+
+    /// \brief The number of reports written.
+    uint64_t _reportsWritten = 0;
+
+    /// \brief The number of payload bytes written.
+    uint64_t _bytesWritten = 0;
+
+    /// \brief The number of reports read.
+    uint64_t _reportsRead = 0;
+
+    /// \brief The number of failed report writes.
+    uint64_t _writeErrors = 0;
+
+    /// \brief The number of failed report writes since the last success.
+    uint64_t _consecutiveErrors = 0;
+
+    /// \brief The flusher's current retry delay, or 0 after a success.
+    uint64_t _retryMicros = 0;
+
+    /// \brief The earliest time the flusher may retry a failed write.
+    uint64_t _retryAtMicros = 0;
+
+    /// \brief True while the flusher thread should keep running.
+    bool _running = false;
+
+    /// \brief The deadline flusher thread.
+    std::thread _thread;
+
+    /// \brief The mutex protecting the output.
+    mutable std::mutex _mutex;
+
+    /// \brief Wakes the flusher thread.
+    std::condition_variable _condition;
+
+};
+
+
+} } // namespace ofx::IO
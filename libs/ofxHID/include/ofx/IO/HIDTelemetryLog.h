@@ -0,0 +1,203 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <array>
+#include <istream>
+#include <vector>
+#include "ofConstants.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief The layout of a compressed telemetry log and its index.
+///
+/// A log starts with a file header (MAGIC, VERSION) followed by blocks. Each
+/// block starts with a keyframe and holds a run of records:
+///
+///     [flags][report id][varint timestamp][varint size][payload]
+///
+/// Keyframe records store an absolute timestamp, other records store the
+/// delta from the previous record. A RAW payload is the report bytes. Other
+/// payloads are the report XORed with the previous report with the same id,
+/// coded as repeated [varint zero run][varint literal count][literal bytes]
+/// until the report size is reached.
+///
+/// The records of a block are entropy coded together with a static Huffman
+/// code built from the block's byte frequencies:
+///
+///     [coding][varint record count][varint record bytes]
+///     [128 bytes of 4-bit code lengths, HUFFMAN only]
+///     [varint payload size][payload]
+///
+/// A STORED payload is the record bytes. A HUFFMAN payload is the canonical
+/// Huffman code of each record byte, packed most significant bit first.
+///
+/// A keyframe resets all previous reports, so decoding can start at any
+/// block. The index file starts with (INDEX_MAGIC, VERSION) followed by one
+/// IndexEntry per block. All fixed-width integers are little-endian.
+namespace HIDTelemetryLog {
+
+
+/// \brief Record flags.
+enum Flags: uint8_t
+{
+    /// \brief The record starts a keyframe and has an absolute timestamp.
+    KEYFRAME = 0x01,
+    /// \brief The payload is the raw report.
+    RAW = 0x02
+};
+
+
+/// \brief An index entry locating a keyframe.
+struct IndexEntry
+{
+    /// \brief The host monotonic timestamp of the keyframe record.
+    uint64_t timestampMicros = 0;
+
+    /// \brief The byte offset of the block in the log.
+    uint64_t offset = 0;
+
+    /// \brief The number of records before the keyframe in the log.
+    uint64_t sequence = 0;
+};
+
+
+/// \brief The coding of a block payload.
+enum class Coding: uint8_t
+{
+    /// \brief The payload is the record bytes.
+    STORED = 0,
+    /// \brief The payload is Huffman coded.
+    HUFFMAN = 1
+};
+
+
+/// \brief The log identifier.
+const uint32_t MAGIC = 0x4C544846; // "FHTL"
+
+/// \brief The index identifier.
+const uint32_t INDEX_MAGIC = 0x49544846; // "FHTI"
+
+/// \brief The format version.
+const uint32_t VERSION = 2;
+
+/// \brief The size of a file header in bytes.
+const std::size_t HEADER_SIZE = 8;
+
+/// \brief The size of an index entry in bytes.
+const std::size_t INDEX_ENTRY_SIZE = 24;
+
+/// \brief The longest Huffman code in bits.
+const std::size_t MAX_CODE_LENGTH = 15;
+
+/// \brief The Huffman code length of each byte value, 0 if unused.
+typedef std::array<uint8_t, 256> CodeLengths;
+
+
+/// \brief Build length-limited Huffman code lengths for byte frequencies.
+/// \param counts The number of times each byte value occurs.
+/// \param lengths The code lengths to fill.
+void buildCodeLengths(const std::array<uint64_t, 256>& counts,
+                      CodeLengths& lengths);
+
+
+/// \brief Huffman code bytes with a canonical code.
+/// \param data The bytes to code.
+/// \param size The number of bytes.
+/// \param lengths The code lengths, non-zero for every byte in data.
+/// \param output The buffer the coded bits are appended to.
+void huffmanEncode(const uint8_t* data,
+                   std::size_t size,
+                   const CodeLengths& lengths,
+                   std::vector<uint8_t>& output);
+
+
+/// \brief Decode bytes coded by huffmanEncode().
+/// \param data The coded bits.
+/// \param size The number of coded bytes.
+/// \param lengths The code lengths used to code the bytes.
+/// \param count The number of bytes to decode.
+/// \param output The buffer to fill with count bytes.
+/// \returns false if the code lengths or the data are invalid.
+bool huffmanDecode(const uint8_t* data,
+                   std::size_t size,
+                   const CodeLengths& lengths,
+                   std::size_t count,
+                   std::vector<uint8_t>& output);
+
+
+/// \brief Append an unsigned LEB128 varint.
+inline void putVarint(std::vector<uint8_t>& buffer, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        buffer.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+
+    buffer.push_back(uint8_t(value));
+}
+
+
+/// \brief Append a little-endian fixed-width integer.
+inline void putFixed(std::vector<uint8_t>& buffer, uint64_t value, std::size_t size)
+{
+    for (std::size_t i = 0; i < size; ++i)
+        buffer.push_back(uint8_t(value >> (8 * i)));
+}
+
+
+/// \brief Read an unsigned LEB128 varint.
+/// \returns true if a complete varint was read.
+inline bool getVarint(std::istream& stream, uint64_t& value)
+{
+    value = 0;
+
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        int byte = stream.get();
+
+        if (byte == std::char_traits<char>::eof())
+            return false;
+
+        value |= uint64_t(byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+
+/// \brief Read a little-endian fixed-width integer.
+/// \returns true if all bytes were read.
+inline bool getFixed(std::istream& stream, uint64_t& value, std::size_t size)
+{
+    uint8_t bytes[8];
+
+    if (size > sizeof(bytes) || !stream.read(reinterpret_cast<char*>(bytes), size))
+        return false;
+
+    value = 0;
+
+    for (std::size_t i = 0; i < size; ++i)
+        value |= uint64_t(bytes[i]) << (8 * i);
+
+    return true;
+}
+
+
+} // namespace HIDTelemetryLog
+
+
+} } // namespace ofx::IO
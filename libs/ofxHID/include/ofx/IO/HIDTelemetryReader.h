@@ -0,0 +1,106 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <array>
+#include <fstream>
+#include <sstream>
+#include "ofx/IO/HIDReport.h"
+#include "ofx/IO/HIDTelemetryLog.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Reads reports from a telemetry log written by HIDTelemetryWriter.
+///
+/// The reader is not thread-safe.
+class HIDTelemetryReader
+{
+public:
+    /// \brief Create an unopened HIDTelemetryReader.
+    HIDTelemetryReader();
+
+    /// \brief Destroy the HIDTelemetryReader.
+    ~HIDTelemetryReader();
+
+    /// \brief Open a log and, optionally, its index.
+    ///
+    /// Without an index, seek() scans from the start of the log.
+    ///
+    /// \param path The log file path.
+    /// \param indexPath The index file path, or an empty string.
+    /// \returns true if the log was opened.
+    bool open(const std::string& path, const std::string& indexPath = "");
+
+    /// \brief Close the log.
+    void close();
+
+    /// \returns true if the log is open.
+    bool isOpen() const;
+
+    /// \brief Read the next report.
+    /// \param report The report to fill. Its sequence is the record number
+    ///        from the start of the log, also after seek().
+    /// \returns true if a report was read, or false at the end of the log.
+    bool read(HIDReport& report);
+
+    /// \brief Position the reader at the first report at or after a time.
+    /// \param timestampMicros The host monotonic time to seek to.
+    /// \returns true if such a report exists.
+    bool seek(uint64_t timestampMicros);
+
+    /// \returns the index entries.
+    const std::vector<HIDTelemetryLog::IndexEntry>& index() const;
+
+private:
+    /// \brief Decode the next record.
+    bool _readRecord(HIDReport& report);
+
+    /// \brief Read and decode the next block.
+    bool _readBlock();
+
+    /// \brief Reset the decoder to a block.
+    void _reset(uint64_t offset, uint64_t sequence);
+
+    /// \brief The log file.
+    std::ifstream _log;
+
+    /// \brief The keyframe index.
+    std::vector<HIDTelemetryLog::IndexEntry> _index;
+
+    /// \brief The coded payload of the current block.
+    std::vector<uint8_t> _coded;
+
+    /// \brief The decoded records of the current block.
+    std::vector<uint8_t> _records;
+
+    /// \brief The records of the current block as a stream.
+    std::istringstream _block;
+
+    /// \brief The previous report for each report id.
+    std::array<std::vector<uint8_t>, 256> _previous;
+
+    /// \brief The timestamp of the previous record.
+    uint64_t _lastTimestampMicros = 0;
+
+    /// \brief The sequence number of the next record.
+    uint64_t _sequence = 0;
+
+    /// \brief A report read ahead by seek().
+    HIDReport _pending;
+
+    /// \brief True if _pending holds a report.
+    bool _hasPending = false;
+
+};
+
+
+} } // namespace ofx::IO
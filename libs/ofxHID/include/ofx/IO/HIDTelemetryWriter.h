@@ -0,0 +1,163 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <array>
+#include <fstream>
+#include "ofx/IO/HIDReportSubscriber.h"
+#include "ofx/IO/HIDTelemetryLog.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Writes input reports to a delta-compressed telemetry log.
+///
+/// Each report is XORed against the previous report with the same report id
+/// and the runs of unchanged bytes are coded compactly. Records are collected
+/// into blocks that start with a keyframe, and each block is Huffman coded
+/// when written. Blocks are recorded in an index file so that
+/// HIDTelemetryReader can seek by timestamp.
+///
+/// Timestamps must not decrease. A timestamp earlier than the previous one is
+/// clamped to it and counted by clampedTimestamps().
+///
+/// Reports are typically taken from a HIDReportBroadcaster subscriber:
+///
+///     auto subscriber = broadcaster.subscribe();
+///     writer.open("sensors.hidlog", "sensors.hidindex");
+///     ...
+///     writer.write(*subscriber);
+///
+/// The writer is not thread-safe.
+class HIDTelemetryWriter
+{
+public:
+    /// \brief Create an unopened HIDTelemetryWriter.
+    HIDTelemetryWriter();
+
+    /// \brief Destroy the HIDTelemetryWriter, closing the log.
+    ~HIDTelemetryWriter();
+
+    /// \brief Create a log and its index, replacing existing files.
+    /// \param path The log file path.
+    /// \param indexPath The index file path.
+    /// \param keyframeInterval The number of reports in each block.
+    /// \param numberedReports True if the first byte of each report is its
+    ///        report id.
+    /// \returns true if both files were created.
+    bool open(const std::string& path,
+              const std::string& indexPath,
+              std::size_t keyframeInterval = DEFAULT_KEYFRAME_INTERVAL,
+              bool numberedReports = false);
+
+    /// \brief Flush and close the log and index.
+    void close();
+
+    /// \returns true if the log is open.
+    bool isOpen() const;
+
+    /// \brief Append a report.
+    /// \param data The report data, as returned by HIDDevice::read().
+    /// \param size The report size in bytes.
+    /// \param timestampMicros The host monotonic receive time.
+    /// \returns true if the report was written.
+    bool write(const uint8_t* data, std::size_t size, uint64_t timestampMicros);
+
+    /// \brief Append a report.
+    /// \param report The report to write.
+    /// \returns true if the report was written.
+    bool write(const HIDReport& report);
+
+    /// \brief Append all reports available from a subscriber without blocking.
+    /// \param subscriber The subscriber to drain.
+    /// \returns the number of reports written.
+    std::size_t write(HIDReportSubscriber& subscriber);
+
+    /// \brief Write the current block and flush both files.
+    ///
+    /// The next report starts a new block, so frequent flushes reduce
+    /// compression.
+    void flush();
+
+    /// \returns the number of reports written.
+    uint64_t reportsWritten() const;
+
+    /// \returns the number of raw report bytes written.
+    uint64_t rawBytes() const;
+
+    /// \returns the number of log bytes written, including headers. Reports
+    ///          in the current block are counted when the block is written.
+    uint64_t encodedBytes() const;
+
+    /// \returns the number of reports whose timestamp was clamped because it
+    ///          was earlier than the previous report.
+    uint64_t clampedTimestamps() const;
+
+    /// \returns rawBytes() / encodedBytes(), or 0 if nothing was written.
+    double compressionRatio() const;
+
+    /// \brief The default number of reports between keyframes.
+    static const std::size_t DEFAULT_KEYFRAME_INTERVAL;
+
+private:
+    /// \brief Start a new block at the current offset.
+    void _startKeyframe(uint64_t timestampMicros);
+
+    /// \brief Code and write the current block.
+    /// \returns false if the write failed.
+    bool _writeBlock();
+
+    /// \brief The log file.
+    std::ofstream _log;
+
+    /// \brief The index file.
+    std::ofstream _index;
+
+    /// \brief The records of the current block.
+    std::vector<uint8_t> _block;
+
+    /// \brief The coded block being written.
+    std::vector<uint8_t> _coded;
+
+    /// \brief The previous report for each report id.
+    std::array<std::vector<uint8_t>, 256> _previous;
+
+    /// \brief True for report ids with a previous report since the last keyframe.
+    std::array<bool, 256> _hasPrevious;
+
+    /// \brief The number of reports between keyframes.
+    std::size_t _keyframeInterval = DEFAULT_KEYFRAME_INTERVAL;
+
+    /// \brief The number of reports in the current block.
+    std::size_t _sinceKeyframe = 0;
+
+    /// \brief True if the first byte of each report is its report id.
+    bool _numberedReports = false;
+
+    /// \brief The timestamp of the previous record.
+    uint64_t _lastTimestampMicros = 0;
+
+    /// \brief The number of reports written.
+    uint64_t _reportsWritten = 0;
+
+    /// \brief The number of raw report bytes written.
+    uint64_t _rawBytes = 0;
+
+    /// \brief The number of log bytes written.
+    uint64_t _encodedBytes = 0;
+
+    /// \brief The number of clamped timestamps.
+    uint64_t _clampedTimestamps = 0;
+
+};
+
+
+} } // namespace ofx::IO
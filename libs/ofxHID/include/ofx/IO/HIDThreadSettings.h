@@ -0,0 +1,72 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofConstants.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Scheduling settings for threads that perform HID I/O.
+///
+/// These settings are applied by the library's background threads when they
+/// start. Real-time policies and memory locking usually require elevated
+/// privileges (e.g. CAP_SYS_NICE and CAP_IPC_LOCK on Linux). Settings that
+/// cannot be applied are logged and otherwise ignored.
+struct HIDThreadSettings
+{
+    /// \brief The thread scheduling policy.
+    enum class SchedulingPolicy
+    {
+        /// \brief Leave the platform default policy unchanged.
+        DEFAULT,
+        /// \brief First-in, first-out real-time scheduling (SCHED_FIFO).
+        FIFO,
+        /// \brief Round-robin real-time scheduling (SCHED_RR).
+        ROUND_ROBIN
+    };
+
+    /// \brief How the thread waits for data.
+    enum class WaitMode
+    {
+        /// \brief Block in the OS until data arrives or the timeout expires.
+        BLOCKING,
+        /// \brief Poll without blocking, trading a CPU core for wake-up latency.
+        BUSY_POLL
+    };
+
+    /// \brief The scheduling policy.
+    SchedulingPolicy schedulingPolicy = SchedulingPolicy::DEFAULT;
+
+    /// \brief The real-time priority, ignored for SchedulingPolicy::DEFAULT.
+    ///
+    /// The value is clamped to the range allowed for the policy.
+    int priority = 0;
+
+    /// \brief The CPU indices the thread may run on, or empty for any CPU.
+    std::vector<int> cpuAffinity;
+
+    /// \brief True if all current and future process memory should be locked.
+    ///
+    /// This calls mlockall() and affects the entire process.
+    bool lockMemory = false;
+
+    /// \brief The wait mode.
+    WaitMode waitMode = WaitMode::BLOCKING;
+
+    /// \brief Apply the scheduling settings to the calling thread.
+    /// \returns true if all requested settings were applied.
+    bool applyToCurrentThread() const;
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <list>
+#include <unordered_map>
+#include "ofConstants.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A hashed timer wheel for many coarse timers.
+///
+/// Scheduling and cancelling a timer are O(1), and advancing the wheel visits
+/// only the slots for the elapsed ticks, so a single thread can track timers
+/// for hundreds of devices cheaply. Deadlines are rounded up to whole ticks.
+///
+/// The wheel is not thread-safe.
+class HIDTimerWheel
+{
+public:
+    /// \brief Create a HIDTimerWheel.
+    /// \param tickMicros The timer resolution in microseconds.
+    /// \param slotCount The number of slots in the wheel.
+    HIDTimerWheel(uint64_t tickMicros = DEFAULT_TICK_MICROS,
+                  std::size_t slotCount = DEFAULT_SLOT_COUNT);
+
+    /// \brief Destroy the HIDTimerWheel.
+    ~HIDTimerWheel();
+
+    /// \brief Schedule a timer, replacing any timer with the same id.
+    ///
+    /// A deadline that has already passed expires on the next advance().
+    ///
+    /// \param id The timer id.
+    /// \param deadlineMicros The host monotonic deadline in microseconds.
+    void schedule(uint64_t id, uint64_t deadlineMicros);
+
+    /// \brief Cancel a timer.
+    /// \param id The timer id.
+    /// \returns true if the timer was scheduled.
+    bool cancel(uint64_t id);
+
+    /// \brief Advance the wheel and collect expired timers.
+    ///
+    /// Expired timers are removed from the wheel.
+    ///
+    /// \param nowMicros The host monotonic time in microseconds.
+    /// \param expired A vector to append the expired timer ids to.
+    /// \returns the number of expired timers.
+    std::size_t advance(uint64_t nowMicros, std::vector<uint64_t>& expired);
+
+    /// \returns the number of scheduled timers.
+    std::size_t size() const;
+
+    /// \returns the timer resolution in microseconds.
+    uint64_t tickMicros() const;
+
+    /// \brief The default timer resolution in microseconds.
+    static const uint64_t DEFAULT_TICK_MICROS;
+
+    /// \brief The default number of slots.
+    static const std::size_t DEFAULT_SLOT_COUNT;
+
+private:
+    /// \brief A scheduled timer.
+    struct Timer
+    {
+        /// \brief The timer id.
+        uint64_t id = 0;
+
+        /// \brief The tick at which the timer expires.
+        uint64_t tick = 0;
+    };
+
+    /// \brief The location of a scheduled timer.
+    struct Location
+    {
+        /// \brief The slot index.
+        std::size_t slot = 0;
+
+        /// \brief The timer's position in the slot.
+        std::list<Timer>::iterator timer;
+    };
+
+    /// \brief The slots, each holding timers whose tick maps to it.
+    std::vector<std::list<Timer>> _slots;
+
+    /// \brief The scheduled timers by id.
+    std::unordered_map<uint64_t, Location> _timers;
+
+    /// \brief The timer resolution in microseconds.
+    uint64_t _tickMicros = DEFAULT_TICK_MICROS;
+
+    /// \brief The last tick that was processed.
+    uint64_t _currentTick = 0;
+
+};
+
+
+} } // namespace ofx::IO
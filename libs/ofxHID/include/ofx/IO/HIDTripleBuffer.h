@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include "ofConstants.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A lock-free triple buffer for passing the latest value between threads.
+///
+/// A single producer fills writeBuffer() and calls publish(). A single consumer
+/// calls update() and then reads readBuffer(). Neither side ever waits. The
+/// consumer always sees the most recently published value. Intermediate
+/// values may be skipped.
+///
+/// \tparam T The value type.
+template<typename T>
+class HIDTripleBuffer
+{
+public:
+    /// \brief Create a HIDTripleBuffer with default-constructed values.
+    HIDTripleBuffer(): _middle(2)
+    {
+    }
+
+    /// \returns the buffer the producer should fill before publish().
+    T& writeBuffer()
+    {
+        return _buffers[_write];
+    }
+
+    /// \brief Publish the write buffer to the consumer.
+    void publish()
+    {
+        uint8_t previous = _middle.exchange(uint8_t(_write | DIRTY), std::memory_order_acq_rel);
+        _write = previous & INDEX;
+    }
+
+    /// \brief Swap in the most recently published value, if there is one.
+    /// \returns true if a new value was published since the last update.
+    bool update()
+    {
+        if ((_middle.load(std::memory_order_relaxed) & DIRTY) == 0)
+            return false;
+
+        uint8_t previous = _middle.exchange(_read, std::memory_order_acq_rel);
+        _read = previous & INDEX;
+        return true;
+    }
+
+    /// \returns the value the consumer should read after update().
+    const T& readBuffer() const
+    {
+        return _buffers[_read];
+    }
+
+private:
+    /// \brief Set on the middle index when it holds an unread value.
+    static constexpr uint8_t DIRTY = 0x04;
+
+    /// \brief Masks the buffer index.
+    static constexpr uint8_t INDEX = 0x03;
+
+    /// \brief The three buffers.
+    T _buffers[3];
+
+    /// \brief The producer's buffer index.
+    uint8_t _write = 0;
+
+    /// \brief The consumer's buffer index.
+    uint8_t _read = 1;
+
+    /// \brief The shared buffer index and dirty flag.
+    std::atomic<uint8_t> _middle;
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,126 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "ofx/IO/HIDBackend.h"
+#include "ofx/IO/HIDVirtualDevice.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A HIDBackend that serves HIDVirtualDevice instances.
+///
+/// Install it with HIDBackend::set() and add devices, then enumerate, open,
+/// read and write them with the usual HIDDeviceUtils and HIDDevice calls:
+///
+///     auto backend = std::make_shared<HIDVirtualBackend>();
+///     HIDBackend::set(backend);
+///
+///     HIDVirtualDevice::Settings settings;
+///     settings.vendorId = 0x16C0;
+///     settings.productId = 0x0486;
+///     auto virtualDevice = backend->addDevice(settings);
+///
+///     HIDDevice device;
+///     device.setup(HIDDeviceInfo(0x16C0, 0x0486));
+///
+/// Handles are counted on each device, so tests can check that every open is
+/// paired with a close.
+class HIDVirtualBackend: public HIDBackend
+{
+public:
+    /// \brief Destroy the backend.
+    virtual ~HIDVirtualBackend();
+
+    /// \brief Add a device.
+    /// \param settings The device settings.
+    /// \returns the added device.
+    std::shared_ptr<HIDVirtualDevice> addDevice(const HIDVirtualDevice::Settings& settings);
+
+    /// \brief Remove and disconnect a device.
+    /// \param device The device to remove.
+    /// \returns true if the device was removed.
+    bool removeDevice(const std::shared_ptr<HIDVirtualDevice>& device);
+
+    /// \returns the added devices.
+    std::vector<std::shared_ptr<HIDVirtualDevice>> devices() const;
+
+    hid_device_info* enumerate(unsigned short vendorId,
+                               unsigned short productId) override;
+
+    void freeEnumeration(hid_device_info* devices) override;
+
+    hid_device* openPath(const char* path) override;
+
+    void close(hid_device* device) override;
+
+    int write(hid_device* device,
+              const unsigned char* data,
+              std::size_t length) override;
+
+    int readTimeout(hid_device* device,
+                    unsigned char* data,
+                    std::size_t length,
+                    int milliseconds) override;
+
+    int sendFeatureReport(hid_device* device,
+                          const unsigned char* data,
+                          std::size_t length) override;
+
+    int getFeatureReport(hid_device* device,
+                         unsigned char* data,
+                         std::size_t length) override;
+
+    int getSerialNumberString(hid_device* device,
+                              wchar_t* string,
+                              std::size_t maxLength) override;
+
+    int getManufacturerString(hid_device* device,
+                              wchar_t* string,
+                              std::size_t maxLength) override;
+
+    int getProductString(hid_device* device,
+                         wchar_t* string,
+                         std::size_t maxLength) override;
+
+    bool getReportDescriptor(const std::string& path,
+                             std::vector<uint8_t>& descriptor) override;
+
+private:
+    /// \brief An open handle. Passed to callers as a hid_device*.
+    struct Handle
+    {
+        /// \brief The opened device.
+        std::shared_ptr<HIDVirtualDevice> device;
+    };
+
+    /// \returns the device of a handle.
+    static HIDVirtualDevice& _device(hid_device* handle);
+
+    /// \returns the device at the path, or nullptr if there is none.
+    std::shared_ptr<HIDVirtualDevice> _find(const std::string& path) const;
+
+    /// \brief The added devices.
+    std::vector<std::shared_ptr<HIDVirtualDevice>> _devices;
+
+    /// \brief The number used for the next generated path.
+    uint64_t _nextPathNumber = 0;
+
+    /// \brief Guards the device list.
+    mutable std::mutex _mutex;
+
+};
+
+
+} } // namespace ofx::IO
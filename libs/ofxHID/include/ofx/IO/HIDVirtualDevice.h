@@ -0,0 +1,235 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief A simulated HID device served by a HIDVirtualBackend.
+///
+/// Input reports pushed with pushInputReport() are returned by reads on any
+/// open handle. Writes and feature reports are passed to handlers, which may
+/// block to simulate a slow device.
+///
+/// HIDVirtualDevice is thread-safe.
+class HIDVirtualDevice
+{
+public:
+    struct Settings;
+
+    /// \brief Handles a write or feature report sent to the device.
+    ///
+    /// The data includes the report id byte.
+    ///
+    /// \returns the number of bytes accepted, or -1 on failure.
+    typedef std::function<int(const uint8_t* data, std::size_t size)> SendHandler;
+
+    /// \brief Handles a feature report requested from the device.
+    ///
+    /// data[0] holds the requested report id.
+    ///
+    /// \returns the number of bytes returned, or -1 on failure.
+    typedef std::function<int(uint8_t* data, std::size_t size)> GetHandler;
+
+    /// \brief Create a virtual device.
+    /// \param settings The device settings.
+    HIDVirtualDevice(const Settings& settings);
+
+    /// \returns the device settings.
+    const Settings& settings() const;
+
+    /// \returns the device path.
+    const std::string& path() const;
+
+    /// \brief Queue an input report.
+    ///
+    /// If the queue is full, the oldest report is dropped.
+    ///
+    /// \param data The report, starting with the report id if numbered.
+    /// \param size The report size in bytes.
+    /// \returns false if a queued report was dropped to make room.
+    bool pushInputReport(const uint8_t* data, std::size_t size);
+
+    /// \brief Queue an input report.
+    /// \param report The report, starting with the report id if numbered.
+    /// \returns false if a queued report was dropped to make room.
+    bool pushInputReport(const std::vector<uint8_t>& report);
+
+    /// \brief Set the handler for written output reports.
+    ///
+    /// By default every write succeeds.
+    ///
+    /// \param handler The handler, or nullptr to restore the default.
+    void setWriteHandler(SendHandler handler);
+
+    /// \brief Set the handler for sent feature reports.
+    ///
+    /// By default every feature report is accepted.
+    ///
+    /// \param handler The handler, or nullptr to restore the default.
+    void setSendFeatureHandler(SendHandler handler);
+
+    /// \brief Set the handler for requested feature reports.
+    ///
+    /// By default every request fails.
+    ///
+    /// \param handler The handler, or nullptr to restore the default.
+    void setGetFeatureHandler(GetHandler handler);
+
+    /// \brief Connect or disconnect the device.
+    ///
+    /// A disconnected device is not enumerated and cannot be opened. Calls on
+    /// handles that are already open fail, as they would for an unplugged
+    /// device.
+    ///
+    /// \param connected True to connect the device.
+    void setConnected(bool connected);
+
+    /// \returns true if the device is connected.
+    bool isConnected() const;
+
+    /// \brief Make opening the device fail, e.g. to simulate a busy device.
+    /// \param fails True to make opening fail.
+    void setOpenFails(bool fails);
+
+    /// \returns the number of handles opened.
+    uint64_t opens() const;
+
+    /// \returns the number of handles closed.
+    uint64_t closes() const;
+
+    /// \returns the number of reports written.
+    uint64_t writes() const;
+
+    /// \returns the number of queued input reports dropped because the queue
+    /// was full.
+    uint64_t droppedInputReports() const;
+
+    /// \returns the number of queued input reports.
+    std::size_t queuedInputReports() const;
+
+    struct Settings
+    {
+        /// \brief The vendor id.
+        uint16_t vendorId = 0;
+
+        /// \brief The product id.
+        uint16_t productId = 0;
+
+        /// \brief The serial number.
+        std::string serialNumber;
+
+        /// \brief The manufacturer string.
+        std::string manufacturer;
+
+        /// \brief The product string.
+        std::string product;
+
+        /// \brief The usage page of the top-level collection.
+        uint16_t usagePage = 0;
+
+        /// \brief The usage of the top-level collection.
+        uint16_t usage = 0;
+
+        /// \brief The USB interface number, or -1 if unknown.
+        int interfaceNumber = -1;
+
+        /// \brief The device path.
+        ///
+        /// If empty, HIDVirtualBackend assigns "virtual:N".
+        std::string path;
+
+        /// \brief The report descriptor, used to size packets.
+        std::vector<uint8_t> reportDescriptor;
+
+        /// \brief The maximum number of queued input reports.
+        std::size_t maxQueuedInputReports = DEFAULT_MAX_QUEUED_INPUT_REPORTS;
+    };
+
+    /// \brief The default maximum number of queued input reports.
+    ///
+    /// hidapi's own backends buffer 30 to 64 reports per device.
+    static const std::size_t DEFAULT_MAX_QUEUED_INPUT_REPORTS;
+
+private:
+    friend class HIDVirtualBackend;
+
+    /// \brief Open a handle.
+    /// \returns false if the device is disconnected or set to fail.
+    bool _open();
+
+    /// \brief Close a handle.
+    void _close();
+
+    /// \brief Read the next input report.
+    /// \returns the number of bytes read, 0 on timeout or -1 if disconnected.
+    int _read(uint8_t* data, std::size_t size, int timeoutMillis);
+
+    /// \brief Pass an output report to the write handler.
+    int _write(const uint8_t* data, std::size_t size);
+
+    /// \brief Pass a feature report to the send feature handler.
+    int _sendFeature(const uint8_t* data, std::size_t size);
+
+    /// \brief Request a feature report from the get feature handler.
+    int _getFeature(uint8_t* data, std::size_t size);
+
+    /// \brief The device settings.
+    Settings _settings;
+
+    /// \brief The queued input reports.
+    std::deque<std::vector<uint8_t>> _inputReports;
+
+    /// \brief The write handler.
+    SendHandler _writeHandler = nullptr;
+
+    /// \brief The send feature handler.
+    SendHandler _sendFeatureHandler = nullptr;
+
+    /// \brief The get feature handler.
+    GetHandler _getFeatureHandler = nullptr;
+
+    /// \brief True if the device is connected.
+    bool _connected = true;
+
+    /// \brief True if opening the device fails.
+    bool _openFails = false;
+
+    /// \brief The number of handles opened.
+    std::atomic<uint64_t> _opens;
+
+    /// \brief The number of handles closed.
+    std::atomic<uint64_t> _closes;
+
+    /// \brief The number of reports written.
+    std::atomic<uint64_t> _writes;
+
+    /// \brief The number of dropped input reports.
+    std::atomic<uint64_t> _droppedInputReports;
+
+    /// \brief Guards the input queue, handlers and connection state.
+    mutable std::mutex _mutex;
+
+    /// \brief Signals queued input reports and disconnection.
+    std::condition_variable _inputCondition;
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,337 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "ofx/IO/HIDDevice.h"
+#include "ofx/IO/HIDLatencyHistogram.h"
+#include "ofx/IO/HIDPooledReport.h"
+#include "ofx/IO/HIDThreadSettings.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+/// \brief Paces output reports to many devices that share USB hubs.
+///
+/// Each device has a token bucket that limits its report rate. The rate is
+/// capped by the polling interval of its interrupt OUT endpoint. Each hub has
+/// a token bucket that limits the total rate of its devices. The hub is found
+/// from the device path with HIDDeviceUtils::getUSBHubPath(). Devices whose
+/// hub is unknown share one group.
+///
+/// When a hub has capacity, the next report is chosen by weighted fair
+/// queuing among that hub's devices. A chatty device therefore cannot starve
+/// the others.
+///
+/// Each device has an urgent lane and a bulk lane. Urgent reports, e.g. an
+/// emergency stop, are written before queued bulk reports, so they wait for
+/// at most the report currently being written. To keep bulk traffic from
+/// starving, one bulk report is written after every urgent burst while bulk
+/// reports are waiting.
+///
+/// Reports are written on a single background thread with
+/// HIDDevice::writeReport(). Devices must be removed before they are
+/// destroyed.
+class HIDWriteScheduler
+{
+public:
+    /// \brief The output lane of a report.
+    enum class Lane
+    {
+        /// \brief Latency-critical control reports.
+        URGENT,
+        /// \brief Bulk data reports.
+        BULK
+    };
+
+    /// \brief Per-device pacing settings.
+    struct DeviceSettings
+    {
+        /// \brief The maximum report rate, or 0 for the endpoint polling rate.
+        double reportsPerSecond = 0;
+
+        /// \brief The number of reports that may be sent back to back.
+        double burst = 1;
+
+        /// \brief The share of the hub's capacity relative to other devices.
+        double weight = 1;
+
+        /// \brief The maximum number of queued reports in each lane.
+        std::size_t maxQueueSize = 64;
+    };
+
+    /// \brief Per-lane statistics.
+    struct LaneStats
+    {
+        /// \brief The number of reports written.
+        uint64_t written = 0;
+
+        /// \brief The number of reports rejected because the lane was full.
+        uint64_t rejected = 0;
+
+        /// \brief The number of reports currently queued.
+        std::size_t queued = 0;
+
+        /// \brief The time from enqueue() until each write completed.
+        HIDLatencyHistogram latency;
+    };
+
+    /// \brief Per-device statistics.
+    struct DeviceStats
+    {
+        /// \brief The device path.
+        std::string path;
+
+        /// \brief The hub port path, or an empty string if unknown.
+        std::string hub;
+
+        /// \brief The number of reports written.
+        uint64_t written = 0;
+
+        /// \brief The number of reports whose write failed.
+        uint64_t failed = 0;
+
+        /// \brief The number of reports rejected because the queue was full.
+        uint64_t rejected = 0;
+
+        /// \brief The number of reports currently queued.
+        std::size_t queued = 0;
+
+        /// \brief The configured report rate limit.
+        double reportsPerSecond = 0;
+
+        /// \brief The report rate achieved during the last second.
+        double achievedReportsPerSecond = 0;
+
+        /// \brief The urgent lane statistics.
+        LaneStats urgent;
+
+        /// \brief The bulk lane statistics.
+        LaneStats bulk;
+    };
+
+    /// \brief Create a HIDWriteScheduler.
+    HIDWriteScheduler();
+
+    /// \brief Destroy the HIDWriteScheduler, stopping its thread.
+    ~HIDWriteScheduler();
+
+    /// \brief Add a device to the scheduler with default pacing settings.
+    /// \param device The device. Must outlive the scheduler or be removed.
+    /// \returns true if the device was added.
+    bool addDevice(HIDDevice& device);
+
+    /// \brief Add a device to the scheduler.
+    ///
+    /// The device must be open so its hub and polling interval can be found.
+    ///
+    /// \param device The device. Must outlive the scheduler or be removed.
+    /// \param settings The pacing settings.
+    /// \returns true if the device was added.
+    bool addDevice(HIDDevice& device, const DeviceSettings& settings);
+
+    /// \brief Remove a device and discard its queued reports.
+    /// \param device The device to remove.
+    void removeDevice(HIDDevice& device);
+
+    /// \brief Set the maximum total report rate of each hub.
+    /// \param reportsPerSecond The rate, or 0 for no hub limit.
+    void setHubReportsPerSecond(double reportsPerSecond);
+
+    /// \returns the maximum total report rate of each hub.
+    double getHubReportsPerSecond() const;
+
+    /// \brief Set the number of urgent reports that may be written back to
+    ///        back while bulk reports are waiting.
+    /// \param urgentBurst The urgent burst length, at least 1.
+    void setUrgentBurst(std::size_t urgentBurst);
+
+    /// \returns the number of urgent reports that may be written back to
+    ///          back while bulk reports are waiting.
+    std::size_t getUrgentBurst() const;
+
+    /// \brief Queue an output report.
+    /// \param device The device, previously added with addDevice().
+    /// \param reportId The report id.
+    /// \param reportData The report data.
+    /// \param lane The output lane.
+    /// \returns false if the device is unknown or its lane is full.
+    bool enqueue(HIDDevice& device,
+                 uint8_t reportId,
+                 const std::vector<uint8_t>& reportData,
+                 Lane lane = Lane::BULK);
+
+    /// \brief Queue a pooled output report without copying it.
+    ///
+    /// The slab holds the report id followed by the report data, as passed to
+    /// HIDDevice::write(const uint8_t*, std::size_t). It is written straight
+    /// from the slab, bypassing the output report cache, and then returned to
+    /// its pool.
+    ///
+    /// \param device The device, previously added with addDevice().
+    /// \param report The report.
+    /// \param lane The output lane.
+    /// \returns false if the device is unknown, the report is empty, or its
+    ///          lane is full.
+    bool enqueue(HIDDevice& device,
+                 HIDReportHandle report,
+                 Lane lane = Lane::BULK);
+
+    /// \brief Start the writer thread.
+    void start();
+
+    /// \brief Stop the writer thread and wait for it to exit.
+    ///
+    /// Queued reports are kept.
+    void stop();
+
+    /// \returns true if the writer thread is running.
+    bool isRunning() const;
+
+    /// \brief Set the writer thread settings, applied on the next start().
+    /// \param settings The writer thread settings.
+    void setThreadSettings(const HIDThreadSettings& settings);
+
+    /// \returns the statistics of all devices.
+    std::vector<DeviceStats> stats() const;
+
+    /// \brief Reset the lane latency histograms of all devices.
+    void resetLatencies();
+
+    /// \brief The default urgent burst length.
+    static const std::size_t DEFAULT_URGENT_BURST;
+
+private:
+    /// \brief A queued report.
+    struct Report
+    {
+        /// \brief The report id.
+        uint8_t reportId = 0;
+
+        /// \brief The report data.
+        std::vector<uint8_t> data;
+
+        /// \brief The pooled report, used instead of data if set.
+        HIDReportHandle pooled;
+
+        /// \brief The weighted fair queuing finish tag.
+        double finishTag = 0;
+
+        /// \brief The time the report was queued.
+        uint64_t enqueueMicros = 0;
+    };
+
+    /// \brief A token bucket.
+    struct TokenBucket
+    {
+        /// \brief Add tokens for the elapsed time.
+        void refill(uint64_t nowMicros);
+
+        /// \returns the time when a token will be available.
+        uint64_t nextTokenMicros() const;
+
+        /// \brief Tokens per second, or 0 for unlimited.
+        double rate = 0;
+
+        /// \brief The maximum number of tokens.
+        double capacity = 1;
+
+        /// \brief The available tokens.
+        double tokens = 1;
+
+        /// \brief The last refill time.
+        uint64_t lastRefillMicros = 0;
+    };
+
+    /// \brief The state of a device.
+    struct Device
+    {
+        /// \brief The device.
+        HIDDevice* device = nullptr;
+
+        /// \brief The pacing settings.
+        DeviceSettings settings;
+
+        /// \brief The device token bucket.
+        TokenBucket bucket;
+
+        /// \brief The queued urgent reports.
+        std::deque<Report> urgentQueue;
+
+        /// \brief The queued bulk reports.
+        std::deque<Report> queue;
+
+        /// \brief The finish tag of the last queued urgent report.
+        double lastUrgentFinishTag = 0;
+
+        /// \brief The finish tag of the last queued bulk report.
+        double lastFinishTag = 0;
+
+        /// \brief The device statistics.
+        DeviceStats stats;
+
+        /// \brief The start of the current rate measurement window.
+        uint64_t windowStartMicros = 0;
+
+        /// \brief The number of reports written in the current window.
+        uint64_t windowCount = 0;
+    };
+
+    /// \brief Queue a report on a device lane.
+    bool _enqueue(HIDDevice& device, Report report, Lane lane);
+
+    /// \brief The writer thread loop.
+    void _run();
+
+    /// \brief The devices, keyed by HIDDevice pointer.
+    std::map<HIDDevice*, Device> _devices;
+
+    /// \brief The hub token buckets, keyed by hub port path.
+    std::map<std::string, TokenBucket> _hubs;
+
+    /// \brief The maximum total report rate of each hub.
+    double _hubReportsPerSecond = 0;
+
+    /// \brief The weighted fair queuing virtual time.
+    double _virtualTime = 0;
+
+    /// \brief The number of urgent reports written back to back while bulk
+    ///        reports were waiting.
+    std::size_t _urgentStreak = 0;
+
+    /// \brief The maximum urgent streak.
+    std::size_t _urgentBurst = DEFAULT_URGENT_BURST;
+
+    /// \brief The writer thread settings.
+    HIDThreadSettings _threadSettings;
+
+    /// \brief The mutex protecting the scheduler state.
+    mutable std::mutex _mutex;
+
+    /// \brief Signaled when a report is queued or the scheduler stops.
+    std::condition_variable _condition;
+
+    /// \brief True while the writer thread should keep running.
+    bool _running = false;
+
+    /// \brief The device currently being written outside of the lock.
+    HIDDevice* _activeDevice = nullptr;
+
+    /// \brief The writer thread.
+    std::thread _thread;
+
+};
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDBackend.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+std::mutex HIDBackend::_backendMutex;
+std::shared_ptr<HIDBackend> HIDBackend::_backend;
+
+
+HIDBackend::~HIDBackend()
+{
+}
+
+
+hid_device_info* HIDBackend::enumerate(unsigned short vendorId,
+                                       unsigned short productId)
+{
+    return hid_enumerate(vendorId, productId);
+}
+
+
+void HIDBackend::freeEnumeration(hid_device_info* devices)
+{
+    hid_free_enumeration(devices);
+}
+
+
+hid_device* HIDBackend::openPath(const char* path)
+{
+    return hid_open_path(path);
+}
+
+
+void HIDBackend::close(hid_device* device)
+{
+    hid_close(device);
+}
+
+
+int HIDBackend::write(hid_device* device,
+                      const unsigned char* data,
+                      std::size_t length)
+{
+    return hid_write(device, data, length);
+}
+
+
+int HIDBackend::readTimeout(hid_device* device,
+                            unsigned char* data,
+                            std::size_t length,
+                            int milliseconds)
+{
+    return hid_read_timeout(device, data, length, milliseconds);
+}
+
+
+int HIDBackend::sendFeatureReport(hid_device* device,
+                                  const unsigned char* data,
+                                  std::size_t length)
+{
+    return hid_send_feature_report(device, data, length);
+}
+
+
+int HIDBackend::getFeatureReport(hid_device* device,
+                                 unsigned char* data,
+                                 std::size_t length)
+{
+    return hid_get_feature_report(device, data, length);
+}
+
+
+int HIDBackend::getSerialNumberString(hid_device* device,
+                                      wchar_t* string,
+                                      std::size_t maxLength)
+{
+    return hid_get_serial_number_string(device, string, maxLength);
+}
+
+
+int HIDBackend::getManufacturerString(hid_device* device,
+                                      wchar_t* string,
+                                      std::size_t maxLength)
+{
+    return hid_get_manufacturer_string(device, string, maxLength);
+}
+
+
+int HIDBackend::getProductString(hid_device* device,
+                                 wchar_t* string,
+                                 std::size_t maxLength)
+{
+    return hid_get_product_string(device, string, maxLength);
+}
+
+
+bool HIDBackend::getReportDescriptor(const std::string&,
+                                     std::vector<uint8_t>& descriptor)
+{
+    descriptor.clear();
+    return false;
+}
+
+
+std::shared_ptr<HIDBackend> HIDBackend::get()
+{
+    std::unique_lock<std::mutex> lock(_backendMutex);
+
+    // Created on first use, so devices constructed during static
+    // initialization still find a backend.
+    if (!_backend)
+        _backend = std::make_shared<HIDBackend>();
+
+    return _backend;
+}
+
+
+void HIDBackend::set(std::shared_ptr<HIDBackend> backend)
+{
+    std::unique_lock<std::mutex> lock(_backendMutex);
+
+    _backend = backend;
+}
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,510 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDClockSync.h"
+#include "ofx/IO/HIDDeviceUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+
+namespace ofx {
+namespace IO {
+
+
+namespace {
+
+
+/// \brief The minimum device time span needed to estimate drift.
+const double MINIMUM_DRIFT_SPAN_MICROS = 1000;
+
+
+/// \brief The number of scaled median absolute deviations beyond which a
+///        sample is rejected as an outlier.
+const double OUTLIER_DEVIATIONS = 3;
+
+
+/// \brief Fit host = hostReference + drift * (device - deviceReference).
+///
+/// The samples must be in time order. Drift is 1 if they span too little
+/// device time to estimate it.
+template<typename SampleT>
+void fitLine(const std::vector<const SampleT*>& samples,
+             double& hostReference,
+             double& deviceReference,
+             double& drift)
+{
+    hostReference = 0;
+    deviceReference = 0;
+
+    for (auto sample: samples)
+    {
+        hostReference += sample->hostMicros;
+        deviceReference += sample->deviceMicros;
+    }
+
+    hostReference /= samples.size();
+    deviceReference /= samples.size();
+
+    double covariance = 0;
+    double variance = 0;
+
+    for (auto sample: samples)
+    {
+        double d = sample->deviceMicros - deviceReference;
+        covariance += d * (sample->hostMicros - hostReference);
+        variance += d * d;
+    }
+
+    double span = samples.back()->deviceMicros - samples.front()->deviceMicros;
+
+    drift = (std::abs(span) < MINIMUM_DRIFT_SPAN_MICROS || variance <= 0) ? 1 : covariance / variance;
+}
+
+
+}
+
+
+HIDClockSync::HIDClockSync()
+{
+    _pending.fill(0);
+}
+
+
+HIDClockSync::~HIDClockSync()
+{
+    stop();
+}
+
+
+bool HIDClockSync::setup(HIDDevice& device)
+{
+    return setup(device, Settings());
+}
+
+
+bool HIDClockSync::setup(HIDDevice& device, const Settings& settings)
+{
+    if (settings.tickBytes == 0 || settings.tickBytes > 8)
+    {
+        ofLogError("HIDClockSync::setup") << "Invalid tick size: " << settings.tickBytes;
+        return false;
+    }
+
+    if (settings.ticksPerSecond <= 0)
+    {
+        ofLogError("HIDClockSync::setup") << "Invalid tick rate: " << settings.ticksPerSecond;
+        return false;
+    }
+
+    stop();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    _device = &device;
+    _settings = settings;
+    _settings.windowSize = std::max(settings.windowSize, std::size_t(1));
+    _tickMask = (_settings.tickBytes == 8) ? std::numeric_limits<uint64_t>::max() : (uint64_t(1) << (8 * _settings.tickBytes)) - 1;
+
+    lock.unlock();
+
+    reset();
+
+    return true;
+}
+
+
+void HIDClockSync::start()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (_running || _device == nullptr)
+        return;
+
+    _running = true;
+    _thread = std::thread(&HIDClockSync::_run, this);
+}
+
+
+void HIDClockSync::stop()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _running = false;
+    }
+
+    _condition.notify_all();
+
+    if (_thread.joinable())
+        _thread.join();
+}
+
+
+bool HIDClockSync::isRunning() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _running;
+}
+
+
+bool HIDClockSync::ping()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (_device == nullptr)
+    {
+        ofLogError("HIDClockSync::ping") << "No device is set up.";
+        return false;
+    }
+
+    HIDDevice* device = _device;
+    Settings settings = _settings;
+    uint8_t sequence = _sequence++;
+
+    ++_pingsSent;
+
+    if (settings.mode == Mode::FEATURE_REPORT)
+    {
+        lock.unlock();
+
+        std::vector<uint8_t> response;
+
+        uint64_t sendMicros = HIDDeviceUtils::monotonicTimeMicros();
+        std::streamsize result = device->readFeatureReport(settings.responseReportId,
+                                                           response,
+                                                           1 + 1 + settings.tickBytes);
+        uint64_t receiveMicros = HIDDeviceUtils::monotonicTimeMicros();
+
+        if (result < std::streamsize(1 + settings.tickBytes))
+        {
+            lock.lock();
+            ++_pingsFailed;
+            return false;
+        }
+
+        uint64_t ticks = 0;
+
+        for (std::size_t i = 0; i < settings.tickBytes; ++i)
+            ticks |= uint64_t(response[1 + i]) << (8 * i);
+
+        addSample(sendMicros, receiveMicros, ticks);
+        return true;
+    }
+
+    // Expire pings that were never answered.
+    uint64_t now = HIDDeviceUtils::monotonicTimeMicros();
+
+    for (auto& sendMicros: _pending)
+    {
+        if (sendMicros != 0 && now - sendMicros > settings.timeoutMicros)
+        {
+            sendMicros = 0;
+            ++_pingsFailed;
+        }
+    }
+
+    // Record the send time before writing, so a fast response is matched.
+    _pending[sequence] = now;
+
+    lock.unlock();
+
+    std::streamsize result = device->write(settings.pingReportId, { sequence });
+
+    if (result < 0)
+    {
+        lock.lock();
+        _pending[sequence] = 0;
+        ++_pingsFailed;
+        return false;
+    }
+
+    return true;
+}
+
+
+bool HIDClockSync::handleReport(const HIDReport& report)
+{
+    return handleReport(report.data.data(), report.data.size(), report.timestampMicros);
+}
+
+
+bool HIDClockSync::handleReport(const uint8_t* data,
+                                std::size_t size,
+                                uint64_t receiveMicros)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    std::size_t offset = 0;
+
+    if (_settings.responseReportId != 0x00)
+    {
+        if (size == 0 || data[0] != _settings.responseReportId)
+            return false;
+
+        offset = 1;
+    }
+
+    if (size < offset + 1 + _settings.tickBytes)
+        return false;
+
+    uint8_t sequence = data[offset];
+    uint64_t sendMicros = _pending[sequence];
+
+    if (sendMicros == 0 || receiveMicros < sendMicros)
+        return false;
+
+    _pending[sequence] = 0;
+
+    uint64_t ticks = 0;
+
+    for (std::size_t i = 0; i < _settings.tickBytes; ++i)
+        ticks |= uint64_t(data[offset + 1 + i]) << (8 * i);
+
+    lock.unlock();
+
+    addSample(sendMicros, receiveMicros, ticks);
+    return true;
+}
+
+
+void HIDClockSync::addSample(uint64_t sendMicros,
+                             uint64_t receiveMicros,
+                             uint64_t deviceTicks)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    deviceTicks &= _tickMask;
+
+    if (!_hasBase)
+    {
+        _hasBase = true;
+        _hostBaseMicros = sendMicros;
+        _lastTicks = deviceTicks;
+        _lastUnwrappedTicks = 0;
+    }
+
+    int64_t unwrapped = _unwrap(deviceTicks);
+
+    // Only move the unwrapping reference forward.
+    if (unwrapped > _lastUnwrappedTicks)
+    {
+        _lastTicks = deviceTicks;
+        _lastUnwrappedTicks = unwrapped;
+    }
+
+    Sample sample;
+    sample.hostMicros = (double(sendMicros - _hostBaseMicros) + double(receiveMicros - _hostBaseMicros)) / 2;
+    sample.deviceMicros = unwrapped * 1000000.0 / _settings.ticksPerSecond;
+    sample.roundTripMicros = receiveMicros - sendMicros;
+
+    _samples.push_back(sample);
+
+    while (_samples.size() > _settings.windowSize)
+        _samples.pop_front();
+
+    ++_samplesAdded;
+
+    _fit();
+}
+
+
+void HIDClockSync::reset()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    _pending.fill(0);
+    _samples.clear();
+    _hasBase = false;
+    _hostBaseMicros = 0;
+    _lastTicks = 0;
+    _lastUnwrappedTicks = 0;
+    _estimate = Estimate();
+}
+
+
+bool HIDClockSync::isSynchronized() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _estimate.synchronized;
+}
+
+
+uint64_t HIDClockSync::toHostMicros(uint64_t deviceTicks) const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (!_estimate.synchronized)
+        return 0;
+
+    double deviceMicros = _unwrap(deviceTicks & _tickMask) * 1000000.0 / _settings.ticksPerSecond;
+    double hostMicros = _estimate.hostReferenceMicros + _estimate.drift * (deviceMicros - _estimate.deviceReferenceMicros);
+
+    if (hostMicros <= -double(_hostBaseMicros))
+        return 0;
+
+    return _hostBaseMicros + int64_t(std::llround(hostMicros));
+}
+
+
+HIDClockSync::Estimate HIDClockSync::estimate() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    Estimate result = _estimate;
+    result.hostReferenceMicros += _hostBaseMicros;
+    return result;
+}
+
+
+uint64_t HIDClockSync::pingsSent() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _pingsSent;
+}
+
+
+uint64_t HIDClockSync::samplesAdded() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _samplesAdded;
+}
+
+
+uint64_t HIDClockSync::pingsFailed() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _pingsFailed;
+}
+
+
+int64_t HIDClockSync::_unwrap(uint64_t deviceTicks) const
+{
+    uint64_t delta = (deviceTicks - _lastTicks) & _tickMask;
+
+    // Deltas in the upper half of the range are earlier ticks.
+    if (_tickMask != std::numeric_limits<uint64_t>::max() && delta > (_tickMask >> 1))
+        return _lastUnwrappedTicks - int64_t(_tickMask - delta + 1);
+
+    return _lastUnwrappedTicks + int64_t(delta);
+}
+
+
+void HIDClockSync::_fit()
+{
+    if (_samples.empty())
+        return;
+
+    // Keep the samples with the shortest round trips, in time order.
+    std::vector<const Sample*> ordered;
+    ordered.reserve(_samples.size());
+
+    for (const auto& sample: _samples)
+        ordered.push_back(&sample);
+
+    std::size_t count = std::max(std::min(_samples.size(), std::size_t(3)),
+                                 std::size_t(std::ceil(_samples.size() * _settings.selectFraction)));
+
+    std::vector<const Sample*> byRoundTrip = ordered;
+
+    std::nth_element(byRoundTrip.begin(),
+                     byRoundTrip.begin() + (count - 1),
+                     byRoundTrip.end(),
+                     [](const Sample* a, const Sample* b) {
+                         return a->roundTripMicros < b->roundTripMicros;
+                     });
+
+    uint64_t threshold = byRoundTrip[count - 1]->roundTripMicros;
+    uint64_t minRoundTrip = std::numeric_limits<uint64_t>::max();
+
+    std::vector<const Sample*> selected;
+
+    for (auto sample: ordered)
+    {
+        minRoundTrip = std::min(minRoundTrip, sample->roundTripMicros);
+
+        if (sample->roundTripMicros <= threshold && selected.size() < count)
+            selected.push_back(sample);
+    }
+
+    double hostReference = 0;
+    double deviceReference = 0;
+    double drift = 1;
+
+    fitLine(selected, hostReference, deviceReference, drift);
+
+    // Reject outliers by their median absolute deviation and refit.
+    if (selected.size() > 3)
+    {
+        std::vector<double> residuals;
+
+        for (auto sample: selected)
+            residuals.push_back(sample->hostMicros - (hostReference + drift * (sample->deviceMicros - deviceReference)));
+
+        std::vector<double> sorted = residuals;
+        std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+        double median = sorted[sorted.size() / 2];
+
+        for (auto& r: sorted)
+            r = std::abs(r - median);
+
+        std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+        double limit = OUTLIER_DEVIATIONS * 1.4826 * sorted[sorted.size() / 2];
+
+        if (limit > 0)
+        {
+            std::vector<const Sample*> inliers;
+
+            for (std::size_t i = 0; i < selected.size(); ++i)
+            {
+                if (std::abs(residuals[i] - median) <= limit)
+                    inliers.push_back(selected[i]);
+            }
+
+            if (inliers.size() >= 2 && inliers.size() < selected.size())
+            {
+                selected = inliers;
+                fitLine(selected, hostReference, deviceReference, drift);
+            }
+        }
+    }
+
+    double sumSquares = 0;
+
+    for (auto sample: selected)
+    {
+        double r = sample->hostMicros - (hostReference + drift * (sample->deviceMicros - deviceReference));
+        sumSquares += r * r;
+    }
+
+    _estimate.synchronized = true;
+    _estimate.hostReferenceMicros = hostReference;
+    _estimate.deviceReferenceMicros = deviceReference;
+    _estimate.drift = drift;
+    _estimate.residualMicros = std::sqrt(sumSquares / selected.size());
+    _estimate.minRoundTripMicros = minRoundTrip;
+    _estimate.samplesUsed = selected.size();
+}
+
+
+void HIDClockSync::_run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (_running)
+    {
+        lock.unlock();
+        ping();
+        lock.lock();
+
+        _condition.wait_for(lock,
+                            std::chrono::microseconds(_settings.intervalMicros),
+                            [this]() { return !_running; });
+    }
+}
+
+
+} } // namespace ofx::IO
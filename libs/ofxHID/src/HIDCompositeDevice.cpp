@@ -0,0 +1,322 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDCompositeDevice.h"
+#include "ofx/IO/HIDDeviceUtils.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+const uint64_t HIDCompositeDevice::DEFAULT_POLL_INTERVAL_MICROS = 250;
+
+
+HIDCompositeDevice::HIDCompositeDevice(std::size_t capacity):
+    _ring(std::make_shared<HIDReportRing>(capacity)),
+    _pollIntervalMicros(DEFAULT_POLL_INTERVAL_MICROS),
+    _running(false)
+{
+}
+
+
+HIDCompositeDevice::~HIDCompositeDevice()
+{
+    close();
+}
+
+
+bool HIDCompositeDevice::setup(const HIDDeviceInfo& descriptor)
+{
+    close();
+
+    auto matches = HIDDeviceUtils::listDevicesWithInfo(descriptor);
+
+    if (matches.empty())
+    {
+        ofLogError("HIDCompositeDevice::setup") << "No matching device.";
+        return false;
+    }
+
+    auto candidates = HIDDeviceUtils::listDevicesWithVendorAndProductIds(matches[0].vendorId(),
+                                                                         matches[0].productId());
+
+    for (const auto& group: groupInterfaces(candidates))
+    {
+        bool found = std::any_of(group.begin(), group.end(), [&](const HIDDeviceInfo& info) {
+            return info.path() == matches[0].path();
+        });
+
+        if (!found)
+            continue;
+
+        for (const auto& info: group)
+        {
+            auto device = std::make_unique<HIDDevice>();
+
+            if (!device->setupWithPath(info))
+            {
+                ofLogError("HIDCompositeDevice::setup") << "Unable to open interface: " << info.path();
+                close();
+                return false;
+            }
+
+            _infos.push_back(info);
+            _devices.push_back(std::move(device));
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+
+void HIDCompositeDevice::close()
+{
+    stop();
+    _devices.clear();
+    _infos.clear();
+}
+
+
+bool HIDCompositeDevice::isOpen() const
+{
+    return !_devices.empty();
+}
+
+
+std::size_t HIDCompositeDevice::interfaceCount() const
+{
+    return _devices.size();
+}
+
+
+const HIDDeviceInfo& HIDCompositeDevice::interfaceInfo(std::size_t index) const
+{
+    return _infos.at(index);
+}
+
+
+HIDDevice& HIDCompositeDevice::interfaceDevice(std::size_t index)
+{
+    return *_devices.at(index);
+}
+
+
+int HIDCompositeDevice::findInterface(uint16_t usagePage, uint16_t usage) const
+{
+    for (std::size_t i = 0; i < _infos.size(); ++i)
+    {
+        if (_infos[i].usagePage() == usagePage
+        && (usage == HIDDeviceInfo::UNDEFINED_USAGE || _infos[i].usage() == usage))
+        {
+            return int(i);
+        }
+    }
+
+    return -1;
+}
+
+
+std::streamsize HIDCompositeDevice::writeReport(std::size_t index,
+                                                uint8_t reportId,
+                                                const std::vector<uint8_t>& reportData)
+{
+    if (index >= _devices.size())
+    {
+        ofLogError("HIDCompositeDevice::writeReport") << "Invalid interface index: " << index;
+        return -1;
+    }
+
+    return _devices[index]->writeReport(reportId, reportData);
+}
+
+
+bool HIDCompositeDevice::start()
+{
+    if (_running)
+        return true;
+
+    if (!isOpen())
+    {
+        ofLogError("HIDCompositeDevice::start") << "No device is open.";
+        return false;
+    }
+
+    if (_thread.joinable())
+        _thread.join();
+
+    _running = true;
+    _thread = std::thread(&HIDCompositeDevice::_run, this);
+    return true;
+}
+
+
+void HIDCompositeDevice::stop()
+{
+    _running = false;
+
+    if (_thread.joinable())
+        _thread.join();
+
+    _ring->interrupt();
+}
+
+
+bool HIDCompositeDevice::isRunning() const
+{
+    return _running;
+}
+
+
+void HIDCompositeDevice::setThreadSettings(const HIDThreadSettings& settings)
+{
+    if (_running)
+        ofLogWarning("HIDCompositeDevice::setThreadSettings") << "Settings will be applied on the next start().";
+
+    std::unique_lock<std::mutex> lock(_threadSettingsMutex);
+    _threadSettings = settings;
+}
+
+
+void HIDCompositeDevice::setPollIntervalMicros(uint64_t pollIntervalMicros)
+{
+    _pollIntervalMicros = pollIntervalMicros;
+}
+
+
+uint64_t HIDCompositeDevice::getPollIntervalMicros() const
+{
+    return _pollIntervalMicros;
+}
+
+
+void HIDCompositeDevice::setFilter(std::shared_ptr<HIDReportFilter> filter)
+{
+    if (_running)
+    {
+        ofLogError("HIDCompositeDevice::setFilter") << "Stop the reader thread first.";
+        return;
+    }
+
+    _filter = filter;
+}
+
+
+std::shared_ptr<HIDReportFilter> HIDCompositeDevice::filter() const
+{
+    return _filter;
+}
+
+
+std::unique_ptr<HIDReportSubscriber> HIDCompositeDevice::subscribe() const
+{
+    return std::make_unique<HIDReportSubscriber>(_ring);
+}
+
+
+std::shared_ptr<HIDReportRing> HIDCompositeDevice::ring() const
+{
+    return _ring;
+}
+
+
+std::vector<HIDDeviceInfo::DeviceList> HIDCompositeDevice::groupInterfaces(const HIDDeviceInfo::DeviceList& devices)
+{
+    std::vector<HIDDeviceInfo::DeviceList> groups;
+    std::vector<std::string> ports;
+
+    for (const auto& device: devices)
+    {
+        std::string port = HIDDeviceUtils::getUSBPortPath(device.path());
+
+        bool grouped = false;
+
+        for (std::size_t i = 0; i < groups.size(); ++i)
+        {
+            const HIDDeviceInfo& first = groups[i].front();
+
+            if (first.vendorId() == device.vendorId()
+            &&  first.productId() == device.productId()
+            &&  first.serialNumber() == device.serialNumber()
+            &&  ports[i] == port)
+            {
+                groups[i].push_back(device);
+                grouped = true;
+                break;
+            }
+        }
+
+        if (!grouped)
+        {
+            groups.push_back(HIDDeviceInfo::DeviceList(1, device));
+            ports.push_back(port);
+        }
+    }
+
+    for (auto& group: groups)
+    {
+        std::stable_sort(group.begin(), group.end(), [](const HIDDeviceInfo& a, const HIDDeviceInfo& b) {
+            return a.interfaceNumber() < b.interfaceNumber();
+        });
+    }
+
+    return groups;
+}
+
+
+void HIDCompositeDevice::_run()
+{
+    HIDThreadSettings settings;
+
+    {
+        std::unique_lock<std::mutex> lock(_threadSettingsMutex);
+        settings = _threadSettings;
+    }
+
+    settings.applyToCurrentThread();
+
+    bool busyPoll = settings.waitMode == HIDThreadSettings::WaitMode::BUSY_POLL;
+
+    // Reuse the report until it is published, so empty polls do not allocate.
+    std::shared_ptr<HIDReport> report;
+
+    while (_running)
+    {
+        bool idle = true;
+
+        for (std::size_t i = 0; i < _devices.size() && _running; ++i)
+        {
+            if (!report)
+                report = std::make_shared<HIDReport>();
+
+            std::streamsize result = _devices[i]->readWithTimeout(report->data, 0);
+
+            if (result > 0)
+            {
+                report->timestampMicros = HIDDeviceUtils::monotonicTimeMicros();
+                report->interfaceIndex = i;
+                idle = false;
+
+                if (!_filter || _filter->accept(*report))
+                    _ring->publish(std::move(report));
+            }
+            else if (result < 0)
+            {
+                ofLogError("HIDCompositeDevice::_run") << "Read failed on " << _infos[i].path() << ", stopping.";
+                _running = false;
+            }
+        }
+
+        if (idle && !busyPoll)
+            std::this_thread::sleep_for(std::chrono::microseconds(_pollIntervalMicros.load()));
+    }
+}
+
+
+} } // namespace ofx::IO
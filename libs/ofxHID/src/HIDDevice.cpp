@@ -7,6 +7,7 @@
 
 #include "ofx/IO/HIDDevice.h"
 #include "ofx/IO/HIDDeviceUtils.h"
+#include "ofx/IO/HIDReportDescriptor.h"
 #include "ofUtils.h"
 
 
@@ -14,12 +15,47 @@ namespace ofx {
 namespace IO {
 
 
+namespace {
+
+
+/// \returns true if a device string is undefined or equals the expected value.
+bool matchesString(HIDBackend& backend,
+                   hid_device* handle,
+                   int (HIDBackend::*getString)(hid_device*, wchar_t*, std::size_t),
+                   const std::string& expected,
+                   const std::string& undefined)
+{
+    if (expected == undefined)
+        return true;
+
+    // USB string descriptors are limited to 126 UTF-16 code units.
+    const std::size_t MAX_STRING_LENGTH = 256;
+    wchar_t buffer[MAX_STRING_LENGTH];
+
+    if ((backend.*getString)(handle, buffer, MAX_STRING_LENGTH) != 0)
+        return false;
+
+    return HIDDeviceUtils::toMultiByteString(buffer) == expected;
+}
+
+
+}
+
+
 const uint64_t HIDDevice::INFINITE_TIMEOUT = std::numeric_limits<uint64_t>::max();
 const uint64_t HIDDevice::DEFAULT_READ_TIMEOUT = 200;
+const uint64_t HIDDevice::READ_SLICE_MILLIS = 100;
 const std::size_t HIDDevice::DEFAULT_READ_BUFFER_SIZE = 1024;
 
 
-HIDDevice::HIDDevice()
+HIDDevice::HIDDevice():
+    _readTimeoutMillis(DEFAULT_READ_TIMEOUT),
+    _readPacketSize(DEFAULT_READ_BUFFER_SIZE),
+    _writePacketSize(DEFAULT_READ_BUFFER_SIZE),
+    _featurePacketSize(DEFAULT_READ_BUFFER_SIZE),
+    _deviceHandle(nullptr),
+    _inFlight(0),
+    _closing(false)
 {
     hid_init();
 }
@@ -34,7 +70,9 @@ HIDDevice::~HIDDevice()
 
 bool HIDDevice::setup(const HIDDeviceInfo& descriptor)
 {
-    close();
+    std::unique_lock<std::mutex> lock(_lifecycleMutex);
+
+    _close();
 
     auto devices = HIDDeviceUtils::listDevicesWithInfo(descriptor);
 
@@ -44,11 +82,15 @@ bool HIDDevice::setup(const HIDDeviceInfo& descriptor)
 
         ofLogVerbose("HIDDevice::setup") << "Attempting to open: " << path;
 
-        _deviceHandle = hid_open_path(path.data());
+        _backend = HIDBackend::get();
+
+        hid_device* handle = _backend->openPath(path.data());
 
-        if (_deviceHandle != nullptr)
+        if (handle != nullptr)
         {
             _deviceInfo = std::make_unique<HIDDeviceInfo>(devices[0]);
+            _configurePacketSizes(path);
+            _deviceHandle = handle;
             return true;
         }
 
@@ -59,32 +101,100 @@ bool HIDDevice::setup(const HIDDeviceInfo& descriptor)
 }
 
 
-void HIDDevice::close()
+bool HIDDevice::setupWithPath(const HIDDeviceInfo& info)
 {
-    if (_deviceHandle)
+    std::unique_lock<std::mutex> lock(_lifecycleMutex);
+
+    _close();
+
+    std::string path = info.path();
+
+    if (path == HIDDeviceInfo::UNDEFINED_PATH)
+        return false;
+
+    _backend = HIDBackend::get();
+
+    hid_device* handle = _backend->openPath(path.data());
+
+    if (handle == nullptr)
     {
-        hid_close(_deviceHandle);
-        _deviceHandle = nullptr;
+        ofLogVerbose("HIDDevice::setupWithPath") << "Unable to open: " << path;
+        return false;
     }
+
+    bool valid = matchesString(*_backend, handle, &HIDBackend::getSerialNumberString, info.serialNumber(), HIDDeviceInfo::UNDEFINED_SERIAL_NUMBER)
+              && matchesString(*_backend, handle, &HIDBackend::getManufacturerString, info.manufacturer(), HIDDeviceInfo::UNDEFINED_MANUFACTURER)
+              && matchesString(*_backend, handle, &HIDBackend::getProductString, info.product(), HIDDeviceInfo::UNDEFINED_PRODUCT);
+
+    std::vector<uint8_t> bytes;
+    HIDReportDescriptor descriptor;
+
+    // Composite interfaces may declare several top-level collections, and
+    // the cached usage may be any of them.
+    if (valid && HIDDeviceUtils::getReportDescriptor(path, bytes) && descriptor.parse(bytes))
+        valid = descriptor.hasTopLevelUsage(info.usagePage(), info.usage());
+
+    if (!valid)
+    {
+        ofLogVerbose("HIDDevice::setupWithPath") << "A different device is at: " << path;
+        _backend->close(handle);
+        return false;
+    }
+
+    _deviceInfo = std::make_unique<HIDDeviceInfo>(info);
+    _configurePacketSizes(path);
+    _deviceHandle = handle;
+    return true;
+}
+
+
+void HIDDevice::close()
+{
+    std::unique_lock<std::mutex> lock(_lifecycleMutex);
+    _close();
 }
 
 
 bool HIDDevice::isOpen() const
 {
-    return _deviceHandle != nullptr;
+    return _deviceHandle.load() != nullptr;
 }
 
 
 std::streamsize HIDDevice::writeReport(uint8_t reportId,
                                        const std::vector<uint8_t>& reportData)
 {
-    if (isOpen())
+    HandleLease handle(*this);
+
+    if (handle.get())
     {
-        std::vector<uint8_t> data;
-        data.reserve(reportData.size() + 1);
-        data.insert(data.end(), reportId);
-        data.insert(data.end(), reportData.begin(), reportData.end());
-        return hid_write(_deviceHandle, data.data(), data.size());
+        std::unique_lock<std::mutex> lock(_writeMutex);
+
+        std::vector<uint8_t> delta;
+
+        auto action = _outputReportCache.process(reportId, reportData, delta);
+
+        std::streamsize result = -1;
+
+        switch (action)
+        {
+            case HIDOutputReportCache::Action::SEND_FULL:
+                result = _write(handle.get(), reportId, reportData);
+                break;
+            case HIDOutputReportCache::Action::SKIP:
+                result = std::streamsize(reportData.size() + 1);
+                break;
+            case HIDOutputReportCache::Action::SEND_DELTA:
+                result = _write(handle.get(), _outputReportCache.getDeltaReportId(), delta);
+
+                if (result > -1)
+                    result = std::streamsize(reportData.size() + 1);
+                break;
+        }
+
+        _outputReportCache.commit(reportId, reportData, action, result > -1);
+
+        return result;
     }
 
     ofLogError("HIDDevice::writeReport") << "No device is open.";
@@ -102,13 +212,17 @@ std::streamsize HIDDevice::writeReport(const std::vector<uint8_t>& reportData)
 std::streamsize HIDDevice::writeFeatureReport(uint8_t reportId,
                                               const std::vector<uint8_t>& reportData)
 {
-    if (isOpen())
+    HandleLease handle(*this);
+
+    if (handle.get())
     {
         std::vector<uint8_t> data;
         data.reserve(reportData.size() + 1);
         data.insert(data.end(), reportId);
         data.insert(data.end(), reportData.begin(), reportData.end());
-        return hid_send_feature_report(_deviceHandle, data.data(), data.size());
+
+        std::unique_lock<std::mutex> lock(_featureMutex);
+        return _backend->sendFeatureReport(handle.get(), data.data(), data.size());
     }
 
     ofLogError("HIDDevice::writeFeatureReport") << "No device is open.";
@@ -126,20 +240,30 @@ std::streamsize HIDDevice::readFeatureReport(uint8_t reportId,
                                              std::vector<uint8_t>& reportData,
                                              std::size_t readBufferSize)
 {
-    if (isOpen())
+    HandleLease handle(*this);
+
+    if (handle.get())
     {
         // Clear the report data.
         reportData.clear();
 
-        std::vector<uint8_t> data(readBufferSize);
+        if (readBufferSize == 0)
+            readBufferSize = _featurePacketSize;
+
+        std::vector<uint8_t> data(std::max(readBufferSize, std::size_t(1)));
 
         // Set the 0th element to the report id.
         data[0] = reportId;
 
-        // Get the feature report.
-        std::streamsize result = hid_get_feature_report(_deviceHandle,
-                                                        data.data(),
-                                                        data.size());
+        std::streamsize result = -1;
+
+        {
+            // Get the feature report.
+            std::unique_lock<std::mutex> lock(_featureMutex);
+            result = _backend->getFeatureReport(handle.get(),
+                                                data.data(),
+                                                data.size());
+        }
 
         if (result > -1)
         {
@@ -179,14 +303,24 @@ std::streamsize HIDDevice::readFeatureReport(std::vector<uint8_t>& reportData,
 std::streamsize HIDDevice::read(std::vector<uint8_t>& buffer,
                                 std::size_t readBufferSize)
 {
-    if (isOpen())
+    return readWithTimeout(buffer, _readTimeoutMillis, readBufferSize);
+}
+
+
+std::streamsize HIDDevice::readWithTimeout(std::vector<uint8_t>& buffer,
+                                           uint64_t timeoutMillis,
+                                           std::size_t readBufferSize)
+{
+    HandleLease handle(*this);
+
+    if (handle.get())
     {
+        if (readBufferSize == 0)
+            readBufferSize = _readPacketSize;
+
         buffer.resize(readBufferSize);
 
-        std::streamsize result = hid_read_timeout(_deviceHandle,
-                                                  buffer.data(),
-                                                  buffer.size(),
-                                                  int(_readTimeoutMillis == INFINITE_TIMEOUT ? -1 : _readTimeoutMillis));
+        std::streamsize result = _read(handle.get(), buffer.data(), buffer.size(), timeoutMillis);
 
         if (result > -1)
             buffer.resize(result);
@@ -196,6 +330,18 @@ std::streamsize HIDDevice::read(std::vector<uint8_t>& buffer,
         return result;
     }
 
+    ofLogError("HIDDevice::readWithTimeout") << "No device is open.";
+    return -1;
+}
+
+
+std::streamsize HIDDevice::read(uint8_t* buffer, std::size_t size)
+{
+    HandleLease handle(*this);
+
+    if (handle.get())
+        return _read(handle.get(), buffer, size, _readTimeoutMillis);
+
     ofLogError("HIDDevice::read") << "No device is open.";
     return -1;
 }
@@ -204,15 +350,21 @@ std::streamsize HIDDevice::read(std::vector<uint8_t>& buffer,
 std::streamsize HIDDevice::write(uint8_t reportId,
                                  const std::vector<uint8_t>& reportData)
 {
-    if (isOpen())
+    HandleLease handle(*this);
+
+    if (handle.get())
     {
-        std::vector<uint8_t> data;
-        data.reserve(reportData.size() + 1);
-        data.insert(data.end(), reportId);
-        data.insert(data.end(), reportData.begin(), reportData.end());
+        std::unique_lock<std::mutex> lock(_writeMutex);
+
+        std::streamsize result = _write(handle.get(), reportId, reportData);
+
+        // Remember what the device now holds, so writeReport() does not skip
+        // or delta against a stale report.
+        _outputReportCache.commit(reportId,
+                                  reportData,
+                                  HIDOutputReportCache::Action::SEND_FULL,
+                                  result > -1);
 
-        std::streamsize result = hid_write(_deviceHandle, data.data(), data.size());
-        
         if (result > -1)
         {
             // The hid api says this should be true.
@@ -231,6 +383,35 @@ std::streamsize HIDDevice::write(uint8_t reportId,
     return -1;
 }
 
+
+std::streamsize HIDDevice::write(const uint8_t* buffer, std::size_t size)
+{
+    HandleLease handle(*this);
+
+    if (handle.get())
+    {
+        std::unique_lock<std::mutex> lock(_writeMutex);
+
+        std::streamsize result = _backend->write(handle.get(), buffer, size);
+
+        // The buffer may be padded, so send the next cached report in full.
+        if (size > 0)
+            _outputReportCache.invalidate(buffer[0]);
+
+        if (result > -1)
+        {
+            // The hid api says this should be true.
+            assert(result >= 1);
+            return result - 1;
+        }
+
+        return result;
+    }
+
+    ofLogError("HIDDevice::write") << "No device is open.";
+    return -1;
+}
+
     
 void HIDDevice::setReadTimeoutMillis(uint64_t readTimeoutMillis)
 {
@@ -244,6 +425,181 @@ uint64_t HIDDevice::getReadTimeoutMillis() const
 }
 
 
+void HIDDevice::setReadPacketSize(std::size_t size)
+{
+    _readPacketSize = size;
+}
+
+
+std::size_t HIDDevice::getReadPacketSize() const
+{
+    return _readPacketSize;
+}
+
+
+void HIDDevice::setWritePacketSize(std::size_t size)
+{
+    _writePacketSize = size;
+}
+
+
+std::size_t HIDDevice::getWritePacketSize() const
+{
+    return _writePacketSize;
+}
+
+
+void HIDDevice::setFeaturePacketSize(std::size_t size)
+{
+    _featurePacketSize = size;
+}
+
+
+std::size_t HIDDevice::getFeaturePacketSize() const
+{
+    return _featurePacketSize;
+}
+
+
+const HIDDeviceInfo* HIDDevice::deviceInfo() const
+{
+    return _deviceInfo.get();
+}
+
+
+void HIDDevice::setOutputReportCacheMode(HIDOutputReportCache::Mode mode)
+{
+    std::unique_lock<std::mutex> lock(_writeMutex);
+    _outputReportCache.setMode(mode);
+}
+
+
+void HIDDevice::setOutputReportCacheDelta(uint8_t deltaReportId, float maxDeltaRatio)
+{
+    std::unique_lock<std::mutex> lock(_writeMutex);
+    _outputReportCache.setDeltaReportId(deltaReportId);
+    _outputReportCache.setMaxDeltaRatio(maxDeltaRatio);
+}
+
+
+void HIDDevice::clearOutputReportCache()
+{
+    std::unique_lock<std::mutex> lock(_writeMutex);
+    _outputReportCache.clear();
+}
+
+
+void HIDDevice::resetOutputReportCacheCounters()
+{
+    std::unique_lock<std::mutex> lock(_writeMutex);
+    _outputReportCache.resetCounters();
+}
+
+
+const HIDOutputReportCache& HIDDevice::outputReportCache() const
+{
+    return _outputReportCache;
+}
+
+
+std::streamsize HIDDevice::_read(hid_device* handle,
+                                 uint8_t* buffer,
+                                 std::size_t size,
+                                 uint64_t timeoutMillis)
+{
+    std::unique_lock<std::mutex> lock(_readMutex);
+
+    // Block in bounded slices, so a closing device never waits on a read that
+    // may not return for a long time.
+    uint64_t startMicros = HIDDeviceUtils::monotonicTimeMicros();
+    uint64_t remainingMillis = timeoutMillis;
+
+    while (true)
+    {
+        uint64_t sliceMillis = std::min(remainingMillis, READ_SLICE_MILLIS);
+
+        std::streamsize result = _backend->readTimeout(handle, buffer, size, int(sliceMillis));
+
+        if (result != 0 || _closing || remainingMillis == sliceMillis)
+            return result;
+
+        if (timeoutMillis != INFINITE_TIMEOUT)
+        {
+            uint64_t elapsedMillis = (HIDDeviceUtils::monotonicTimeMicros() - startMicros) / 1000;
+
+            if (elapsedMillis >= timeoutMillis)
+                return 0;
+
+            remainingMillis = timeoutMillis - elapsedMillis;
+        }
+    }
+}
+
+
+std::streamsize HIDDevice::_write(hid_device* handle,
+                                  uint8_t reportId,
+                                  const std::vector<uint8_t>& reportData)
+{
+    std::vector<uint8_t> data;
+    data.reserve(reportData.size() + 1);
+    data.insert(data.end(), reportId);
+    data.insert(data.end(), reportData.begin(), reportData.end());
+    return _backend->write(handle, data.data(), data.size());
+}
+
+
+void HIDDevice::_configurePacketSizes(const std::string& path)
+{
+    std::size_t readSize = DEFAULT_READ_BUFFER_SIZE;
+    std::size_t writeSize = DEFAULT_READ_BUFFER_SIZE;
+    std::size_t featureSize = DEFAULT_READ_BUFFER_SIZE;
+
+    std::vector<uint8_t> bytes;
+    HIDReportDescriptor descriptor;
+
+    if (HIDDeviceUtils::getReportDescriptor(path, bytes) && descriptor.parse(bytes))
+    {
+        typedef HIDReportDescriptor::ReportType ReportType;
+
+        // Keep room for the report id byte even if no report is declared.
+        readSize = std::max(descriptor.maxTransferSize(ReportType::INPUT), std::size_t(1));
+        writeSize = std::max(descriptor.maxTransferSize(ReportType::OUTPUT), std::size_t(1));
+        featureSize = std::max(descriptor.maxTransferSize(ReportType::FEATURE), std::size_t(1));
+
+        ofLogVerbose("HIDDevice::setup") << "Packet sizes for " << path << ": read " << readSize << ", write " << writeSize << ", feature " << featureSize << ".";
+    }
+
+    _readPacketSize = readSize;
+    _writePacketSize = writeSize;
+    _featurePacketSize = featureSize;
+}
+
+
+void HIDDevice::_close()
+{
+    hid_device* handle = _deviceHandle.load();
+
+    if (handle)
+    {
+        // New calls fail from here on. Wait for calls in flight to return.
+        _closing = true;
+
+        {
+            std::unique_lock<std::mutex> lock(_closeMutex);
+            _closeCondition.wait(lock, [&]() { return _inFlight == 0; });
+        }
+
+        _deviceHandle = nullptr;
+        _closing = false;
+
+        _backend->close(handle);
+    }
+
+    std::unique_lock<std::mutex> lock(_writeMutex);
+    _outputReportCache.clear();
+}
+
+
 hid_device* HIDDevice::device()
 {
     return _deviceHandle;
@@ -256,4 +612,31 @@ const hid_device* HIDDevice::device() const
 }
 
 
+HIDDevice::HandleLease::HandleLease(const HIDDevice& device): _device(device)
+{
+    // This pairs with close(), which sets _closing before checking
+    // _inFlight. One of them always sees the other.
+    ++_device._inFlight;
+
+    if (!_device._closing)
+        _handle = _device._deviceHandle;
+}
+
+
+HIDDevice::HandleLease::~HandleLease()
+{
+    if (--_device._inFlight == 0 && _device._closing)
+    {
+        std::unique_lock<std::mutex> lock(_device._closeMutex);
+        _device._closeCondition.notify_all();
+    }
+}
+
+
+hid_device* HIDDevice::HandleLease::get() const
+{
+    return _handle;
+}
+
+
 } } // namespace ofx::IO
@@ -0,0 +1,170 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDDeviceHandle.h"
+#include "ofx/IO/HIDBackend.h"
+#include "ofx/IO/HIDDeviceUtils.h"
+#include "hidapi/hidapi.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+HIDDeviceHandle::HIDDeviceHandle(uint16_t vendorId,
+                                 uint16_t productId,
+                                 uint16_t usagePage,
+                                 uint16_t usage,
+                                 const std::string& path,
+                                 int interfaceNumber,
+                                 StringFetcher fetcher):
+    _state(std::make_shared<State>())
+{
+    _state->vendorId = vendorId;
+    _state->productId = productId;
+    _state->usagePage = usagePage;
+    _state->usage = usage;
+    _state->path = path;
+    _state->interfaceNumber = interfaceNumber;
+    _state->fetcher = fetcher;
+    _state->fetched = false;
+}
+
+
+HIDDeviceHandle::~HIDDeviceHandle()
+{
+}
+
+
+uint16_t HIDDeviceHandle::vendorId() const
+{
+    return _state->vendorId;
+}
+
+
+uint16_t HIDDeviceHandle::productId() const
+{
+    return _state->productId;
+}
+
+
+uint16_t HIDDeviceHandle::usagePage() const
+{
+    return _state->usagePage;
+}
+
+
+uint16_t HIDDeviceHandle::usage() const
+{
+    return _state->usage;
+}
+
+
+std::string HIDDeviceHandle::path() const
+{
+    return _state->path;
+}
+
+
+int HIDDeviceHandle::interfaceNumber() const
+{
+    return _state->interfaceNumber;
+}
+
+
+const HIDDeviceHandle::Strings& HIDDeviceHandle::strings() const
+{
+    std::call_once(_state->once, [this]() {
+        if (_state->fetcher)
+            _state->strings = _state->fetcher(*this);
+        else
+            _state->strings = fetchStringsFromDevice(*this);
+
+        _state->fetched = true;
+    });
+
+    return _state->strings;
+}
+
+
+bool HIDDeviceHandle::hasStrings() const
+{
+    return _state->fetched;
+}
+
+
+std::string HIDDeviceHandle::serialNumber() const
+{
+    return strings().serialNumber;
+}
+
+
+std::string HIDDeviceHandle::manufacturer() const
+{
+    return strings().manufacturer;
+}
+
+
+std::string HIDDeviceHandle::product() const
+{
+    return strings().product;
+}
+
+
+HIDDeviceInfo HIDDeviceHandle::toDeviceInfo() const
+{
+    const Strings& deviceStrings = strings();
+
+    return HIDDeviceInfo(_state->vendorId,
+                         _state->productId,
+                         deviceStrings.serialNumber,
+                         _state->usagePage,
+                         _state->usage,
+                         deviceStrings.manufacturer,
+                         deviceStrings.product,
+                         _state->path,
+                         _state->interfaceNumber);
+}
+
+
+HIDDeviceHandle::Strings HIDDeviceHandle::fetchStringsFromDevice(const HIDDeviceHandle& handle)
+{
+    Strings result;
+    result.serialNumber = HIDDeviceInfo::UNDEFINED_SERIAL_NUMBER;
+    result.manufacturer = HIDDeviceInfo::UNDEFINED_MANUFACTURER;
+    result.product = HIDDeviceInfo::UNDEFINED_PRODUCT;
+
+    std::shared_ptr<HIDBackend> backend = HIDBackend::get();
+
+    hid_device* device = backend->openPath(handle.path().c_str());
+
+    if (device == nullptr)
+    {
+        ofLogWarning("HIDDeviceHandle::fetchStringsFromDevice") << "Unable to open: " << handle.path();
+        return result;
+    }
+
+    // USB string descriptors are limited to 126 UTF-16 code units.
+    const std::size_t MAX_STRING_LENGTH = 256;
+    wchar_t buffer[MAX_STRING_LENGTH];
+
+    if (backend->getSerialNumberString(device, buffer, MAX_STRING_LENGTH) == 0)
+        result.serialNumber = HIDDeviceUtils::toMultiByteString(buffer);
+
+    if (backend->getManufacturerString(device, buffer, MAX_STRING_LENGTH) == 0)
+        result.manufacturer = HIDDeviceUtils::toMultiByteString(buffer);
+
+    if (backend->getProductString(device, buffer, MAX_STRING_LENGTH) == 0)
+        result.product = HIDDeviceUtils::toMultiByteString(buffer);
+
+    backend->close(device);
+
+    return result;
+}
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,186 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDDeviceRegistry.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+HIDDeviceRegistry::HIDDeviceRegistry()
+{
+}
+
+
+HIDDeviceRegistry::~HIDDeviceRegistry()
+{
+}
+
+
+bool HIDDeviceRegistry::load(const std::string& path)
+{
+    ofJson json = ofLoadJson(path);
+
+    if (!json.is_object())
+    {
+        ofLogVerbose("HIDDeviceRegistry::load") << "No registry at: " << path;
+        return false;
+    }
+
+    fromJSON(json);
+    return true;
+}
+
+
+bool HIDDeviceRegistry::save(const std::string& path) const
+{
+    return ofSavePrettyJson(path, toJSON());
+}
+
+
+bool HIDDeviceRegistry::open(HIDDevice& device, const HIDDeviceInfo& query)
+{
+    for (const auto& cached: find(query))
+    {
+        if (device.setupWithPath(cached))
+        {
+            ++_hits;
+            return true;
+        }
+    }
+
+    ++_misses;
+
+    if (!device.setup(query))
+        return false;
+
+    // Remember where the device was found for the next launch.
+    if (device.deviceInfo())
+        remember(*device.deviceInfo());
+
+    return true;
+}
+
+
+void HIDDeviceRegistry::remember(const HIDDeviceInfo& info)
+{
+    for (auto& device: _devices)
+    {
+        if (_sameIdentity(device, info))
+        {
+            device = info;
+            return;
+        }
+    }
+
+    _devices.push_back(info);
+}
+
+
+void HIDDeviceRegistry::forget(const HIDDeviceInfo& query)
+{
+    _devices.erase(std::remove_if(_devices.begin(),
+                                  _devices.end(),
+                                  [&](const HIDDeviceInfo& device) {
+                                      return _matches(query, device);
+                                  }),
+                   _devices.end());
+}
+
+
+void HIDDeviceRegistry::clear()
+{
+    _devices.clear();
+}
+
+
+HIDDeviceInfo::DeviceList HIDDeviceRegistry::find(const HIDDeviceInfo& query) const
+{
+    HIDDeviceInfo::DeviceList result;
+
+    for (const auto& device: _devices)
+    {
+        if (_matches(query, device))
+            result.push_back(device);
+    }
+
+    return result;
+}
+
+
+const HIDDeviceInfo::DeviceList& HIDDeviceRegistry::devices() const
+{
+    return _devices;
+}
+
+
+uint64_t HIDDeviceRegistry::hits() const
+{
+    return _hits;
+}
+
+
+uint64_t HIDDeviceRegistry::misses() const
+{
+    return _misses;
+}
+
+
+ofJson HIDDeviceRegistry::toJSON() const
+{
+    ofJson json;
+    json["devices"] = ofJson::array();
+
+    for (const auto& device: _devices)
+        json["devices"].push_back(device.toJSON());
+
+    return json;
+}
+
+
+void HIDDeviceRegistry::fromJSON(const ofJson& json)
+{
+    _devices.clear();
+
+    auto iter = json.find("devices");
+
+    if (iter == json.end() || !iter->is_array())
+        return;
+
+    for (const auto& device: *iter)
+        remember(HIDDeviceInfo::fromJSON(device));
+}
+
+
+bool HIDDeviceRegistry::_sameIdentity(const HIDDeviceInfo& a,
+                                      const HIDDeviceInfo& b)
+{
+    return a.vendorId() == b.vendorId()
+        && a.productId() == b.productId()
+        && a.serialNumber() == b.serialNumber()
+        && a.usagePage() == b.usagePage()
+        && a.usage() == b.usage()
+        && a.interfaceNumber() == b.interfaceNumber();
+}
+
+
+bool HIDDeviceRegistry::_matches(const HIDDeviceInfo& query,
+                                 const HIDDeviceInfo& device)
+{
+    return (query.vendorId()     == HIDDeviceInfo::UNDEFINED_VENDOR_ID     || query.vendorId()     == device.vendorId())
+        && (query.productId()    == HIDDeviceInfo::UNDEFINED_PRODUCT_ID    || query.productId()    == device.productId())
+        && (query.serialNumber() == HIDDeviceInfo::UNDEFINED_SERIAL_NUMBER || query.serialNumber() == device.serialNumber())
+        && (query.usagePage()    == HIDDeviceInfo::UNDEFINED_USAGE_PAGE    || query.usagePage()    == device.usagePage())
+        && (query.usage()        == HIDDeviceInfo::UNDEFINED_USAGE         || query.usage()        == device.usage())
+        && (query.manufacturer() == HIDDeviceInfo::UNDEFINED_MANUFACTURER  || query.manufacturer() == device.manufacturer())
+        && (query.product()      == HIDDeviceInfo::UNDEFINED_PRODUCT       || query.product()      == device.product())
+        && (query.interfaceNumber() == HIDDeviceInfo::UNDEFINED_INTERFACE_NUMBER || query.interfaceNumber() == device.interfaceNumber());
+}
+
+
+} } // namespace ofx::IO
@@ -6,13 +6,241 @@
 
 
 #include "ofx/IO/HIDDeviceUtils.h"
+#include "ofx/IO/HIDBackend.h"
 #include "hidapi/hidapi.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <thread>
+
+
+#if defined(TARGET_LINUX)
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <linux/usbdevice_fs.h>
+#include <sys/ioctl.h>
+#endif
 
 
 namespace ofx {
 namespace IO {
 
 
+namespace {
+
+
+/// \brief Worker threads kept alive between string fetches.
+///
+/// Starting and joining threads on every enumeration can cost more than the
+/// fetches themselves, so workers are started on first use and reused. The
+/// pool grows to the largest thread count requested.
+class FetchWorkerPool
+{
+public:
+    ~FetchWorkerPool()
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+
+        _condition.notify_all();
+
+        for (auto& worker: _workers)
+            worker.join();
+    }
+
+    /// \brief Run a task on workerCount workers and the calling thread.
+    ///
+    /// Returns once every copy of the task has returned. Batches from
+    /// different threads run one at a time.
+    ///
+    /// \param task The task to run.
+    /// \param workerCount The number of workers to run it on.
+    void run(const std::function<void()>& task, std::size_t workerCount)
+    {
+        std::unique_lock<std::mutex> batchLock(_batchMutex);
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+
+            while (_workers.size() < workerCount)
+                _workers.push_back(std::thread(&FetchWorkerPool::_work, this));
+
+            _task = &task;
+            _unclaimed = workerCount;
+            _running = workerCount;
+        }
+
+        _condition.notify_all();
+
+        // The calling thread does its share of the work too.
+        task();
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _finished.wait(lock, [&]() { return _running == 0; });
+        _task = nullptr;
+    }
+
+    /// \returns the shared pool.
+    static FetchWorkerPool& instance()
+    {
+        static FetchWorkerPool pool;
+        return pool;
+    }
+
+private:
+    void _work()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        while (true)
+        {
+            _condition.wait(lock, [&]() { return _stopping || _unclaimed > 0; });
+
+            if (_stopping)
+                return;
+
+            --_unclaimed;
+            const std::function<void()>* task = _task;
+
+            lock.unlock();
+            (*task)();
+            lock.lock();
+
+            if (--_running == 0)
+                _finished.notify_all();
+        }
+    }
+
+    /// \brief The worker threads.
+    std::vector<std::thread> _workers;
+
+    /// \brief The task of the current batch.
+    const std::function<void()>* _task = nullptr;
+
+    /// \brief The number of workers that have yet to pick up the task.
+    std::size_t _unclaimed = 0;
+
+    /// \brief The number of workers that have yet to finish the task.
+    std::size_t _running = 0;
+
+    /// \brief True when the workers should exit.
+    bool _stopping = false;
+
+    /// \brief Serializes batches.
+    std::mutex _batchMutex;
+
+    /// \brief Guards the batch state.
+    std::mutex _mutex;
+
+    /// \brief Signaled when a batch starts or the pool stops.
+    std::condition_variable _condition;
+
+    /// \brief Signaled when the last worker finishes a batch.
+    std::condition_variable _finished;
+
+};
+
+
+#if defined(TARGET_LINUX)
+/// \returns the first line of a sysfs attribute, or an empty string.
+std::string readSysfsAttribute(const std::string& path)
+{
+    std::ifstream stream(path);
+    std::string value;
+    std::getline(stream, value);
+    return value;
+}
+
+
+/// \returns the entries of a directory, not including "." and "..".
+std::vector<std::string> listDirectory(const std::string& path)
+{
+    std::vector<std::string> entries;
+
+    DIR* directory = opendir(path.c_str());
+
+    if (directory)
+    {
+        while (struct dirent* entry = readdir(directory))
+        {
+            std::string name = entry->d_name;
+
+            if (name != "." && name != "..")
+                entries.push_back(name);
+        }
+
+        closedir(directory);
+    }
+
+    return entries;
+}
+
+
+/// \returns the sysfs USB interface directory for a HID path, or an empty
+///          string if it cannot be found.
+std::string getUSBInterfaceDirectory(const std::string& path)
+{
+    const std::string HIDRAW_PREFIX = "/dev/hidraw";
+
+    if (path.compare(0, HIDRAW_PREFIX.size(), HIDRAW_PREFIX) == 0)
+    {
+        // The hidraw backend, e.g. /dev/hidraw3. The HID device lives inside
+        // the USB interface directory.
+        std::string link = "/sys/class/hidraw/" + path.substr(5) + "/device";
+
+        char resolved[PATH_MAX];
+
+        if (realpath(link.c_str(), resolved) == nullptr)
+            return std::string();
+
+        std::string hidDirectory = resolved;
+        std::size_t n = hidDirectory.find_last_of('/');
+        return n == std::string::npos ? std::string() : hidDirectory.substr(0, n);
+    }
+
+    // The libusb backend, e.g. 0001:0005:00 (bus:device:interface).
+    unsigned int bus = 0;
+    unsigned int address = 0;
+    unsigned int interface = 0;
+
+    if (std::sscanf(path.c_str(), "%x:%x:%x", &bus, &address, &interface) != 3)
+        return std::string();
+
+    const std::string USB_DEVICES = "/sys/bus/usb/devices/";
+
+    for (const auto& name: listDirectory(USB_DEVICES))
+    {
+        // Skip interfaces, which contain a ':'.
+        if (name.find(':') != std::string::npos)
+            continue;
+
+        std::string device = USB_DEVICES + name;
+
+        if (std::atoi(readSysfsAttribute(device + "/busnum").c_str()) == int(bus)
+        &&  std::atoi(readSysfsAttribute(device + "/devnum").c_str()) == int(address))
+        {
+            std::string configuration = readSysfsAttribute(device + "/bConfigurationValue");
+            return device + "/" + name + ":" + configuration + "." + std::to_string(interface);
+        }
+    }
+
+    return std::string();
+}
+#endif
+
+
+}
+
+
 HIDDeviceInfo::DeviceList HIDDeviceUtils::listDevices()
 {
     return listDevicesWithVendorAndProductIds(HIDDeviceInfo::UNDEFINED_VENDOR_ID,
@@ -45,11 +273,61 @@ HIDDeviceInfo::DeviceList HIDDeviceUtils::listDevicesWithInfo(const HIDDeviceInf
 {
     HIDDeviceInfo::DeviceList deviceList;
 
+    std::vector<HIDDeviceHandle> candidates;
+
+    // Match everything that does not need strings first.
+    for (const auto& device: listDeviceHandles(info.vendorId(), info.productId()))
+    {
+        if ((info.vendorId()     != HIDDeviceInfo::UNDEFINED_VENDOR_ID     && info.vendorId()     != device.vendorId())
+        ||  (info.productId()    != HIDDeviceInfo::UNDEFINED_PRODUCT_ID    && info.productId()    != device.productId())
+        ||  (info.usagePage()    != HIDDeviceInfo::UNDEFINED_USAGE_PAGE    && info.usagePage()    != device.usagePage())
+        ||  (info.usage()        != HIDDeviceInfo::UNDEFINED_USAGE         && info.usage()        != device.usage())
+        ||  (info.interfaceNumber() != HIDDeviceInfo::UNDEFINED_INTERFACE_NUMBER && info.interfaceNumber() != device.interfaceNumber()))
+        // Ignore the path, as it is platform-specific.
+        {
+            // Skip it.
+        }
+        else
+        {
+            candidates.push_back(device);
+        }
+    }
+
+    // The default fetcher only converts strings already read during
+    // enumeration, which is cheaper than handing them to other threads.
+    fetchStrings(candidates, 1);
+
+    for (const auto& device: candidates)
+    {
+        if ((info.serialNumber() != HIDDeviceInfo::UNDEFINED_SERIAL_NUMBER && info.serialNumber() != device.serialNumber())
+        ||  (info.manufacturer() != HIDDeviceInfo::UNDEFINED_MANUFACTURER  && info.manufacturer() != device.manufacturer())
+        ||  (info.product()      != HIDDeviceInfo::UNDEFINED_PRODUCT       && info.product()      != device.product()))
+        {
+            // Skip it.
+        }
+        else
+        {
+            deviceList.push_back(device.toDeviceInfo());
+        }
+    }
+
+    return deviceList;
+}
+
+
+std::vector<HIDDeviceHandle> HIDDeviceUtils::listDeviceHandles(uint16_t vendorId,
+                                                               uint16_t productId,
+                                                               HIDDeviceHandle::StringFetcher fetcher)
+{
+    std::vector<HIDDeviceHandle> handles;
+
     struct hid_device_info* devices = nullptr;
     struct hid_device_info* currentDevice = nullptr;
 
+    std::shared_ptr<HIDBackend> backend = HIDBackend::get();
+
     // Enumerate matching devices.
-    devices = hid_enumerate(info.vendorId(), info.productId());
+    devices = backend->enumerate(vendorId, productId);
 
     currentDevice = devices;
 
@@ -74,70 +352,359 @@ HIDDeviceInfo::DeviceList HIDDeviceUtils::listDevicesWithInfo(const HIDDeviceInf
         }
 #endif
 
-        auto device = HIDDeviceInfo(currentDevice->vendor_id,
-                                    currentDevice->product_id,
-                                    toMultiByteString(currentDevice->serial_number),
-                                    currentDevice->usage_page,
-                                    currentDevice->usage,
-                                    toMultiByteString(currentDevice->manufacturer_string),
-                                    toMultiByteString(currentDevice->product_string),
-                                    currentDevice->path,
-                                    currentDevice->interface_number);
+        HIDDeviceHandle::StringFetcher deviceFetcher = fetcher;
 
-        if ((info.vendorId()     != HIDDeviceInfo::UNDEFINED_VENDOR_ID     && info.vendorId()     != device.vendorId())
-        ||  (info.productId()    != HIDDeviceInfo::UNDEFINED_PRODUCT_ID    && info.productId()    != device.productId())
-        ||  (info.serialNumber() != HIDDeviceInfo::UNDEFINED_SERIAL_NUMBER && info.serialNumber() != device.serialNumber())
-        ||  (info.usagePage()    != HIDDeviceInfo::UNDEFINED_USAGE_PAGE    && info.usagePage()    != device.usagePage())
-        ||  (info.usage()        != HIDDeviceInfo::UNDEFINED_USAGE         && info.usage()        != device.usage())
-        ||  (info.manufacturer() != HIDDeviceInfo::UNDEFINED_MANUFACTURER  && info.manufacturer() != device.manufacturer())
-        ||  (info.product()      != HIDDeviceInfo::UNDEFINED_PRODUCT       && info.product()      != device.product())
-        ||  (info.interfaceNumber() != HIDDeviceInfo::UNDEFINED_INTERFACE_NUMBER && info.interfaceNumber() != device.interfaceNumber()))
-        // Ignore the path, as it is platform-specific.
-        {
-            // Skip it.
-        }
-        else
+        if (!deviceFetcher)
         {
-            deviceList.push_back(device);
+            // Keep the enumerated strings and convert them on first use. The
+            // enumeration is freed below, so the strings must be copied.
+            std::wstring serialNumber = currentDevice->serial_number ? currentDevice->serial_number : L"";
+            std::wstring manufacturer = currentDevice->manufacturer_string ? currentDevice->manufacturer_string : L"";
+            std::wstring product = currentDevice->product_string ? currentDevice->product_string : L"";
+
+            deviceFetcher = [serialNumber, manufacturer, product](const HIDDeviceHandle&)
+            {
+                HIDDeviceHandle::Strings strings;
+                strings.serialNumber = toMultiByteString(serialNumber.c_str());
+                strings.manufacturer = toMultiByteString(manufacturer.c_str());
+                strings.product = toMultiByteString(product.c_str());
+                return strings;
+            };
         }
 
+        handles.push_back(HIDDeviceHandle(currentDevice->vendor_id,
+                                          currentDevice->product_id,
+                                          currentDevice->usage_page,
+                                          currentDevice->usage,
+                                          currentDevice->path,
+                                          currentDevice->interface_number,
+                                          deviceFetcher));
+
         currentDevice = currentDevice->next;
     }
 
-    hid_free_enumeration(devices);
-    
-    return deviceList;
+    backend->freeEnumeration(devices);
+
+    return handles;
+}
+
+
+void HIDDeviceUtils::fetchStrings(const std::vector<HIDDeviceHandle>& handles,
+                                  std::size_t threadCount)
+{
+    std::vector<const HIDDeviceHandle*> pending;
+
+    for (const auto& handle: handles)
+    {
+        if (!handle.hasStrings())
+            pending.push_back(&handle);
+    }
+
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    threadCount = std::min(threadCount, pending.size());
+
+    if (threadCount <= 1)
+    {
+        for (auto handle: pending)
+            handle->strings();
+
+        return;
+    }
+
+    std::atomic<std::size_t> next(0);
+
+    std::function<void()> work = [&]()
+    {
+        std::size_t i = 0;
+
+        while ((i = next++) < pending.size())
+            pending[i]->strings();
+    };
+
+    FetchWorkerPool::instance().run(work, threadCount - 1);
 }
 
 
 std::string HIDDeviceUtils::toMultiByteString(const wchar_t* input)
 {
-    if (input)
+    if (input == nullptr)
+        return std::string();
+
+    std::size_t inputSize = 0;
+    wchar_t combined = 0;
+
+    // Measure the input and check whether it is entirely ASCII in one pass.
+    while (input[inputSize] != 0)
+        combined |= input[inputSize++];
+
+    if ((uint32_t(combined) & ~uint32_t(0x7F)) == 0)
     {
-        std::size_t inputSize = std::wcslen(input);
+        // ASCII fast path: one allocation and a narrowing copy.
+        std::string output(inputSize, '\0');
+
+        for (std::size_t i = 0; i < inputSize; ++i)
+            output[i] = char(input[i]);
 
-        if (inputSize > 0)
+        return output;
+    }
+
+    std::size_t i = 0;
+
+    // Decode the next code point, replacing invalid sequences with U+FFFD.
+    auto next = [&]() -> uint32_t
+    {
+        uint32_t c = uint32_t(input[i++]);
+
+        if (sizeof(wchar_t) == 2)
         {
-            std::vector<char> output;
-            output.resize(inputSize * 4);
-            std::size_t size = std::wcstombs(output.data(), input, output.size());
+            c &= 0xFFFF;
 
-            // Add zero termination in case our buffer wasn't long enough.
-            if (size >= output.size())
+            if (c >= 0xD800 && c <= 0xDBFF)
             {
-                ofLogError("HIDDeviceUtils::toMultiByteString") << "The converted size was >= to the buffer size, clamping.";
-                output[output.size() - 1] = '\0';
+                uint32_t low = (i < inputSize) ? (uint32_t(input[i]) & 0xFFFF) : 0;
+
+                if (low >= 0xDC00 && low <= 0xDFFF)
+                {
+                    ++i;
+                    return 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                }
+
+                return 0xFFFD;
             }
+        }
+
+        if ((c >= 0xD800 && c <= 0xDFFF) || c > 0x10FFFF)
+            return 0xFFFD;
+
+        return c;
+    };
+
+    // Measure the encoded size so that the output is allocated once.
+    std::size_t outputSize = 0;
+
+    while (i < inputSize)
+    {
+        uint32_t c = next();
+        outputSize += (c < 0x80) ? 1 : (c < 0x800) ? 2 : (c < 0x10000) ? 3 : 4;
+    }
+
+    std::string output(outputSize, '\0');
+    char* out = &output[0];
 
-            return std::string(output.data(), size);
+    i = 0;
+
+    while (i < inputSize)
+    {
+        uint32_t c = next();
+
+        if (c < 0x80)
+        {
+            *out++ = char(c);
+        }
+        else if (c < 0x800)
+        {
+            *out++ = char(0xC0 | (c >> 6));
+            *out++ = char(0x80 | (c & 0x3F));
+        }
+        else if (c < 0x10000)
+        {
+            *out++ = char(0xE0 | (c >> 12));
+            *out++ = char(0x80 | ((c >> 6) & 0x3F));
+            *out++ = char(0x80 | (c & 0x3F));
         }
+        else
+        {
+            *out++ = char(0xF0 | (c >> 18));
+            *out++ = char(0x80 | ((c >> 12) & 0x3F));
+            *out++ = char(0x80 | ((c >> 6) & 0x3F));
+            *out++ = char(0x80 | (c & 0x3F));
+        }
+    }
 
-        return std::string();
+    return output;
+}
+
+
+std::string HIDDeviceUtils::getUSBPortPath(const std::string& path)
+{
+#if defined(TARGET_LINUX)
+    std::string interfaceDirectory = getUSBInterfaceDirectory(path);
 
+    // The interface directory is named <port path>:<configuration>.<interface>.
+    std::size_t slash = interfaceDirectory.find_last_of('/');
+
+    if (slash != std::string::npos)
+    {
+        std::string name = interfaceDirectory.substr(slash + 1);
+        std::size_t colon = name.find(':');
+
+        if (colon != std::string::npos)
+            return name.substr(0, colon);
     }
+#endif
 
     return std::string();
 }
 
 
+std::string HIDDeviceUtils::getUSBHubPath(const std::string& path)
+{
+    std::string port = getUSBPortPath(path);
+
+    if (port.empty())
+        return port;
+
+    std::size_t dot = port.find_last_of('.');
+
+    if (dot != std::string::npos)
+        return port.substr(0, dot);
+
+    // Attached to a root port, so the hub is the bus root hub.
+    std::size_t dash = port.find('-');
+    return "usb" + port.substr(0, dash);
+}
+
+
+uint64_t HIDDeviceUtils::getOutputIntervalMicros(const std::string& path)
+{
+#if defined(TARGET_LINUX)
+    std::string interfaceDirectory = getUSBInterfaceDirectory(path);
+
+    if (interfaceDirectory.empty())
+        return 0;
+
+    for (const auto& name: listDirectory(interfaceDirectory))
+    {
+        if (name.compare(0, 3, "ep_") != 0)
+            continue;
+
+        std::string endpoint = interfaceDirectory + "/" + name;
+
+        if (readSysfsAttribute(endpoint + "/direction") == "out"
+        &&  readSysfsAttribute(endpoint + "/type") == "Interrupt")
+        {
+            // The interval is formatted as e.g. "1ms" or "125us".
+            std::string interval = readSysfsAttribute(endpoint + "/interval");
+            uint64_t value = std::strtoull(interval.c_str(), nullptr, 10);
+
+            if (interval.find("us") != std::string::npos)
+                return value;
+
+            if (interval.find("ms") != std::string::npos)
+                return value * 1000;
+
+            return 0;
+        }
+    }
+#endif
+
+    return 0;
+}
+
+
+bool HIDDeviceUtils::getReportDescriptor(const std::string& path,
+                                         std::vector<uint8_t>& descriptor)
+{
+    if (HIDBackend::get()->getReportDescriptor(path, descriptor))
+        return true;
+
+    descriptor.clear();
+
+#if defined(TARGET_LINUX)
+    std::string file;
+
+    const std::string HIDRAW_PREFIX = "/dev/hidraw";
+
+    if (path.compare(0, HIDRAW_PREFIX.size(), HIDRAW_PREFIX) == 0)
+    {
+        file = "/sys/class/hidraw/" + path.substr(5) + "/device/report_descriptor";
+    }
+    else
+    {
+        // The HID device directory, e.g. 0003:16C0:0486.0001, lives inside the
+        // USB interface directory.
+        std::string interfaceDirectory = getUSBInterfaceDirectory(path);
+
+        if (interfaceDirectory.empty())
+            return false;
+
+        for (const auto& name: listDirectory(interfaceDirectory))
+        {
+            if (std::count(name.begin(), name.end(), ':') == 2 && name.find('.') != std::string::npos)
+            {
+                file = interfaceDirectory + "/" + name + "/report_descriptor";
+                break;
+            }
+        }
+    }
+
+    std::ifstream stream(file, std::ios::binary);
+
+    if (!stream)
+        return false;
+
+    descriptor.assign(std::istreambuf_iterator<char>(stream),
+                      std::istreambuf_iterator<char>());
+
+    return !descriptor.empty();
+#else
+    return false;
+#endif
+}
+
+
+bool HIDDeviceUtils::resetUSBDevice(const std::string& path)
+{
+#if defined(TARGET_LINUX)
+    std::string interfaceDirectory = getUSBInterfaceDirectory(path);
+
+    std::size_t slash = interfaceDirectory.find_last_of('/');
+
+    if (slash == std::string::npos)
+    {
+        ofLogError("HIDDeviceUtils::resetUSBDevice") << "Unable to find USB device for: " << path;
+        return false;
+    }
+
+    // The USB device directory contains the interface directory.
+    std::string deviceDirectory = interfaceDirectory.substr(0, slash);
+
+    int bus = std::atoi(readSysfsAttribute(deviceDirectory + "/busnum").c_str());
+    int address = std::atoi(readSysfsAttribute(deviceDirectory + "/devnum").c_str());
+
+    char node[64];
+    std::snprintf(node, sizeof(node), "/dev/bus/usb/%03d/%03d", bus, address);
+
+    int fd = ::open(node, O_WRONLY);
+
+    if (fd < 0)
+    {
+        ofLogError("HIDDeviceUtils::resetUSBDevice") << "Unable to open: " << node;
+        return false;
+    }
+
+    bool success = ::ioctl(fd, USBDEVFS_RESET, 0) == 0;
+
+    if (!success)
+        ofLogError("HIDDeviceUtils::resetUSBDevice") << "Reset failed for: " << node;
+
+    ::close(fd);
+
+    return success;
+#else
+    ofLogWarning("HIDDeviceUtils::resetUSBDevice") << "USB reset is not supported on this platform.";
+    return false;
+#endif
+}
+
+
+uint64_t HIDDeviceUtils::monotonicTimeMicros()
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+
 } } // namespace ofx::IO
@@ -0,0 +1,456 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDDeviceWatchdog.h"
+#include "ofx/IO/HIDDeviceUtils.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+HIDDeviceWatchdog::HIDDeviceWatchdog(uint64_t tickMicros):
+    _wheel(tickMicros)
+{
+}
+
+
+HIDDeviceWatchdog::~HIDDeviceWatchdog()
+{
+    stop();
+}
+
+
+bool HIDDeviceWatchdog::addDevice(HIDReportBroadcaster& broadcaster)
+{
+    return addDevice(broadcaster, DeviceSettings());
+}
+
+
+bool HIDDeviceWatchdog::addDevice(HIDReportBroadcaster& broadcaster,
+                                  const DeviceSettings& settings)
+{
+    const HIDDeviceInfo* info = broadcaster.device().deviceInfo();
+
+    if (info == nullptr)
+    {
+        ofLogError("HIDDeviceWatchdog::addDevice") << "No device is open.";
+        return false;
+    }
+
+    auto device = std::make_unique<Device>();
+    device->broadcaster = &broadcaster;
+    device->subscriber = broadcaster.subscribe();
+    device->info = std::make_unique<HIDDeviceInfo>(*info);
+    device->settings = settings;
+    device->stats.path = info->path();
+    device->stats.lastReportMicros = HIDDeviceUtils::monotonicTimeMicros();
+    device->stats.stallTimeoutMicros = _stallTimeoutMicros(*device);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (_ids.find(&broadcaster) != _ids.end())
+    {
+        ofLogError("HIDDeviceWatchdog::addDevice") << "Device is already watched: " << info->path();
+        return false;
+    }
+
+    uint64_t id = ++_nextId;
+
+    _wheel.schedule(id, _nextCheckMicros(*device, device->stats.lastReportMicros));
+    _ids[&broadcaster] = id;
+    _devices[id] = std::move(device);
+
+    return true;
+}
+
+
+void HIDDeviceWatchdog::removeDevice(HIDReportBroadcaster& broadcaster)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto iter = _ids.find(&broadcaster);
+
+    if (iter == _ids.end())
+        return;
+
+    uint64_t id = iter->second;
+
+    // Wait for a recovery action on this device to finish.
+    _condition.wait(lock, [&]() { return _activeId != id; });
+
+    _wheel.cancel(id);
+    _devices.erase(id);
+    _ids.erase(&broadcaster);
+}
+
+
+void HIDDeviceWatchdog::start()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (_running)
+        return;
+
+    _running = true;
+    _thread = std::thread(&HIDDeviceWatchdog::_run, this);
+}
+
+
+void HIDDeviceWatchdog::stop()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _running = false;
+    }
+
+    _condition.notify_all();
+
+    if (_thread.joinable())
+        _thread.join();
+}
+
+
+bool HIDDeviceWatchdog::isRunning() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _running;
+}
+
+
+void HIDDeviceWatchdog::setThreadSettings(const HIDThreadSettings& settings)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _threadSettings = settings;
+}
+
+
+std::vector<HIDDeviceWatchdog::DeviceStats> HIDDeviceWatchdog::stats() const
+{
+    std::vector<DeviceStats> result;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (const auto& entry: _devices)
+        result.push_back(entry.second->stats);
+
+    return result;
+}
+
+
+void HIDDeviceWatchdog::_run()
+{
+    HIDThreadSettings settings;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        settings = _threadSettings;
+    }
+
+    settings.applyToCurrentThread();
+
+    std::vector<uint64_t> expired;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    std::chrono::microseconds tick(_wheel.tickMicros());
+
+    while (_running)
+    {
+        _condition.wait_for(lock, tick, [&]() { return !_running; });
+
+        uint64_t now = HIDDeviceUtils::monotonicTimeMicros();
+
+        expired.clear();
+        _wheel.advance(now, expired);
+
+        for (auto id: expired)
+        {
+            if (!_running)
+                break;
+
+            _check(id, now, lock);
+        }
+    }
+}
+
+
+void HIDDeviceWatchdog::_check(uint64_t id,
+                               uint64_t nowMicros,
+                               std::unique_lock<std::mutex>& lock)
+{
+    auto iter = _devices.find(id);
+
+    if (iter == _devices.end())
+        return;
+
+    Device& device = *iter->second;
+
+    bool received = false;
+
+    HIDReportRing::SharedReport report;
+
+    while (device.subscriber->tryRead(report))
+    {
+        _learn(device, *report);
+        received = true;
+    }
+
+    // Reports dropped by a receive filter never reach the subscriber, but the
+    // device is still alive.
+    uint64_t receiveMicros = device.broadcaster->lastReceiveMicros();
+
+    if (receiveMicros > device.stats.lastReportMicros)
+    {
+        device.stats.lastReportMicros = receiveMicros;
+        received = true;
+    }
+
+    uint64_t timeout = _stallTimeoutMicros(device);
+    device.stats.stallTimeoutMicros = timeout;
+
+    if (received || nowMicros < device.stats.lastReportMicros + timeout)
+    {
+        _wheel.schedule(id, _nextCheckMicros(device, nowMicros));
+
+        if (received && device.stats.stage != Stage::HEALTHY)
+        {
+            device.stats.stage = Stage::HEALTHY;
+            ++device.stats.recoveries;
+
+            EventArgs args;
+            args.broadcaster = device.broadcaster;
+            args.stats = device.stats;
+
+            lock.unlock();
+            ofNotifyEvent(onRecovered, args, this);
+            lock.lock();
+        }
+
+        return;
+    }
+
+    if (device.stats.stage == Stage::HEALTHY)
+    {
+        device.stats.stage = Stage::STALLED;
+        ++device.stats.stalls;
+
+        // Do not learn the gap across the stall.
+        device.previousReportMicros = 0;
+
+        EventArgs args;
+        args.broadcaster = device.broadcaster;
+        args.stats = device.stats;
+
+        _activeId = id;
+        lock.unlock();
+        ofNotifyEvent(onStall, args, this);
+        lock.lock();
+        _activeId = 0;
+        _condition.notify_all();
+    }
+
+    // Escalate to the next enabled action. After a reset, keep alternating
+    // between reopening and resetting.
+    Stage next = device.stats.stage;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        switch (next)
+        {
+            case Stage::HEALTHY:
+            case Stage::STALLED:
+                next = Stage::POKE;
+                break;
+            case Stage::POKE:
+            case Stage::USB_RESET:
+                next = Stage::REOPEN;
+                break;
+            case Stage::REOPEN:
+                next = Stage::USB_RESET;
+                break;
+        }
+
+        if (_isEnabled(device, next))
+            break;
+    }
+
+    if (!_isEnabled(device, next))
+    {
+        // Nothing to try, so keep waiting for reports.
+        _wheel.schedule(id, nowMicros + timeout);
+        return;
+    }
+
+    device.stats.stage = next;
+
+    HIDReportBroadcaster& broadcaster = *device.broadcaster;
+    HIDDevice& hidDevice = broadcaster.device();
+    HIDDeviceInfo info = *device.info;
+    int pokeFeatureReportId = device.settings.pokeFeatureReportId;
+
+    _activeId = id;
+    lock.unlock();
+
+    bool success = false;
+
+    switch (next)
+    {
+        case Stage::POKE:
+        {
+            std::vector<uint8_t> data;
+            success = hidDevice.readFeatureReport(uint8_t(pokeFeatureReportId), data) >= 0;
+            break;
+        }
+        case Stage::REOPEN:
+        {
+            broadcaster.stop();
+            success = hidDevice.setup(info) && broadcaster.start();
+            break;
+        }
+        case Stage::USB_RESET:
+        {
+            // The device re-enumerates after a reset and is reopened by the
+            // next stage.
+            broadcaster.stop();
+            hidDevice.close();
+            success = HIDDeviceUtils::resetUSBDevice(info.path());
+            break;
+        }
+        case Stage::HEALTHY:
+        case Stage::STALLED:
+            break;
+    }
+
+    lock.lock();
+    _activeId = 0;
+    _condition.notify_all();
+
+    switch (next)
+    {
+        case Stage::POKE:
+            ++device.stats.pokes;
+            break;
+        case Stage::REOPEN:
+            ++device.stats.reopens;
+            break;
+        case Stage::USB_RESET:
+            ++device.stats.usbResets;
+            break;
+        case Stage::HEALTHY:
+        case Stage::STALLED:
+            break;
+    }
+
+    if (!success)
+        ++device.stats.failedActions;
+
+    if (next == Stage::REOPEN && success && hidDevice.deviceInfo())
+    {
+        // The path may change when a device re-enumerates.
+        *device.info = *hidDevice.deviceInfo();
+        device.stats.path = device.info->path();
+    }
+
+    uint64_t delay = (next == Stage::POKE) ? timeout : std::max(timeout, device.settings.recoveryMicros);
+    _wheel.schedule(id, HIDDeviceUtils::monotonicTimeMicros() + delay);
+
+    EventArgs args;
+    args.broadcaster = device.broadcaster;
+    args.stats = device.stats;
+
+    _activeId = id;
+    lock.unlock();
+    ofNotifyEvent(onRecoveryAction, args, this);
+    lock.lock();
+    _activeId = 0;
+    _condition.notify_all();
+}
+
+
+void HIDDeviceWatchdog::_learn(Device& device, const HIDReport& report)
+{
+    uint64_t timestampMicros = report.timestampMicros;
+
+    ++device.stats.reports;
+    device.stats.lastReportMicros = std::max(device.stats.lastReportMicros, timestampMicros);
+
+    // Reports dropped by the ring would make the interval look too long.
+    if (report.sequence != device.previousSequence + 1)
+        device.previousReportMicros = 0;
+
+    device.previousSequence = report.sequence;
+
+    if (device.previousReportMicros != 0 && timestampMicros > device.previousReportMicros)
+    {
+        double sample = double(timestampMicros - device.previousReportMicros);
+
+        // Smooth the interval and its deviation as TCP does for round trips.
+        if (device.intervals == 0)
+        {
+            device.intervalMicros = sample;
+            device.deviationMicros = sample / 2;
+        }
+        else
+        {
+            device.deviationMicros += (std::abs(sample - device.intervalMicros) - device.deviationMicros) / 4;
+            device.intervalMicros += (sample - device.intervalMicros) / 8;
+        }
+
+        ++device.intervals;
+    }
+
+    device.previousReportMicros = timestampMicros;
+
+    if (device.intervals >= device.settings.learningReports)
+        device.stats.expectedIntervalMicros = uint64_t(device.intervalMicros);
+}
+
+
+uint64_t HIDDeviceWatchdog::_stallTimeoutMicros(const Device& device)
+{
+    if (device.intervals < device.settings.learningReports)
+        return device.settings.initialStallMicros;
+
+    double timeout = device.settings.stallIntervals * device.intervalMicros + 4 * device.deviationMicros;
+
+    return std::max(device.settings.minimumStallMicros, uint64_t(timeout));
+}
+
+
+uint64_t HIDDeviceWatchdog::_nextCheckMicros(const Device& device, uint64_t nowMicros)
+{
+    uint64_t deadline = device.stats.lastReportMicros + _stallTimeoutMicros(device);
+
+    // Check often while learning so that the cadence is learned quickly.
+    if (device.intervals < device.settings.learningReports)
+        deadline = std::min(deadline, nowMicros + device.settings.minimumStallMicros);
+
+    return deadline;
+}
+
+
+bool HIDDeviceWatchdog::_isEnabled(const Device& device, Stage stage)
+{
+    switch (stage)
+    {
+        case Stage::POKE:
+            return device.settings.pokeFeatureReportId >= 0;
+        case Stage::REOPEN:
+            return device.settings.reopen;
+        case Stage::USB_RESET:
+            return device.settings.usbReset;
+        case Stage::HEALTHY:
+        case Stage::STALLED:
+            return false;
+    }
+
+    return false;
+}
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,53 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDGamepadState.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+const std::size_t HIDGamepadState::MAX_AXES;
+const std::size_t HIDGamepadState::MAX_BUTTONS;
+
+
+bool HIDGamepadState::isPressed(std::size_t button) const
+{
+    return button < MAX_BUTTONS && ((buttons >> button) & 1);
+}
+
+
+uint32_t HIDGamepadState::pressesSince(std::size_t button,
+                                       const HIDGamepadState& previous) const
+{
+    return button < MAX_BUTTONS ? pressCounts[button] - previous.pressCounts[button] : 0;
+}
+
+
+uint32_t HIDGamepadState::releasesSince(std::size_t button,
+                                        const HIDGamepadState& previous) const
+{
+    return button < MAX_BUTTONS ? releaseCounts[button] - previous.releaseCounts[button] : 0;
+}
+
+
+bool HIDGamepadState::wasPressed(std::size_t button,
+                                 const HIDGamepadState& previous) const
+{
+    return pressesSince(button, previous) > 0;
+}
+
+
+bool HIDGamepadState::wasReleased(std::size_t button,
+                                  const HIDGamepadState& previous) const
+{
+    return releasesSince(button, previous) > 0;
+}
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,200 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDGamepadStateTracker.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+namespace {
+
+
+/// \brief The time the decoding thread waits for a report before checking
+///        whether it should stop.
+const uint64_t POLL_TIMEOUT_MILLIS = 100;
+
+
+/// \returns the bits at the given offset, or false if out of range.
+bool extractBits(const uint8_t* data,
+                 std::size_t size,
+                 std::size_t bitOffset,
+                 std::size_t bitWidth,
+                 uint32_t& bits)
+{
+    if (bitWidth == 0 || bitWidth > 32 || bitOffset + bitWidth > size * 8)
+        return false;
+
+    uint64_t value = 0;
+    std::size_t first = bitOffset / 8;
+    std::size_t last = (bitOffset + bitWidth - 1) / 8;
+
+    for (std::size_t i = first; i <= last; ++i)
+        value |= uint64_t(data[i]) << (8 * (i - first));
+
+    bits = uint32_t((value >> (bitOffset % 8)) & ((uint64_t(1) << bitWidth) - 1));
+    return true;
+}
+
+
+}
+
+
+HIDGamepadStateTracker::HIDGamepadStateTracker(HIDReportBroadcaster& broadcaster,
+                                               const HIDGamepadMapping& mapping):
+    _broadcaster(broadcaster),
+    _mapping(mapping),
+    _running(false)
+{
+    if (_mapping.axes.size() > HIDGamepadState::MAX_AXES)
+    {
+        ofLogWarning("HIDGamepadStateTracker::HIDGamepadStateTracker") << "Only the first " << HIDGamepadState::MAX_AXES << " axes will be tracked.";
+        _mapping.axes.resize(HIDGamepadState::MAX_AXES);
+    }
+
+    if (_mapping.buttons.size() > HIDGamepadState::MAX_BUTTONS)
+    {
+        ofLogWarning("HIDGamepadStateTracker::HIDGamepadStateTracker") << "Only the first " << HIDGamepadState::MAX_BUTTONS << " buttons will be tracked.";
+        _mapping.buttons.resize(HIDGamepadState::MAX_BUTTONS);
+    }
+}
+
+
+HIDGamepadStateTracker::~HIDGamepadStateTracker()
+{
+    stop();
+}
+
+
+void HIDGamepadStateTracker::start()
+{
+    if (_running)
+        return;
+
+    _subscriber = _broadcaster.subscribe();
+    _running = true;
+    _thread = std::thread(&HIDGamepadStateTracker::_run, this);
+}
+
+
+void HIDGamepadStateTracker::stop()
+{
+    _running = false;
+
+    if (_thread.joinable())
+        _thread.join();
+
+    _subscriber.reset();
+}
+
+
+bool HIDGamepadStateTracker::isRunning() const
+{
+    return _running;
+}
+
+
+const HIDGamepadState& HIDGamepadStateTracker::latest()
+{
+    _states.update();
+    return _states.readBuffer();
+}
+
+
+bool HIDGamepadStateTracker::decode(const HIDGamepadMapping& mapping,
+                                    const uint8_t* data,
+                                    std::size_t size,
+                                    HIDGamepadState& state)
+{
+    if (mapping.reportId != 0x00)
+    {
+        if (size == 0 || data[0] != mapping.reportId)
+            return false;
+
+        // Skip the report id.
+        ++data;
+        --size;
+    }
+
+    std::size_t axisCount = std::min(mapping.axes.size(), HIDGamepadState::MAX_AXES);
+    std::size_t buttonCount = std::min(mapping.buttons.size(), HIDGamepadState::MAX_BUTTONS);
+
+    for (std::size_t i = 0; i < axisCount; ++i)
+    {
+        const auto& axis = mapping.axes[i];
+
+        uint32_t bits = 0;
+
+        if (!extractBits(data, size, axis.bitOffset, axis.bitWidth, bits))
+            return false;
+
+        int32_t value = int32_t(bits);
+
+        // Sign-extend narrow signed axes.
+        if (axis.isSigned && axis.bitWidth < 32 && ((bits >> (axis.bitWidth - 1)) & 1))
+            value = int32_t(bits | ~((uint32_t(1) << axis.bitWidth) - 1));
+
+        float range = float(axis.maximum) - float(axis.minimum);
+
+        state.rawAxes[i] = value;
+        state.axes[i] = range != 0 ? std::max(-1.0f, std::min(1.0f, 2.0f * (float(value) - float(axis.minimum)) / range - 1.0f)) : 0;
+    }
+
+    uint64_t buttons = 0;
+
+    for (std::size_t i = 0; i < buttonCount; ++i)
+    {
+        uint32_t bit = 0;
+
+        if (!extractBits(data, size, mapping.buttons[i], 1, bit))
+            return false;
+
+        buttons |= uint64_t(bit) << i;
+    }
+
+    uint64_t changed = buttons ^ state.buttons;
+
+    for (std::size_t i = 0; changed != 0 && i < buttonCount; ++i)
+    {
+        if ((changed >> i) & 1)
+        {
+            if ((buttons >> i) & 1)
+                ++state.pressCounts[i];
+            else
+                ++state.releaseCounts[i];
+        }
+    }
+
+    state.axisCount = axisCount;
+    state.buttonCount = buttonCount;
+    state.buttons = buttons;
+    ++state.reportCount;
+    return true;
+}
+
+
+void HIDGamepadStateTracker::_run()
+{
+    HIDReportRing::SharedReport report;
+
+    while (_running)
+    {
+        if (!_subscriber->read(report, POLL_TIMEOUT_MILLIS))
+            continue;
+
+        if (decode(_mapping, report->data.data(), report->data.size(), _current))
+        {
+            _current.timestampMicros = report->timestampMicros;
+            _states.writeBuffer() = _current;
+            _states.publish();
+        }
+    }
+}
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,151 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDLatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+
+namespace ofx {
+namespace IO {
+
+
+namespace {
+
+
+/// \brief The number of bits used to split each power of two.
+const std::size_t SUB_BUCKET_BITS = 3;
+
+
+/// \brief The number of buckets per power of two.
+const std::size_t SUB_BUCKETS = std::size_t(1) << SUB_BUCKET_BITS;
+
+
+/// \brief The number of buckets needed for any 64-bit value.
+const std::size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+
+}
+
+
+HIDLatencyHistogram::HIDLatencyHistogram(): _buckets(BUCKET_COUNT, 0)
+{
+}
+
+
+void HIDLatencyHistogram::record(uint64_t micros)
+{
+    ++_buckets[_bucket(micros)];
+
+    _min = (_count == 0) ? micros : std::min(_min, micros);
+    _max = std::max(_max, micros);
+    _sum += micros;
+    ++_count;
+}
+
+
+void HIDLatencyHistogram::merge(const HIDLatencyHistogram& other)
+{
+    if (other._count == 0)
+        return;
+
+    for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+        _buckets[i] += other._buckets[i];
+
+    _min = (_count == 0) ? other._min : std::min(_min, other._min);
+    _max = std::max(_max, other._max);
+    _sum += other._sum;
+    _count += other._count;
+}
+
+
+void HIDLatencyHistogram::reset()
+{
+    std::fill(_buckets.begin(), _buckets.end(), 0);
+    _count = 0;
+    _min = 0;
+    _max = 0;
+    _sum = 0;
+}
+
+
+uint64_t HIDLatencyHistogram::count() const
+{
+    return _count;
+}
+
+
+uint64_t HIDLatencyHistogram::minMicros() const
+{
+    return _min;
+}
+
+
+uint64_t HIDLatencyHistogram::maxMicros() const
+{
+    return _max;
+}
+
+
+double HIDLatencyHistogram::meanMicros() const
+{
+    return (_count == 0) ? 0 : _sum / _count;
+}
+
+
+uint64_t HIDLatencyHistogram::percentileMicros(double percentile) const
+{
+    if (_count == 0)
+        return 0;
+
+    double p = std::max(0.0, std::min(percentile, 100.0));
+    uint64_t rank = std::max(uint64_t(1), uint64_t(std::ceil(p / 100.0 * _count)));
+    uint64_t seen = 0;
+
+    for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += _buckets[i];
+
+        if (seen >= rank)
+            return std::max(_min, std::min(_upperBound(i), _max));
+    }
+
+    return _max;
+}
+
+
+std::size_t HIDLatencyHistogram::_bucket(uint64_t micros)
+{
+    if (micros < SUB_BUCKETS)
+        return std::size_t(micros);
+
+    std::size_t msb = 63;
+
+    while (((micros >> msb) & 1) == 0)
+        --msb;
+
+    std::size_t shift = msb - SUB_BUCKET_BITS;
+    std::size_t sub = std::size_t(micros >> shift) & (SUB_BUCKETS - 1);
+
+    return (shift + 1) * SUB_BUCKETS + sub;
+}
+
+
+uint64_t HIDLatencyHistogram::_upperBound(std::size_t bucket)
+{
+    if (bucket < SUB_BUCKETS)
+        return bucket;
+
+    std::size_t shift = bucket / SUB_BUCKETS - 1;
+    uint64_t sub = bucket % SUB_BUCKETS;
+    uint64_t lower = (SUB_BUCKETS + sub) << shift;
+
+    return lower + ((uint64_t(1) << shift) - 1);
+}
+
+
+} } // namespace ofx::IO
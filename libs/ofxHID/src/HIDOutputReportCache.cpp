@@ -0,0 +1,243 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDOutputReportCache.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+const uint8_t HIDOutputReportCache::DEFAULT_DELTA_REPORT_ID = 0xFE;
+const float HIDOutputReportCache::DEFAULT_MAX_DELTA_RATIO = 0.5f;
+
+
+HIDOutputReportCache::HIDOutputReportCache():
+    _mode(Mode::DISABLED),
+    _deltaReportId(DEFAULT_DELTA_REPORT_ID),
+    _maxDeltaRatio(DEFAULT_MAX_DELTA_RATIO),
+    _fullCount(0),
+    _skippedCount(0),
+    _deltaCount(0)
+{
+}
+
+
+HIDOutputReportCache::~HIDOutputReportCache()
+{
+}
+
+
+void HIDOutputReportCache::setMode(Mode mode)
+{
+    _mode = mode;
+    clear();
+}
+
+
+HIDOutputReportCache::Mode HIDOutputReportCache::getMode() const
+{
+    return _mode;
+}
+
+
+void HIDOutputReportCache::setDeltaReportId(uint8_t reportId)
+{
+    _deltaReportId = reportId;
+}
+
+
+uint8_t HIDOutputReportCache::getDeltaReportId() const
+{
+    return _deltaReportId;
+}
+
+
+void HIDOutputReportCache::setMaxDeltaRatio(float ratio)
+{
+    _maxDeltaRatio = ratio;
+}
+
+
+float HIDOutputReportCache::getMaxDeltaRatio() const
+{
+    return _maxDeltaRatio;
+}
+
+
+HIDOutputReportCache::Action HIDOutputReportCache::process(uint8_t reportId,
+                                                           const std::vector<uint8_t>& reportData,
+                                                           std::vector<uint8_t>& delta) const
+{
+    Mode mode = _mode;
+
+    if (mode == Mode::DISABLED)
+        return Action::SEND_FULL;
+
+    auto iter = _lastReports.find(reportId);
+
+    if (iter == _lastReports.end() || iter->second.size() != reportData.size())
+        return Action::SEND_FULL;
+
+    if (iter->second == reportData)
+        return Action::SKIP;
+
+    if (mode == Mode::DELTA
+    &&  reportId != _deltaReportId
+    &&  _encodeDelta(reportId, iter->second, reportData, delta))
+    {
+        return Action::SEND_DELTA;
+    }
+
+    return Action::SEND_FULL;
+}
+
+
+void HIDOutputReportCache::commit(uint8_t reportId,
+                                  const std::vector<uint8_t>& reportData,
+                                  Action action,
+                                  bool success)
+{
+    if (!success)
+    {
+        // The device state is unknown, so send the next report in full.
+        _lastReports.erase(reportId);
+        return;
+    }
+
+    switch (action)
+    {
+        case Action::SEND_FULL:
+            ++_fullCount;
+            break;
+        case Action::SKIP:
+            ++_skippedCount;
+            return;
+        case Action::SEND_DELTA:
+            ++_deltaCount;
+            break;
+    }
+
+    if (_mode != Mode::DISABLED)
+        _lastReports[reportId] = reportData;
+}
+
+
+void HIDOutputReportCache::invalidate(uint8_t reportId)
+{
+    _lastReports.erase(reportId);
+}
+
+
+void HIDOutputReportCache::clear()
+{
+    _lastReports.clear();
+}
+
+
+void HIDOutputReportCache::resetCounters()
+{
+    _fullCount = 0;
+    _skippedCount = 0;
+    _deltaCount = 0;
+}
+
+
+uint64_t HIDOutputReportCache::fullCount() const
+{
+    return _fullCount;
+}
+
+
+uint64_t HIDOutputReportCache::skippedCount() const
+{
+    return _skippedCount;
+}
+
+
+uint64_t HIDOutputReportCache::deltaCount() const
+{
+    return _deltaCount;
+}
+
+
+double HIDOutputReportCache::skipRatio() const
+{
+    uint64_t skipped = _skippedCount;
+    uint64_t total = _fullCount + skipped + _deltaCount;
+    return total > 0 ? double(skipped) / total : 0;
+}
+
+
+double HIDOutputReportCache::deltaRatio() const
+{
+    uint64_t deltas = _deltaCount;
+    uint64_t total = _fullCount + _skippedCount + deltas;
+    return total > 0 ? double(deltas) / total : 0;
+}
+
+
+bool HIDOutputReportCache::_encodeDelta(uint8_t reportId,
+                                        const std::vector<uint8_t>& previous,
+                                        const std::vector<uint8_t>& current,
+                                        std::vector<uint8_t>& delta) const
+{
+    // Each patch costs 3 header bytes, so unchanged gaps shorter than this are
+    // cheaper to include in the current patch than to start a new one.
+    const std::size_t PATCH_HEADER_SIZE = 3;
+    const std::size_t MAX_PATCH_LENGTH = std::numeric_limits<uint8_t>::max();
+    const std::size_t MAX_PATCH_OFFSET = std::numeric_limits<uint16_t>::max();
+
+    std::size_t maxSize = std::size_t(current.size() * _maxDeltaRatio.load());
+
+    delta.clear();
+    delta.push_back(reportId);
+    delta.push_back(0);
+
+    std::size_t patchCount = 0;
+    std::size_t i = 0;
+
+    while (i < current.size())
+    {
+        if (previous[i] == current[i])
+        {
+            ++i;
+            continue;
+        }
+
+        std::size_t start = i;
+        std::size_t end = i + 1;
+
+        // Extend the patch across changed bytes and short unchanged gaps.
+        for (std::size_t j = end; j < current.size() && j - start < MAX_PATCH_LENGTH; ++j)
+        {
+            if (previous[j] != current[j])
+                end = j + 1;
+            else if (j - end >= PATCH_HEADER_SIZE)
+                break;
+        }
+
+        if (start > MAX_PATCH_OFFSET || ++patchCount > std::numeric_limits<uint8_t>::max())
+            return false;
+
+        delta.push_back(uint8_t(start & 0xFF));
+        delta.push_back(uint8_t(start >> 8));
+        delta.push_back(uint8_t(end - start));
+        delta.insert(delta.end(), current.begin() + start, current.begin() + end);
+
+        if (delta.size() > maxSize)
+            return false;
+
+        i = end;
+    }
+
+    delta[1] = uint8_t(patchCount);
+    return true;
+}
+
+
+} } // namespace ofx::IO
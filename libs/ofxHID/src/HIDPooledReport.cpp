@@ -0,0 +1,34 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDPooledReport.h"
+#include "ofx/IO/HIDReportPool.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+HIDPooledReport::HIDPooledReport(HIDReportPool* pool,
+                                 uint8_t* data,
+                                 std::size_t capacity):
+    _pool(pool),
+    _data(data),
+    _capacity(capacity),
+    _references(0)
+{
+}
+
+
+void HIDPooledReport::_release()
+{
+    if (_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        _pool->_release(this);
+}
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,229 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDReportBroadcaster.h"
+#include "ofx/IO/HIDDeviceUtils.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+HIDReportBroadcaster::HIDReportBroadcaster(HIDDevice& device,
+                                           std::size_t capacity):
+    _device(device),
+    _ring(std::make_shared<HIDReportRing>(capacity)),
+    _lastReceiveMicros(0),
+    _running(false)
+{
+}
+
+
+HIDReportBroadcaster::~HIDReportBroadcaster()
+{
+    stop();
+}
+
+
+bool HIDReportBroadcaster::start()
+{
+    if (_running)
+        return true;
+
+    if (!_device.isOpen())
+    {
+        ofLogError("HIDReportBroadcaster::start") << "No device is open.";
+        return false;
+    }
+
+    // Join a thread that exited on its own after a read error.
+    if (_thread.joinable())
+        _thread.join();
+
+    _running = true;
+    _thread = std::thread(&HIDReportBroadcaster::_run, this);
+    return true;
+}
+
+
+void HIDReportBroadcaster::stop()
+{
+    _running = false;
+
+    if (_thread.joinable())
+        _thread.join();
+
+    _ring->interrupt();
+}
+
+
+bool HIDReportBroadcaster::isRunning() const
+{
+    return _running;
+}
+
+
+void HIDReportBroadcaster::setThreadSettings(const HIDThreadSettings& settings)
+{
+    if (_running)
+        ofLogWarning("HIDReportBroadcaster::setThreadSettings") << "Settings will be applied on the next start().";
+
+    std::unique_lock<std::mutex> lock(_threadSettingsMutex);
+    _threadSettings = settings;
+}
+
+
+HIDThreadSettings HIDReportBroadcaster::getThreadSettings() const
+{
+    std::unique_lock<std::mutex> lock(_threadSettingsMutex);
+    return _threadSettings;
+}
+
+
+std::unique_ptr<HIDReportSubscriber> HIDReportBroadcaster::subscribe() const
+{
+    return std::make_unique<HIDReportSubscriber>(_ring);
+}
+
+
+void HIDReportBroadcaster::publish(const std::vector<uint8_t>& data,
+                                   uint64_t timestampMicros)
+{
+    auto report = std::make_shared<HIDReport>();
+    report->data = data;
+    report->timestampMicros = timestampMicros;
+    _publish(std::move(report));
+}
+
+
+bool HIDReportBroadcaster::exportToSharedMemory(const std::string& name,
+                                                std::size_t slotCount,
+                                                std::size_t slotSize)
+{
+    if (_running)
+    {
+        ofLogError("HIDReportBroadcaster::exportToSharedMemory") << "Stop the reader thread first.";
+        return false;
+    }
+
+    // Reads never return more than the read packet size, so slots of that
+    // size hold every report, including the report id byte.
+    if (slotSize == 0)
+        slotSize = _device.getReadPacketSize();
+
+    return _sharedMemoryWriter.open(name, slotCount, slotSize);
+}
+
+
+void HIDReportBroadcaster::stopSharedMemoryExport()
+{
+    if (_running)
+    {
+        ofLogError("HIDReportBroadcaster::stopSharedMemoryExport") << "Stop the reader thread first.";
+        return;
+    }
+
+    _sharedMemoryWriter.close();
+}
+
+
+void HIDReportBroadcaster::setFilter(std::shared_ptr<HIDReportFilter> filter)
+{
+    if (_running)
+    {
+        ofLogError("HIDReportBroadcaster::setFilter") << "Stop the reader thread first.";
+        return;
+    }
+
+    _filter = filter;
+}
+
+
+std::shared_ptr<HIDReportFilter> HIDReportBroadcaster::filter() const
+{
+    return _filter;
+}
+
+
+uint64_t HIDReportBroadcaster::published() const
+{
+    return _ring->head();
+}
+
+
+uint64_t HIDReportBroadcaster::lastReceiveMicros() const
+{
+    return _lastReceiveMicros.load(std::memory_order_acquire);
+}
+
+
+std::shared_ptr<HIDReportRing> HIDReportBroadcaster::ring() const
+{
+    return _ring;
+}
+
+
+HIDDevice& HIDReportBroadcaster::device() const
+{
+    return _device;
+}
+
+
+void HIDReportBroadcaster::_publish(std::shared_ptr<HIDReport> report)
+{
+    // Record liveness before filtering, so dropped reports still count.
+    _lastReceiveMicros.store(report->timestampMicros, std::memory_order_release);
+
+    if (_filter && !_filter->accept(*report))
+        return;
+
+    if (_sharedMemoryWriter.isOpen())
+    {
+        _sharedMemoryWriter.write(report->data.data(),
+                                  report->data.size(),
+                                  report->timestampMicros);
+    }
+
+    _ring->publish(std::move(report));
+}
+
+
+void HIDReportBroadcaster::_run()
+{
+    HIDThreadSettings settings = getThreadSettings();
+
+    settings.applyToCurrentThread();
+
+    bool busyPoll = settings.waitMode == HIDThreadSettings::WaitMode::BUSY_POLL;
+
+    // Reuse the report until it is published, so timeouts and busy-poll
+    // spins do not allocate.
+    std::shared_ptr<HIDReport> report;
+
+    while (_running)
+    {
+        if (!report)
+            report = std::make_shared<HIDReport>();
+
+        std::streamsize result = busyPoll ? _device.readWithTimeout(report->data, 0)
+                                          : _device.read(report->data);
+
+        if (result > 0)
+        {
+            report->timestampMicros = HIDDeviceUtils::monotonicTimeMicros();
+            _publish(std::move(report));
+        }
+        else if (result < 0)
+        {
+            ofLogError("HIDReportBroadcaster::_run") << "Read failed, stopping.";
+            _running = false;
+        }
+    }
+}
+
+
+} } // namespace ofx::IO
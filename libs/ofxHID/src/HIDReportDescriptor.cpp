@@ -0,0 +1,260 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDReportDescriptor.h"
+#include "ofx/IO/HIDDeviceInfo.h"
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+HIDReportDescriptor::HIDReportDescriptor():
+    _usagePage(HIDDeviceInfo::UNDEFINED_USAGE_PAGE),
+    _usage(HIDDeviceInfo::UNDEFINED_USAGE)
+{
+}
+
+
+HIDReportDescriptor::~HIDReportDescriptor()
+{
+}
+
+
+bool HIDReportDescriptor::parse(const std::vector<uint8_t>& descriptor)
+{
+    _reportBits.clear();
+    _usesReportIds = false;
+    _usagePage = HIDDeviceInfo::UNDEFINED_USAGE_PAGE;
+    _usage = HIDDeviceInfo::UNDEFINED_USAGE;
+    _topLevelUsages.clear();
+
+    uint32_t usagePage = 0;
+    uint32_t usage = 0;
+    bool hasUsage = false;
+    std::size_t collectionDepth = 0;
+
+    // The global items that affect report lengths.
+    struct GlobalState
+    {
+        uint32_t reportSize = 0;
+        uint32_t reportCount = 0;
+        uint8_t reportId = 0;
+    };
+
+    GlobalState state;
+    std::vector<GlobalState> stack;
+
+    std::size_t i = 0;
+
+    while (i < descriptor.size())
+    {
+        uint8_t prefix = descriptor[i];
+
+        if (prefix == 0xFE)
+        {
+            // A long item. The data size is in the next byte.
+            if (i + 1 >= descriptor.size())
+                break;
+
+            i += 3 + descriptor[i + 1];
+            continue;
+        }
+
+        std::size_t size = prefix & 0x03;
+
+        if (size == 3)
+            size = 4;
+
+        if (i + 1 + size > descriptor.size())
+        {
+            ofLogError("HIDReportDescriptor::parse") << "Truncated item at offset " << i << ".";
+            return false;
+        }
+
+        uint32_t value = 0;
+
+        for (std::size_t j = 0; j < size; ++j)
+            value |= uint32_t(descriptor[i + 1 + j]) << (8 * j);
+
+        uint8_t type = (prefix >> 2) & 0x03;
+        uint8_t tag = prefix >> 4;
+
+        if (type == 0)
+        {
+            // Main items.
+            std::size_t bits = std::size_t(state.reportSize) * state.reportCount;
+
+            switch (tag)
+            {
+                case 0x08:
+                    _reportBits[std::make_pair(ReportType::INPUT, state.reportId)] += bits;
+                    break;
+                case 0x09:
+                    _reportBits[std::make_pair(ReportType::OUTPUT, state.reportId)] += bits;
+                    break;
+                case 0x0B:
+                    _reportBits[std::make_pair(ReportType::FEATURE, state.reportId)] += bits;
+                    break;
+                case 0x0A:
+                    if (collectionDepth == 0 && hasUsage)
+                    {
+                        // A four byte usage carries its own usage page.
+                        _topLevelUsages.push_back(std::make_pair(uint16_t(usage > 0xFFFF ? usage >> 16 : usagePage),
+                                                                 uint16_t(usage)));
+
+                        if (_topLevelUsages.size() == 1)
+                        {
+                            _usagePage = _topLevelUsages.front().first;
+                            _usage = _topLevelUsages.front().second;
+                        }
+                    }
+
+                    ++collectionDepth;
+                    break;
+                case 0x0C:
+                    if (collectionDepth > 0)
+                        --collectionDepth;
+                    break;
+            }
+
+            // Local items only apply to the next main item.
+            hasUsage = false;
+        }
+        else if (type == 1)
+        {
+            // Global items.
+            switch (tag)
+            {
+                case 0x00:
+                    usagePage = value;
+                    break;
+                case 0x07:
+                    state.reportSize = value;
+                    break;
+                case 0x08:
+                    state.reportId = uint8_t(value);
+                    _usesReportIds = true;
+                    break;
+                case 0x09:
+                    state.reportCount = value;
+                    break;
+                case 0x0A:
+                    stack.push_back(state);
+                    break;
+                case 0x0B:
+                    if (stack.empty())
+                    {
+                        ofLogError("HIDReportDescriptor::parse") << "Pop without push at offset " << i << ".";
+                        return false;
+                    }
+
+                    state = stack.back();
+                    stack.pop_back();
+                    break;
+            }
+        }
+        else if (type == 2)
+        {
+            // Local items. Only the first usage is needed.
+            if (tag == 0x00 && !hasUsage)
+            {
+                usage = (size == 4) ? value : (value & 0xFFFF);
+                hasUsage = true;
+            }
+        }
+
+        i += 1 + size;
+    }
+
+    return true;
+}
+
+
+bool HIDReportDescriptor::usesReportIds() const
+{
+    return _usesReportIds;
+}
+
+
+uint16_t HIDReportDescriptor::usagePage() const
+{
+    return _usagePage;
+}
+
+
+uint16_t HIDReportDescriptor::usage() const
+{
+    return _usage;
+}
+
+
+const std::vector<std::pair<uint16_t, uint16_t>>& HIDReportDescriptor::topLevelUsages() const
+{
+    return _topLevelUsages;
+}
+
+
+bool HIDReportDescriptor::hasTopLevelUsage(uint16_t usagePage, uint16_t usage) const
+{
+    if (usagePage == HIDDeviceInfo::UNDEFINED_USAGE_PAGE && usage == HIDDeviceInfo::UNDEFINED_USAGE)
+        return true;
+
+    for (const auto& topLevelUsage: _topLevelUsages)
+    {
+        if ((usagePage == HIDDeviceInfo::UNDEFINED_USAGE_PAGE || usagePage == topLevelUsage.first)
+        &&  (usage == HIDDeviceInfo::UNDEFINED_USAGE || usage == topLevelUsage.second))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+std::size_t HIDReportDescriptor::reportLength(ReportType type, uint8_t reportId) const
+{
+    auto iter = _reportBits.find(std::make_pair(type, reportId));
+
+    if (iter == _reportBits.end())
+        return 0;
+
+    return (iter->second + 7) / 8;
+}
+
+
+std::size_t HIDReportDescriptor::maxReportLength(ReportType type) const
+{
+    std::size_t length = 0;
+
+    for (const auto& entry: _reportBits)
+    {
+        if (entry.first.first == type)
+            length = std::max(length, (entry.second + 7) / 8);
+    }
+
+    return length;
+}
+
+
+std::size_t HIDReportDescriptor::maxTransferSize(ReportType type) const
+{
+    std::size_t length = maxReportLength(type);
+
+    if (length == 0)
+        return 0;
+
+    if (type == ReportType::INPUT && !_usesReportIds)
+        return length;
+
+    return length + 1;
+}
+
+
+} } // namespace ofx::IO
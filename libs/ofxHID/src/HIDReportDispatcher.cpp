@@ -0,0 +1,138 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDReportDispatcher.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+const std::size_t HIDReportDispatcher::DEFAULT_MAX_BATCH_SIZE = 4096;
+
+
+HIDReportDispatcher::HIDReportDispatcher()
+{
+    ofAddListener(ofEvents().update, this, &HIDReportDispatcher::_update);
+}
+
+
+HIDReportDispatcher::~HIDReportDispatcher()
+{
+    ofRemoveListener(ofEvents().update, this, &HIDReportDispatcher::_update);
+}
+
+
+void HIDReportDispatcher::addDevice(HIDReportBroadcaster& broadcaster,
+                                    Filter filter)
+{
+    removeDevice(broadcaster);
+
+    Device device;
+    device.broadcaster = &broadcaster;
+    device.subscriber = broadcaster.subscribe();
+    device.filter = filter;
+    _devices.push_back(std::move(device));
+}
+
+
+void HIDReportDispatcher::removeDevice(HIDReportBroadcaster& broadcaster)
+{
+    _devices.erase(std::remove_if(_devices.begin(),
+                                  _devices.end(),
+                                  [&](const Device& device) {
+                                      return device.broadcaster == &broadcaster;
+                                  }),
+                   _devices.end());
+}
+
+
+void HIDReportDispatcher::setMaxBatchSize(std::size_t size)
+{
+    _maxBatchSize = size;
+}
+
+
+std::size_t HIDReportDispatcher::getMaxBatchSize() const
+{
+    return _maxBatchSize;
+}
+
+
+void HIDReportDispatcher::update()
+{
+    _batch.entries.clear();
+    _batch.dropped = 0;
+
+    std::size_t limit = (_maxBatchSize == 0) ? std::numeric_limits<std::size_t>::max() : _maxBatchSize;
+
+    std::size_t count = _devices.size();
+
+    for (std::size_t i = 0; i < count && _batch.entries.size() < limit; ++i)
+    {
+        Device& device = _devices[(_firstDevice + i) % count];
+
+        Entry entry;
+        entry.broadcaster = device.broadcaster;
+
+        while (_batch.entries.size() < limit && device.subscriber->tryRead(entry.report))
+        {
+            if (device.filter && !device.filter(*entry.report))
+            {
+                ++_filtered;
+                continue;
+            }
+
+            _batch.entries.push_back(entry);
+        }
+
+        uint64_t dropped = device.subscriber->dropped();
+        _batch.dropped += dropped - device.dropped;
+        device.dropped = dropped;
+    }
+
+    // Start with the next device next frame so no device is always last
+    // when the batch is full.
+    if (count > 0)
+        _firstDevice = (_firstDevice + 1) % count;
+
+    _delivered += _batch.entries.size();
+    _dropped += _batch.dropped;
+
+    if (!_batch.entries.empty() || _batch.dropped > 0)
+        ofNotifyEvent(onReports, _batch, this);
+
+    // Release the reports so that their memory is not held until next frame.
+    _batch.entries.clear();
+}
+
+
+uint64_t HIDReportDispatcher::delivered() const
+{
+    return _delivered;
+}
+
+
+uint64_t HIDReportDispatcher::dropped() const
+{
+    return _dropped;
+}
+
+
+uint64_t HIDReportDispatcher::filtered() const
+{
+    return _filtered;
+}
+
+
+void HIDReportDispatcher::_update(ofEventArgs&)
+{
+    update();
+}
+
+
+} } // namespace ofx::IO
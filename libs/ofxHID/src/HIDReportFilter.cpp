@@ -0,0 +1,271 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDReportFilter.h"
+#include "ofLog.h"
+#include <cmath>
+#include <cstring>
+
+
+namespace ofx {
+namespace IO {
+
+
+uint64_t HIDReportFilter::Stats::filtered() const
+{
+    return unchanged + decimated + throttled;
+}
+
+
+HIDReportFilter::HIDReportFilter(bool numberedReports):
+    _numberedReports(numberedReports)
+{
+}
+
+
+HIDReportFilter::HIDReportFilter(const HIDReportDescriptor& descriptor):
+    HIDReportFilter(descriptor.usesReportIds())
+{
+}
+
+
+HIDReportFilter::~HIDReportFilter()
+{
+}
+
+
+void HIDReportFilter::setRule(uint8_t reportId, const Rule& rule)
+{
+    Entry entry = _makeEntry(rule);
+    std::unique_lock<std::mutex> lock(_mutex);
+    _rules[reportId] = std::move(entry);
+}
+
+
+void HIDReportFilter::setDefaultRule(const Rule& rule)
+{
+    Entry entry = _makeEntry(rule);
+    std::unique_lock<std::mutex> lock(_mutex);
+    _defaultRule = std::move(entry);
+}
+
+
+void HIDReportFilter::clear()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _rules.clear();
+    _defaultRule = Entry();
+    _states.clear();
+}
+
+
+bool HIDReportFilter::accept(const HIDReport& report)
+{
+    uint8_t reportId = (_numberedReports && !report.data.empty()) ? report.data[0] : 0x00;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto iter = _rules.find(reportId);
+    const Entry& entry = (iter != _rules.end()) ? iter->second : _defaultRule;
+    const Rule& rule = entry.rule;
+
+    State& state = _states[std::make_pair(report.interfaceIndex, reportId)];
+
+    if (rule.decimation > 1)
+    {
+        if (++state.count < rule.decimation)
+        {
+            ++state.stats.decimated;
+            return false;
+        }
+
+        state.count = 0;
+    }
+
+    if (state.hasLast)
+    {
+        if (rule.minIntervalMicros > 0 && report.timestampMicros < state.lastMicros + rule.minIntervalMicros)
+        {
+            ++state.stats.throttled;
+            return false;
+        }
+
+        if ((rule.dropUnchanged || !rule.fields.empty()) && state.last.size() == report.data.size())
+        {
+            std::size_t offset = _numberedReports ? 1 : 0;
+
+            if (report.data.size() <= offset
+             || !_changed(entry, state.last.data() + offset, report.data.data() + offset, report.data.size() - offset))
+            {
+                ++state.stats.unchanged;
+                return false;
+            }
+        }
+    }
+
+    state.last = report.data;
+    state.lastMicros = report.timestampMicros;
+    state.hasLast = true;
+    ++state.stats.passed;
+    return true;
+}
+
+
+HIDReportFilter::Stats HIDReportFilter::stats() const
+{
+    Stats result;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (const auto& entry: _states)
+    {
+        result.passed += entry.second.stats.passed;
+        result.unchanged += entry.second.stats.unchanged;
+        result.decimated += entry.second.stats.decimated;
+        result.throttled += entry.second.stats.throttled;
+    }
+
+    return result;
+}
+
+
+HIDReportFilter::Stats HIDReportFilter::stats(uint8_t reportId) const
+{
+    Stats result;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (const auto& entry: _states)
+    {
+        if (entry.first.second != reportId)
+            continue;
+
+        result.passed += entry.second.stats.passed;
+        result.unchanged += entry.second.stats.unchanged;
+        result.decimated += entry.second.stats.decimated;
+        result.throttled += entry.second.stats.throttled;
+    }
+
+    return result;
+}
+
+
+void HIDReportFilter::resetStats()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (auto& entry: _states)
+        entry.second.stats = Stats();
+}
+
+
+HIDReportFilter::Entry HIDReportFilter::_makeEntry(const Rule& rule)
+{
+    Entry entry;
+    entry.rule = rule;
+    entry.rule.fields.clear();
+
+    for (auto field: rule.fields)
+    {
+        if (field.type == Field::Type::FLOAT
+         && ((field.bitWidth != 32 && field.bitWidth != 64) || field.bitOffset % 8 != 0))
+        {
+            ofLogError("HIDReportFilter::_makeEntry") << "Float fields must be byte aligned and 32 or 64 bits wide, ignoring field at bit " << field.bitOffset << ".";
+            continue;
+        }
+
+        field.bitWidth = std::max(std::size_t(1), std::min(field.bitWidth, std::size_t(64)));
+
+        std::size_t end = field.bitOffset + field.bitWidth;
+
+        if (entry.covered.size() < (end + 7) / 8)
+            entry.covered.resize((end + 7) / 8, 0);
+
+        for (std::size_t bit = field.bitOffset; bit < end; ++bit)
+            entry.covered[bit / 8] |= uint8_t(1 << (bit % 8));
+
+        entry.rule.fields.push_back(field);
+    }
+
+    return entry;
+}
+
+
+bool HIDReportFilter::_changed(const Entry& entry,
+                               const uint8_t* last,
+                               const uint8_t* data,
+                               std::size_t size)
+{
+    // Compare the bits outside of the deadband fields exactly.
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        uint8_t uncovered = (i < entry.covered.size()) ? uint8_t(~entry.covered[i]) : uint8_t(0xFF);
+
+        if ((last[i] ^ data[i]) & uncovered)
+            return true;
+    }
+
+    for (const auto& field: entry.rule.fields)
+    {
+        // Skip fields that are not present in this report.
+        if ((field.bitOffset + field.bitWidth + 7) / 8 > size)
+            continue;
+
+        if (std::abs(_value(field, data) - _value(field, last)) > field.deadband)
+            return true;
+    }
+
+    return false;
+}
+
+
+double HIDReportFilter::_value(const Field& field, const uint8_t* data)
+{
+    std::size_t width = field.bitWidth;
+
+    if (field.type == Field::Type::FLOAT)
+    {
+        const uint8_t* bytes = data + field.bitOffset / 8;
+
+        if (width == 32)
+        {
+            float value;
+            std::memcpy(&value, bytes, sizeof(value));
+            return value;
+        }
+
+        double value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+
+    std::size_t first = field.bitOffset / 8;
+    std::size_t shift = field.bitOffset % 8;
+    std::size_t count = (shift + width + 7) / 8;
+
+    // Fields may span up to 9 bytes when unaligned.
+    uint64_t bits = 0;
+
+    for (std::size_t i = 0; i < std::min(count, std::size_t(8)); ++i)
+        bits |= uint64_t(data[first + i]) << (8 * i);
+
+    bits >>= shift;
+
+    if (count > 8)
+        bits |= uint64_t(data[first + 8]) << (64 - shift);
+
+    uint64_t mask = (width == 64) ? ~uint64_t(0) : ((uint64_t(1) << width) - 1);
+    bits &= mask;
+
+    if (field.type == Field::Type::SIGNED && width < 64 && ((bits >> (width - 1)) & 1))
+        bits |= ~mask;
+
+    return (field.type == Field::Type::SIGNED) ? double(int64_t(bits)) : double(bits);
+}
+
+
+} } // namespace ofx::IO
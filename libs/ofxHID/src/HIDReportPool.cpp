@@ -0,0 +1,144 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDReportPool.h"
+#include "ofx/IO/HIDDeviceUtils.h"
+#include <cstdint>
+
+
+namespace ofx {
+namespace IO {
+
+
+const std::size_t HIDReportPool::DEFAULT_SLAB_COUNT = 256;
+
+
+HIDReportPool::HIDReportPool(std::size_t slabCount,
+                             std::size_t slabCapacity):
+    _slabCapacity(slabCapacity)
+{
+    // Keep each slab on its own cache lines so threads working on different
+    // slabs do not contend.
+    const std::size_t CACHE_LINE_SIZE = 64;
+    std::size_t stride = (slabCapacity + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+
+    // The vector only guarantees the alignment of its element type, so
+    // over-allocate and start the first slab on a cache line boundary.
+    _storage.resize(slabCount * stride + CACHE_LINE_SIZE - 1);
+
+    std::size_t misalignment = reinterpret_cast<std::uintptr_t>(_storage.data()) % CACHE_LINE_SIZE;
+    uint8_t* slabs = _storage.data() + (misalignment == 0 ? 0 : CACHE_LINE_SIZE - misalignment);
+
+    _slabs.reserve(slabCount);
+    _free.reserve(slabCount);
+
+    for (std::size_t i = 0; i < slabCount; ++i)
+    {
+        _slabs.push_back(std::unique_ptr<HIDPooledReport>(new HIDPooledReport(this, slabs + i * stride, slabCapacity)));
+        _free.push_back(_slabs.back().get());
+    }
+}
+
+
+HIDReportPool::HIDReportPool(const HIDDevice& device,
+                             std::size_t slabCount):
+    HIDReportPool(slabCount, device.getReadPacketSize())
+{
+}
+
+
+HIDReportPool::~HIDReportPool()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (_free.size() != _slabs.size())
+    {
+        ofLogError("HIDReportPool::~HIDReportPool") << (_slabs.size() - _free.size()) << " reports are still in use.";
+    }
+}
+
+
+HIDReportHandle HIDReportPool::acquire()
+{
+    HIDPooledReport* report = nullptr;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        if (_free.empty())
+        {
+            ++_exhaustedCount;
+            return HIDReportHandle();
+        }
+
+        report = _free.back();
+        _free.pop_back();
+    }
+
+    report->_size = 0;
+    report->reportId = 0;
+    report->timestampMicros = 0;
+    return HIDReportHandle(report);
+}
+
+
+HIDReportHandle HIDReportPool::read(HIDDevice& device, bool numberedReports)
+{
+    HIDReportHandle report = acquire();
+
+    if (!report)
+        return report;
+
+    std::streamsize result = device.read(report->data(), report->capacity());
+
+    if (result <= 0)
+        return HIDReportHandle();
+
+    report->setSize(std::size_t(result));
+    report->timestampMicros = HIDDeviceUtils::monotonicTimeMicros();
+
+    if (numberedReports)
+        report->reportId = report->data()[0];
+
+    return report;
+}
+
+
+std::size_t HIDReportPool::slabCount() const
+{
+    return _slabs.size();
+}
+
+
+std::size_t HIDReportPool::slabCapacity() const
+{
+    return _slabCapacity;
+}
+
+
+std::size_t HIDReportPool::available() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _free.size();
+}
+
+
+uint64_t HIDReportPool::exhaustedCount() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _exhaustedCount;
+}
+
+
+void HIDReportPool::_release(HIDPooledReport* report)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _free.push_back(report);
+}
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,95 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDReportRing.h"
+#include <chrono>
+
+
+namespace ofx {
+namespace IO {
+
+
+const std::size_t HIDReportRing::DEFAULT_CAPACITY = 256;
+
+
+HIDReportRing::HIDReportRing(std::size_t capacity):
+    _slots(std::max(capacity, std::size_t(1))),
+    _head(0)
+{
+}
+
+
+HIDReportRing::~HIDReportRing()
+{
+    interrupt();
+}
+
+
+void HIDReportRing::publish(std::shared_ptr<HIDReport> report)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        uint64_t sequence = _head.load(std::memory_order_relaxed);
+        report->sequence = sequence;
+        _slots[sequence % _slots.size()] = std::move(report);
+        _head.store(sequence + 1, std::memory_order_release);
+    }
+
+    _condition.notify_all();
+}
+
+
+bool HIDReportRing::read(uint64_t& cursor,
+                         SharedReport& report,
+                         uint64_t& dropped,
+                         uint64_t timeoutMillis)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (timeoutMillis > 0 && cursor >= _head.load(std::memory_order_relaxed))
+    {
+        _condition.wait_for(lock, std::chrono::milliseconds(timeoutMillis));
+    }
+
+    uint64_t head = _head.load(std::memory_order_relaxed);
+
+    if (cursor >= head)
+        return false;
+
+    // Skip anything that has already been overwritten.
+    if (head - cursor > _slots.size())
+    {
+        uint64_t oldest = head - _slots.size();
+        dropped += oldest - cursor;
+        cursor = oldest;
+    }
+
+    report = _slots[cursor % _slots.size()];
+    ++cursor;
+    return true;
+}
+
+
+void HIDReportRing::interrupt()
+{
+    _condition.notify_all();
+}
+
+
+uint64_t HIDReportRing::head() const
+{
+    return _head.load(std::memory_order_acquire);
+}
+
+
+std::size_t HIDReportRing::capacity() const
+{
+    return _slots.size();
+}
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,65 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDReportSubscriber.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+HIDReportSubscriber::HIDReportSubscriber(std::shared_ptr<HIDReportRing> ring):
+    _ring(ring),
+    _cursor(ring->head())
+{
+}
+
+
+HIDReportSubscriber::~HIDReportSubscriber()
+{
+}
+
+
+bool HIDReportSubscriber::tryRead(HIDReportRing::SharedReport& report)
+{
+    return read(report, 0);
+}
+
+
+bool HIDReportSubscriber::read(HIDReportRing::SharedReport& report,
+                               uint64_t timeoutMillis)
+{
+    if (_ring->read(_cursor, report, _dropped, timeoutMillis))
+    {
+        ++_received;
+        return true;
+    }
+
+    return false;
+}
+
+
+uint64_t HIDReportSubscriber::lag() const
+{
+    uint64_t head = _ring->head();
+    return head > _cursor ? head - _cursor : 0;
+}
+
+
+uint64_t HIDReportSubscriber::dropped() const
+{
+    return _dropped;
+}
+
+
+uint64_t HIDReportSubscriber::received() const
+{
+    return _received;
+}
+
+
+} } // namespace ofx::IO
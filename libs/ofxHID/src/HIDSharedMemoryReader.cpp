@@ -0,0 +1,234 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDSharedMemoryReader.h"
+#include "ofLog.h"
+#include <cerrno>
+
+
+#if !defined(TARGET_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace ofx {
+namespace IO {
+
+
+HIDSharedMemoryReader::HIDSharedMemoryReader()
+{
+}
+
+
+HIDSharedMemoryReader::~HIDSharedMemoryReader()
+{
+    close();
+}
+
+
+bool HIDSharedMemoryReader::open(const std::string& name)
+{
+    close();
+
+#if defined(TARGET_WIN32)
+    ofLogError("HIDSharedMemoryReader::open") << "Shared-memory export is not supported on this platform.";
+    return false;
+#else
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+
+    if (fd < 0)
+    {
+        ofLogError("HIDSharedMemoryReader::open") << "Unable to open " << name << ": " << std::strerror(errno);
+        return false;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0 || std::size_t(info.st_size) < sizeof(HIDSharedMemory::Header))
+    {
+        ofLogError("HIDSharedMemoryReader::open") << "Invalid ring: " << name;
+        ::close(fd);
+        return false;
+    }
+
+    std::size_t size = std::size_t(info.st_size);
+
+    void* memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+
+    ::close(fd);
+
+    if (memory == MAP_FAILED)
+    {
+        ofLogError("HIDSharedMemoryReader::open") << "Unable to map " << name << ": " << std::strerror(errno);
+        return false;
+    }
+
+    auto header = static_cast<const HIDSharedMemory::Header*>(memory);
+
+    bool valid = header->magic == HIDSharedMemory::MAGIC;
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (!valid
+    ||  header->version != HIDSharedMemory::VERSION
+    ||  header->slotCount == 0
+    ||  HIDSharedMemory::mappedSize(header->slotCount, header->slotSize) > size)
+    {
+        ofLogError("HIDSharedMemoryReader::open") << "Invalid ring: " << name;
+        munmap(memory, size);
+        return false;
+    }
+
+    _memory = static_cast<uint8_t*>(memory);
+    _size = size;
+    _slotStride = HIDSharedMemory::slotStride(header->slotSize);
+    _cursor = header->head.load(std::memory_order_acquire);
+    _dropped = 0;
+
+    return true;
+#endif
+}
+
+
+void HIDSharedMemoryReader::close()
+{
+#if !defined(TARGET_WIN32)
+    if (_memory)
+    {
+        munmap(_memory, _size);
+        _memory = nullptr;
+        _size = 0;
+    }
+#endif
+}
+
+
+bool HIDSharedMemoryReader::isOpen() const
+{
+    return _memory != nullptr;
+}
+
+
+bool HIDSharedMemoryReader::read(HIDReport& report)
+{
+    View view;
+
+    while (peek(view))
+    {
+        report.timestampMicros = view.timestampMicros;
+        report.data.resize(view.size);
+        std::memcpy(report.data.data(), view.data, view.size);
+
+        if (release(view))
+        {
+            report.sequence = view.sequence;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool HIDSharedMemoryReader::peek(View& view)
+{
+    if (!_memory)
+        return false;
+
+    auto header = _header();
+
+    while (true)
+    {
+        uint64_t head = header->head.load(std::memory_order_acquire);
+
+        if (_cursor >= head)
+            return false;
+
+        // Skip anything that has already been overwritten.
+        if (head - _cursor > header->slotCount)
+        {
+            uint64_t oldest = head - header->slotCount;
+            _dropped += oldest - _cursor;
+            _cursor = oldest;
+        }
+
+        std::size_t index = std::size_t(_cursor % header->slotCount);
+
+        auto slot = reinterpret_cast<const HIDSharedMemory::Slot*>(_memory + sizeof(HIDSharedMemory::Header) + index * _slotStride);
+
+        uint64_t expected = 2 * _cursor + 2;
+        uint64_t before = slot->lock.load(std::memory_order_acquire);
+
+        if (before == expected)
+        {
+            view.data = reinterpret_cast<const uint8_t*>(slot) + sizeof(HIDSharedMemory::Slot);
+            view.size = std::min(std::size_t(slot->size), std::size_t(header->slotSize));
+            view.timestampMicros = slot->timestampMicros;
+            view.sequence = _cursor;
+            return true;
+        }
+
+        // The slot was overwritten by a newer report before we read it, so
+        // this report is lost.
+        if (before > expected)
+        {
+            ++_dropped;
+            ++_cursor;
+        }
+    }
+}
+
+
+bool HIDSharedMemoryReader::release(const View& view)
+{
+    if (!_memory || view.sequence != _cursor)
+        return false;
+
+    std::size_t index = std::size_t(view.sequence % _header()->slotCount);
+
+    auto slot = reinterpret_cast<const HIDSharedMemory::Slot*>(_memory + sizeof(HIDSharedMemory::Header) + index * _slotStride);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    ++_cursor;
+
+    // The slot was overwritten while the view was in use.
+    if (slot->lock.load(std::memory_order_relaxed) != 2 * view.sequence + 2)
+    {
+        ++_dropped;
+        return false;
+    }
+
+    return true;
+}
+
+
+uint64_t HIDSharedMemoryReader::lag() const
+{
+    if (!_memory)
+        return 0;
+
+    uint64_t head = _header()->head.load(std::memory_order_acquire);
+    return head > _cursor ? head - _cursor : 0;
+}
+
+
+uint64_t HIDSharedMemoryReader::dropped() const
+{
+    return _dropped;
+}
+
+
+const HIDSharedMemory::Header* HIDSharedMemoryReader::_header() const
+{
+    return reinterpret_cast<const HIDSharedMemory::Header*>(_memory);
+}
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,211 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDSharedMemoryWriter.h"
+#include "ofLog.h"
+#include <cerrno>
+#include <new>
+
+
+#if !defined(TARGET_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+namespace ofx {
+namespace IO {
+
+
+const std::size_t HIDSharedMemoryWriter::DEFAULT_SLOT_COUNT = 1024;
+const std::size_t HIDSharedMemoryWriter::DEFAULT_SLOT_SIZE = 65;
+
+
+HIDSharedMemoryWriter::HIDSharedMemoryWriter()
+{
+}
+
+
+HIDSharedMemoryWriter::~HIDSharedMemoryWriter()
+{
+    close();
+}
+
+
+bool HIDSharedMemoryWriter::open(const std::string& name,
+                                 std::size_t slotCount,
+                                 std::size_t slotSize)
+{
+    close();
+
+#if defined(TARGET_WIN32)
+    ofLogError("HIDSharedMemoryWriter::open") << "Shared-memory export is not supported on this platform.";
+    return false;
+#else
+    if (slotCount == 0 || slotSize == 0)
+    {
+        ofLogError("HIDSharedMemoryWriter::open") << "Slot count and slot size must be greater than zero.";
+        return false;
+    }
+
+    std::size_t size = HIDSharedMemory::mappedSize(slotCount, slotSize);
+
+    // Never replace an existing ring, it may belong to a live writer.
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+
+    if (fd < 0)
+    {
+        if (errno == EEXIST)
+            ofLogError("HIDSharedMemoryWriter::open") << name << " already exists. If its writer crashed, remove it with HIDSharedMemoryWriter::unlink().";
+        else
+            ofLogError("HIDSharedMemoryWriter::open") << "Unable to create " << name << ": " << std::strerror(errno);
+
+        return false;
+    }
+
+    if (ftruncate(fd, off_t(size)) != 0)
+    {
+        ofLogError("HIDSharedMemoryWriter::open") << "Unable to size " << name << ": " << std::strerror(errno);
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    ::close(fd);
+
+    if (memory == MAP_FAILED)
+    {
+        ofLogError("HIDSharedMemoryWriter::open") << "Unable to map " << name << ": " << std::strerror(errno);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    _name = name;
+    _memory = static_cast<uint8_t*>(memory);
+    _size = size;
+    _oversized = 0;
+
+    // The mapping is zero-filled, so every slot lock starts at 0, which never
+    // matches a completed report.
+    auto header = new (_memory) HIDSharedMemory::Header;
+    header->version = HIDSharedMemory::VERSION;
+    header->slotCount = uint32_t(slotCount);
+    header->slotSize = uint32_t(slotSize);
+    header->head.store(0, std::memory_order_relaxed);
+
+    for (std::size_t i = 0; i < slotCount; ++i)
+    {
+        auto slot = new (_memory + sizeof(HIDSharedMemory::Header) + i * HIDSharedMemory::slotStride(slotSize)) HIDSharedMemory::Slot;
+        slot->lock.store(0, std::memory_order_relaxed);
+    }
+
+    // Publish the magic last so readers never see a partial header.
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = HIDSharedMemory::MAGIC;
+
+    return true;
+#endif
+}
+
+
+void HIDSharedMemoryWriter::close()
+{
+#if !defined(TARGET_WIN32)
+    if (_memory)
+    {
+        munmap(_memory, _size);
+        shm_unlink(_name.c_str());
+        _memory = nullptr;
+        _size = 0;
+    }
+#endif
+}
+
+
+bool HIDSharedMemoryWriter::isOpen() const
+{
+    return _memory != nullptr;
+}
+
+
+bool HIDSharedMemoryWriter::write(const uint8_t* data,
+                                  std::size_t size,
+                                  uint64_t timestampMicros)
+{
+    if (!_memory)
+        return false;
+
+    auto header = reinterpret_cast<HIDSharedMemory::Header*>(_memory);
+
+    uint64_t sequence = header->head.load(std::memory_order_relaxed);
+    std::size_t index = std::size_t(sequence % header->slotCount);
+
+    auto slot = reinterpret_cast<HIDSharedMemory::Slot*>(_memory + sizeof(HIDSharedMemory::Header) + index * HIDSharedMemory::slotStride(header->slotSize));
+
+    if (size > header->slotSize)
+    {
+        if (_oversized++ == 0)
+            ofLogError("HIDSharedMemoryWriter::write") << "A " << size << " byte report does not fit the " << header->slotSize << " byte slots of " << _name << ".";
+
+        return false;
+    }
+
+    slot->lock.store(2 * sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->timestampMicros = timestampMicros;
+    slot->size = uint32_t(size);
+    std::memcpy(reinterpret_cast<uint8_t*>(slot) + sizeof(HIDSharedMemory::Slot), data, size);
+
+    slot->lock.store(2 * sequence + 2, std::memory_order_release);
+    header->head.store(sequence + 1, std::memory_order_release);
+
+    return true;
+}
+
+
+std::string HIDSharedMemoryWriter::name() const
+{
+    return _name;
+}
+
+
+std::size_t HIDSharedMemoryWriter::slotSize() const
+{
+    if (!_memory)
+        return 0;
+
+    return reinterpret_cast<const HIDSharedMemory::Header*>(_memory)->slotSize;
+}
+
+
+uint64_t HIDSharedMemoryWriter::oversized() const
+{
+    return _oversized;
+}
+
+
+bool HIDSharedMemoryWriter::unlink(const std::string& name)
+{
+#if defined(TARGET_WIN32)
+    return false;
+#else
+    if (shm_unlink(name.c_str()) != 0)
+    {
+        ofLogError("HIDSharedMemoryWriter::unlink") << "Unable to remove " << name << ": " << std::strerror(errno);
+        return false;
+    }
+
+    return true;
+#endif
+}
+
+
+} } // namespace ofx::IO
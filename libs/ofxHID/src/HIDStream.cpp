@@ -0,0 +1,38 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDStream.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+HIDStream::HIDStream(HIDDevice& device,
+                     std::size_t reportSize,
+                     HIDStreamBuffer::Framing framing,
+                     uint8_t reportId):
+    std::iostream(nullptr),
+    _buffer(device, reportSize, framing, reportId)
+{
+    // The buffer is constructed after the base, so attach it here.
+    rdbuf(&_buffer);
+}
+
+
+HIDStream::~HIDStream()
+{
+}
+
+
+HIDStreamBuffer& HIDStream::buffer()
+{
+    return _buffer;
+}
+
+
+} } // namespace ofx::IO
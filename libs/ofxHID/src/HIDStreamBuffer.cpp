@@ -0,0 +1,261 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDStreamBuffer.h"
+#include "ofx/IO/HIDDeviceUtils.h"
+#include <cstring>
+
+
+namespace ofx {
+namespace IO {
+
+
+const std::size_t HIDStreamBuffer::DEFAULT_REPORT_SIZE = 64;
+const uint64_t HIDStreamBuffer::DEFAULT_FLUSH_LATENCY_MICROS = 2000;
+const uint64_t HIDStreamBuffer::MAX_RETRY_MICROS = 100000;
+
+
+HIDStreamBuffer::HIDStreamBuffer(HIDDevice& device,
+                                 std::size_t reportSize,
+                                 Framing framing,
+                                 uint8_t reportId):
+    _device(device),
+    _reportSize(std::max(reportSize, std::size_t(2))),
+    _framing(framing),
+    _reportId(reportId)
+{
+    // A one byte length prefix can describe at most 255 payload bytes.
+    _payloadSize = (_framing == Framing::LENGTH_PREFIXED) ? std::min(_reportSize - 1, std::size_t(255)) : _reportSize;
+    _output.resize(_reportSize);
+
+    // Without a put area every write goes through xsputn() or overflow(),
+    // which lock against the flusher thread.
+    setp(nullptr, nullptr);
+    setg(nullptr, nullptr, nullptr);
+
+    setFlushLatencyMicros(DEFAULT_FLUSH_LATENCY_MICROS);
+}
+
+
+HIDStreamBuffer::~HIDStreamBuffer()
+{
+    setFlushLatencyMicros(0);
+    sync();
+}
+
+
+void HIDStreamBuffer::setFlushLatencyMicros(uint64_t latencyMicros)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _flushLatencyMicros = latencyMicros;
+        _running = false;
+    }
+
+    _condition.notify_all();
+
+    if (_thread.joinable())
+        _thread.join();
+
+    if (latencyMicros > 0)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _running = true;
+        _thread = std::thread(&HIDStreamBuffer::_run, this);
+    }
+}
+
+
+uint64_t HIDStreamBuffer::getFlushLatencyMicros() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _flushLatencyMicros;
+}
+
+
+uint64_t HIDStreamBuffer::reportsWritten() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _reportsWritten;
+}
+
+
+uint64_t HIDStreamBuffer::bytesWritten() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _bytesWritten;
+}
+
+
+uint64_t HIDStreamBuffer::reportsRead() const
+{
+    return _reportsRead;
+}
+
+
+uint64_t HIDStreamBuffer::writeErrors() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _writeErrors;
+}
+
+
+std::streamsize HIDStreamBuffer::xsputn(const char_type* s, std::streamsize count)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    std::size_t offset = (_framing == Framing::LENGTH_PREFIXED) ? 1 : 0;
+    std::streamsize written = 0;
+
+    while (written < count)
+    {
+        if (_outputSize == 0)
+        {
+            _outputMicros = HIDDeviceUtils::monotonicTimeMicros();
+
+            // Wake the flusher so it waits for this report's deadline.
+            _condition.notify_all();
+        }
+
+        std::size_t n = std::min(_payloadSize - _outputSize, std::size_t(count - written));
+        std::memcpy(_output.data() + offset + _outputSize, s + written, n);
+        _outputSize += n;
+        written += n;
+
+        if (_outputSize == _payloadSize && !_send())
+            break;
+    }
+
+    return written;
+}
+
+
+HIDStreamBuffer::int_type HIDStreamBuffer::overflow(int_type ch)
+{
+    if (traits_type::eq_int_type(ch, traits_type::eof()))
+        return sync() == 0 ? traits_type::not_eof(ch) : traits_type::eof();
+
+    char_type c = traits_type::to_char_type(ch);
+    return xsputn(&c, 1) == 1 ? ch : traits_type::eof();
+}
+
+
+int HIDStreamBuffer::sync()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return (_outputSize == 0 || _send()) ? 0 : -1;
+}
+
+
+HIDStreamBuffer::int_type HIDStreamBuffer::underflow()
+{
+    if (gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+
+    std::size_t offset = (_reportId == 0x00) ? 0 : 1;
+
+    while (true)
+    {
+        std::streamsize result = _device.read(_input, offset + _reportSize);
+
+        if (result <= std::streamsize(offset))
+            return traits_type::eof();
+
+        ++_reportsRead;
+
+        char* begin = reinterpret_cast<char*>(_input.data()) + offset;
+        char* end = reinterpret_cast<char*>(_input.data()) + result;
+
+        if (_framing == Framing::LENGTH_PREFIXED)
+        {
+            std::size_t length = std::min(std::size_t(uint8_t(*begin)), std::size_t(end - begin - 1));
+            ++begin;
+            end = begin + length;
+        }
+
+        if (begin < end)
+        {
+            setg(begin, begin, end);
+            return traits_type::to_int_type(*gptr());
+        }
+    }
+}
+
+
+bool HIDStreamBuffer::_send()
+{
+    std::size_t offset = 0;
+
+    if (_framing == Framing::LENGTH_PREFIXED)
+    {
+        _output[0] = uint8_t(_outputSize);
+        offset = 1;
+    }
+
+    // Clear stale bytes past the payload.
+    std::fill(_output.begin() + offset + _outputSize, _output.end(), 0);
+
+    // Bypass the output report cache, which could skip repeated chunks.
+    std::streamsize result = _device.write(_reportId, _output);
+
+    if (result < 0)
+    {
+        ++_writeErrors;
+
+        if (_consecutiveErrors++ == 0)
+            ofLogError("HIDStreamBuffer::_send") << "Write failed.";
+
+        return false;
+    }
+
+    _consecutiveErrors = 0;
+    _retryMicros = 0;
+    ++_reportsWritten;
+    _bytesWritten += _outputSize;
+    _outputSize = 0;
+    return true;
+}
+
+
+void HIDStreamBuffer::_run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (_running)
+    {
+        if (_outputSize == 0)
+        {
+            _condition.wait(lock);
+            continue;
+        }
+
+        uint64_t deadline = _outputMicros + _flushLatencyMicros;
+
+        if (_retryMicros > 0)
+            deadline = std::max(deadline, _retryAtMicros);
+
+        uint64_t now = HIDDeviceUtils::monotonicTimeMicros();
+
+        if (now >= deadline)
+        {
+            // Back off instead of spinning on the mutex while the device
+            // refuses writes.
+            if (!_send())
+            {
+                _retryMicros = std::min(std::max(2 * _retryMicros, _flushLatencyMicros), MAX_RETRY_MICROS);
+                _retryAtMicros = now + _retryMicros;
+            }
+        }
+        else
+        {
+            _condition.wait_for(lock, std::chrono::microseconds(deadline - now));
+        }
+    }
+}
+
+
+} } // namespace ofx::IO
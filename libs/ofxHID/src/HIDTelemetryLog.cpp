@@ -0,0 +1,245 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDTelemetryLog.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+
+namespace ofx {
+namespace IO {
+
+
+namespace HIDTelemetryLog {
+
+
+namespace {
+
+
+/// \brief A canonical Huffman code.
+struct CanonicalCode
+{
+    /// \brief The code of each byte value.
+    std::array<uint16_t, 256> codes;
+
+    /// \brief The byte values ordered by code length, then value.
+    std::vector<uint8_t> symbols;
+
+    /// \brief The number of codes of each length.
+    std::array<uint16_t, MAX_CODE_LENGTH + 1> counts;
+};
+
+
+/// \brief Assign canonical codes to code lengths.
+/// \returns false if the lengths do not form a prefix code.
+bool makeCanonicalCode(const CodeLengths& lengths, CanonicalCode& code)
+{
+    code.codes.fill(0);
+    code.counts.fill(0);
+    code.symbols.clear();
+
+    for (std::size_t length = 1; length <= MAX_CODE_LENGTH; ++length)
+    {
+        for (std::size_t symbol = 0; symbol < lengths.size(); ++symbol)
+        {
+            if (lengths[symbol] == length)
+            {
+                code.symbols.push_back(uint8_t(symbol));
+                ++code.counts[length];
+            }
+        }
+    }
+
+    // Check the Kraft inequality, so decoding never runs past the tables.
+    uint32_t kraft = 0;
+
+    for (std::size_t length = 1; length <= MAX_CODE_LENGTH; ++length)
+        kraft += uint32_t(code.counts[length]) << (MAX_CODE_LENGTH - length);
+
+    if (kraft > (1u << MAX_CODE_LENGTH))
+        return false;
+
+    uint16_t next = 0;
+    std::size_t length = 0;
+
+    for (uint8_t symbol: code.symbols)
+    {
+        next <<= (lengths[symbol] - length);
+        length = lengths[symbol];
+        code.codes[symbol] = next++;
+    }
+
+    return true;
+}
+
+
+}
+
+
+void buildCodeLengths(const std::array<uint64_t, 256>& counts,
+                      CodeLengths& lengths)
+{
+    lengths.fill(0);
+
+    std::array<uint64_t, 256> weights = counts;
+
+    while (true)
+    {
+        // Leaves are nodes 0-255, internal nodes follow.
+        std::vector<int> parents(256, -1);
+
+        typedef std::pair<uint64_t, int> Entry;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+
+        for (std::size_t symbol = 0; symbol < weights.size(); ++symbol)
+        {
+            if (weights[symbol] > 0)
+                queue.push(Entry(weights[symbol], int(symbol)));
+        }
+
+        if (queue.empty())
+            return;
+
+        if (queue.size() == 1)
+        {
+            lengths[queue.top().second] = 1;
+            return;
+        }
+
+        while (queue.size() > 1)
+        {
+            Entry a = queue.top();
+            queue.pop();
+            Entry b = queue.top();
+            queue.pop();
+
+            int parent = int(parents.size());
+            parents.push_back(-1);
+            parents[a.second] = parent;
+            parents[b.second] = parent;
+            queue.push(Entry(a.first + b.first, parent));
+        }
+
+        std::size_t longest = 0;
+
+        for (std::size_t symbol = 0; symbol < weights.size(); ++symbol)
+        {
+            if (weights[symbol] == 0)
+                continue;
+
+            std::size_t depth = 0;
+
+            for (int node = int(symbol); parents[node] != -1; node = parents[node])
+                ++depth;
+
+            lengths[symbol] = uint8_t(std::min(depth, std::size_t(255)));
+            longest = std::max(longest, depth);
+        }
+
+        if (longest <= MAX_CODE_LENGTH)
+            return;
+
+        // Flatten the distribution and try again. Weights never reach zero,
+        // and equal weights give a code no longer than 8 bits.
+        for (auto& weight: weights)
+        {
+            if (weight > 0)
+                weight = (weight + 1) / 2;
+        }
+
+        lengths.fill(0);
+    }
+}
+
+
+void huffmanEncode(const uint8_t* data,
+                   std::size_t size,
+                   const CodeLengths& lengths,
+                   std::vector<uint8_t>& output)
+{
+    CanonicalCode code;
+    makeCanonicalCode(lengths, code);
+
+    uint32_t bits = 0;
+    std::size_t bitCount = 0;
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        bits = (bits << lengths[data[i]]) | code.codes[data[i]];
+        bitCount += lengths[data[i]];
+
+        while (bitCount >= 8)
+        {
+            bitCount -= 8;
+            output.push_back(uint8_t(bits >> bitCount));
+        }
+
+        bits &= (1u << bitCount) - 1;
+    }
+
+    if (bitCount > 0)
+        output.push_back(uint8_t(bits << (8 - bitCount)));
+}
+
+
+bool huffmanDecode(const uint8_t* data,
+                   std::size_t size,
+                   const CodeLengths& lengths,
+                   std::size_t count,
+                   std::vector<uint8_t>& output)
+{
+    CanonicalCode code;
+
+    if (!makeCanonicalCode(lengths, code))
+        return false;
+
+    output.resize(count);
+
+    std::size_t bit = 0;
+    std::size_t totalBits = size * 8;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        // Walk the canonical code one bit at a time. Codes of each length
+        // are consecutive, starting where the shorter codes left off.
+        uint32_t value = 0;
+        uint32_t first = 0;
+        std::size_t index = 0;
+        bool found = false;
+
+        for (std::size_t length = 1; length <= MAX_CODE_LENGTH; ++length)
+        {
+            if (bit >= totalBits)
+                return false;
+
+            value = (value << 1) | ((data[bit / 8] >> (7 - bit % 8)) & 1);
+            ++bit;
+
+            if (value - first < code.counts[length])
+            {
+                output[i] = code.symbols[index + value - first];
+                found = true;
+                break;
+            }
+
+            index += code.counts[length];
+            first = (first + code.counts[length]) << 1;
+        }
+
+        if (!found)
+            return false;
+    }
+
+    return true;
+}
+
+
+} // namespace HIDTelemetryLog
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,328 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDTelemetryReader.h"
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+namespace {
+
+
+/// \returns true if a stream starts with the given file header.
+bool readHeader(std::istream& stream, uint32_t magic)
+{
+    uint64_t fileMagic = 0;
+    uint64_t version = 0;
+
+    return HIDTelemetryLog::getFixed(stream, fileMagic, 4)
+        && HIDTelemetryLog::getFixed(stream, version, 4)
+        && fileMagic == magic
+        && version == HIDTelemetryLog::VERSION;
+}
+
+
+}
+
+
+HIDTelemetryReader::HIDTelemetryReader()
+{
+}
+
+
+HIDTelemetryReader::~HIDTelemetryReader()
+{
+    close();
+}
+
+
+bool HIDTelemetryReader::open(const std::string& path,
+                              const std::string& indexPath)
+{
+    close();
+
+    _log.open(path, std::ios::binary);
+
+    if (!_log || !readHeader(_log, HIDTelemetryLog::MAGIC))
+    {
+        ofLogError("HIDTelemetryReader::open") << "Invalid log: " << path;
+        close();
+        return false;
+    }
+
+    if (!indexPath.empty())
+    {
+        std::ifstream index(indexPath, std::ios::binary);
+
+        if (!index || !readHeader(index, HIDTelemetryLog::INDEX_MAGIC))
+        {
+            ofLogWarning("HIDTelemetryReader::open") << "Ignoring invalid index: " << indexPath;
+        }
+        else
+        {
+            HIDTelemetryLog::IndexEntry entry;
+
+            while (HIDTelemetryLog::getFixed(index, entry.timestampMicros, 8)
+               &&  HIDTelemetryLog::getFixed(index, entry.offset, 8)
+               &&  HIDTelemetryLog::getFixed(index, entry.sequence, 8))
+            {
+                _index.push_back(entry);
+            }
+        }
+    }
+
+    _reset(HIDTelemetryLog::HEADER_SIZE, 0);
+    return true;
+}
+
+
+void HIDTelemetryReader::close()
+{
+    if (_log.is_open())
+        _log.close();
+
+    _index.clear();
+    _hasPending = false;
+}
+
+
+bool HIDTelemetryReader::isOpen() const
+{
+    return _log.is_open();
+}
+
+
+bool HIDTelemetryReader::read(HIDReport& report)
+{
+    if (_hasPending)
+    {
+        report = std::move(_pending);
+        _hasPending = false;
+        return true;
+    }
+
+    return _readRecord(report);
+}
+
+
+bool HIDTelemetryReader::seek(uint64_t timestampMicros)
+{
+    if (!isOpen())
+        return false;
+
+    uint64_t offset = HIDTelemetryLog::HEADER_SIZE;
+    uint64_t sequence = 0;
+
+    // Start from the last keyframe at or before the target.
+    auto iter = std::upper_bound(_index.begin(),
+                                 _index.end(),
+                                 timestampMicros,
+                                 [](uint64_t t, const HIDTelemetryLog::IndexEntry& entry) {
+                                     return t < entry.timestampMicros;
+                                 });
+
+    if (iter != _index.begin())
+    {
+        offset = std::prev(iter)->offset;
+        sequence = std::prev(iter)->sequence;
+    }
+
+    _reset(offset, sequence);
+
+    while (_readRecord(_pending))
+    {
+        if (_pending.timestampMicros >= timestampMicros)
+        {
+            _hasPending = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+const std::vector<HIDTelemetryLog::IndexEntry>& HIDTelemetryReader::index() const
+{
+    return _index;
+}
+
+
+bool HIDTelemetryReader::_readRecord(HIDReport& report)
+{
+    if (_block.peek() == std::char_traits<char>::eof() && !_readBlock())
+        return false;
+
+    int flags = _block.get();
+    int reportId = _block.get();
+
+    uint64_t timestamp = 0;
+    uint64_t size = 0;
+
+    if (reportId == std::char_traits<char>::eof()
+    || !HIDTelemetryLog::getVarint(_block, timestamp)
+    || !HIDTelemetryLog::getVarint(_block, size))
+    {
+        ofLogError("HIDTelemetryReader::read") << "Truncated record.";
+        return false;
+    }
+
+    std::vector<uint8_t>& previous = _previous[reportId];
+
+    if (flags & HIDTelemetryLog::RAW)
+    {
+        previous.resize(size);
+
+        if (size > 0 && !_block.read(reinterpret_cast<char*>(previous.data()), size))
+            return false;
+    }
+    else
+    {
+        if (previous.size() != size)
+        {
+            ofLogError("HIDTelemetryReader::read") << "Delta record without a matching previous report.";
+            return false;
+        }
+
+        uint64_t i = 0;
+
+        while (i < size)
+        {
+            uint64_t zeros = 0;
+            uint64_t literals = 0;
+
+            if (!HIDTelemetryLog::getVarint(_block, zeros)
+            ||  !HIDTelemetryLog::getVarint(_block, literals)
+            ||  i + zeros + literals > size)
+            {
+                ofLogError("HIDTelemetryReader::read") << "Corrupt delta record.";
+                return false;
+            }
+
+            i += zeros;
+
+            for (uint64_t j = 0; j < literals; ++j)
+            {
+                int byte = _block.get();
+
+                if (byte == std::char_traits<char>::eof())
+                    return false;
+
+                previous[i + j] ^= uint8_t(byte);
+            }
+
+            i += literals;
+        }
+    }
+
+    _lastTimestampMicros = (flags & HIDTelemetryLog::KEYFRAME) ? timestamp : _lastTimestampMicros + timestamp;
+
+    report.data = previous;
+    report.timestampMicros = _lastTimestampMicros;
+    report.sequence = _sequence++;
+
+    return true;
+}
+
+
+bool HIDTelemetryReader::_readBlock()
+{
+    int coding = _log.get();
+
+    if (coding == std::char_traits<char>::eof())
+        return false;
+
+    uint64_t recordCount = 0;
+    uint64_t recordBytes = 0;
+
+    if (!HIDTelemetryLog::getVarint(_log, recordCount)
+    ||  !HIDTelemetryLog::getVarint(_log, recordBytes))
+    {
+        ofLogError("HIDTelemetryReader::read") << "Truncated block.";
+        return false;
+    }
+
+    HIDTelemetryLog::CodeLengths lengths;
+
+    if (coding == int(HIDTelemetryLog::Coding::HUFFMAN))
+    {
+        uint8_t packed[128];
+
+        if (!_log.read(reinterpret_cast<char*>(packed), sizeof(packed)))
+        {
+            ofLogError("HIDTelemetryReader::read") << "Truncated block.";
+            return false;
+        }
+
+        for (std::size_t i = 0; i < sizeof(packed); ++i)
+        {
+            lengths[2 * i] = packed[i] & 0x0F;
+            lengths[2 * i + 1] = packed[i] >> 4;
+        }
+    }
+    else if (coding != int(HIDTelemetryLog::Coding::STORED))
+    {
+        ofLogError("HIDTelemetryReader::read") << "Unknown block coding " << coding << ".";
+        return false;
+    }
+
+    uint64_t payloadSize = 0;
+
+    if (!HIDTelemetryLog::getVarint(_log, payloadSize))
+    {
+        ofLogError("HIDTelemetryReader::read") << "Truncated block.";
+        return false;
+    }
+
+    _coded.resize(std::size_t(payloadSize));
+
+    if (payloadSize > 0 && !_log.read(reinterpret_cast<char*>(_coded.data()), std::streamsize(payloadSize)))
+    {
+        ofLogError("HIDTelemetryReader::read") << "Truncated block.";
+        return false;
+    }
+
+    if (coding == int(HIDTelemetryLog::Coding::HUFFMAN))
+    {
+        if (!HIDTelemetryLog::huffmanDecode(_coded.data(), _coded.size(), lengths, std::size_t(recordBytes), _records))
+        {
+            ofLogError("HIDTelemetryReader::read") << "Corrupt block.";
+            return false;
+        }
+    }
+    else
+    {
+        _records.swap(_coded);
+    }
+
+    _block.clear();
+    _block.str(std::string(_records.begin(), _records.end()));
+    return recordCount > 0;
+}
+
+
+void HIDTelemetryReader::_reset(uint64_t offset, uint64_t sequence)
+{
+    _log.clear();
+    _log.seekg(std::streamoff(offset));
+
+    _block.clear();
+    _block.str(std::string());
+
+    for (auto& previous: _previous)
+        previous.clear();
+
+    _lastTimestampMicros = 0;
+    _sequence = sequence;
+    _hasPending = false;
+}
+
+
+} } // namespace ofx::IO
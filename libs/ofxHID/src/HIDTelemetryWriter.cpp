@@ -0,0 +1,328 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDTelemetryWriter.h"
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+const std::size_t HIDTelemetryWriter::DEFAULT_KEYFRAME_INTERVAL = 1000;
+
+
+HIDTelemetryWriter::HIDTelemetryWriter()
+{
+    _hasPrevious.fill(false);
+}
+
+
+HIDTelemetryWriter::~HIDTelemetryWriter()
+{
+    close();
+}
+
+
+bool HIDTelemetryWriter::open(const std::string& path,
+                              const std::string& indexPath,
+                              std::size_t keyframeInterval,
+                              bool numberedReports)
+{
+    close();
+
+    _log.open(path, std::ios::binary | std::ios::trunc);
+    _index.open(indexPath, std::ios::binary | std::ios::trunc);
+
+    if (!_log || !_index)
+    {
+        ofLogError("HIDTelemetryWriter::open") << "Unable to create " << path << " and " << indexPath;
+        close();
+        return false;
+    }
+
+    _keyframeInterval = std::max(keyframeInterval, std::size_t(1));
+    _numberedReports = numberedReports;
+    _sinceKeyframe = _keyframeInterval;
+    _lastTimestampMicros = 0;
+    _reportsWritten = 0;
+    _rawBytes = 0;
+    _clampedTimestamps = 0;
+    _hasPrevious.fill(false);
+    _block.clear();
+
+    std::vector<uint8_t> header;
+    HIDTelemetryLog::putFixed(header, HIDTelemetryLog::MAGIC, 4);
+    HIDTelemetryLog::putFixed(header, HIDTelemetryLog::VERSION, 4);
+    _log.write(reinterpret_cast<const char*>(header.data()), header.size());
+    _encodedBytes = header.size();
+
+    header.clear();
+    HIDTelemetryLog::putFixed(header, HIDTelemetryLog::INDEX_MAGIC, 4);
+    HIDTelemetryLog::putFixed(header, HIDTelemetryLog::VERSION, 4);
+    _index.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+    return true;
+}
+
+
+void HIDTelemetryWriter::close()
+{
+    if (_log.is_open())
+    {
+        _writeBlock();
+        _log.close();
+    }
+
+    if (_index.is_open())
+        _index.close();
+}
+
+
+bool HIDTelemetryWriter::isOpen() const
+{
+    return _log.is_open();
+}
+
+
+bool HIDTelemetryWriter::write(const uint8_t* data,
+                               std::size_t size,
+                               uint64_t timestampMicros)
+{
+    if (!isOpen())
+    {
+        ofLogError("HIDTelemetryWriter::write") << "The log is not open.";
+        return false;
+    }
+
+    // Timestamps are delta coded and the index is searched by timestamp, so
+    // they must never decrease.
+    if (_reportsWritten > 0 && timestampMicros < _lastTimestampMicros)
+    {
+        if (_clampedTimestamps++ == 0)
+            ofLogWarning("HIDTelemetryWriter::write") << "Clamping a timestamp that went back " << (_lastTimestampMicros - timestampMicros) << " us.";
+
+        timestampMicros = _lastTimestampMicros;
+    }
+
+    if (_sinceKeyframe >= _keyframeInterval)
+    {
+        if (!_writeBlock())
+            return false;
+
+        _startKeyframe(timestampMicros);
+    }
+
+    uint8_t reportId = (_numberedReports && size > 0) ? data[0] : 0x00;
+
+    std::vector<uint8_t>& previous = _previous[reportId];
+
+    uint8_t flags = 0;
+
+    if (_sinceKeyframe == 0)
+        flags |= HIDTelemetryLog::KEYFRAME;
+
+    if (!_hasPrevious[reportId] || previous.size() != size)
+        flags |= HIDTelemetryLog::RAW;
+
+    _block.push_back(flags);
+    _block.push_back(reportId);
+    HIDTelemetryLog::putVarint(_block, (flags & HIDTelemetryLog::KEYFRAME) ? timestampMicros : timestampMicros - _lastTimestampMicros);
+    HIDTelemetryLog::putVarint(_block, size);
+
+    if (flags & HIDTelemetryLog::RAW)
+    {
+        _block.insert(_block.end(), data, data + size);
+        previous.assign(data, data + size);
+        _hasPrevious[reportId] = true;
+    }
+    else
+    {
+        std::size_t i = 0;
+
+        while (i < size)
+        {
+            std::size_t zeros = 0;
+
+            while (i + zeros < size && data[i + zeros] == previous[i + zeros])
+                ++zeros;
+
+            i += zeros;
+
+            // Literals end at the next run of two unchanged bytes, since a
+            // single unchanged byte is cheaper to code as a literal.
+            std::size_t literals = 0;
+
+            while (i + literals < size
+               && !(data[i + literals] == previous[i + literals]
+                    && (i + literals + 1 >= size || data[i + literals + 1] == previous[i + literals + 1])))
+            {
+                ++literals;
+            }
+
+            HIDTelemetryLog::putVarint(_block, zeros);
+            HIDTelemetryLog::putVarint(_block, literals);
+
+            for (std::size_t j = 0; j < literals; ++j)
+            {
+                _block.push_back(data[i + j] ^ previous[i + j]);
+                previous[i + j] = data[i + j];
+            }
+
+            i += literals;
+        }
+    }
+
+    _rawBytes += size;
+    _lastTimestampMicros = timestampMicros;
+    ++_sinceKeyframe;
+    ++_reportsWritten;
+
+    return true;
+}
+
+
+bool HIDTelemetryWriter::write(const HIDReport& report)
+{
+    return write(report.data.data(), report.data.size(), report.timestampMicros);
+}
+
+
+std::size_t HIDTelemetryWriter::write(HIDReportSubscriber& subscriber)
+{
+    std::size_t count = 0;
+
+    HIDReportRing::SharedReport report;
+
+    while (subscriber.tryRead(report))
+    {
+        if (write(*report))
+            ++count;
+    }
+
+    return count;
+}
+
+
+void HIDTelemetryWriter::flush()
+{
+    if (!isOpen())
+        return;
+
+    // Start a new block with the next report, so everything written so far
+    // can be decoded.
+    if (_writeBlock())
+        _sinceKeyframe = _keyframeInterval;
+
+    _log.flush();
+    _index.flush();
+}
+
+
+uint64_t HIDTelemetryWriter::reportsWritten() const
+{
+    return _reportsWritten;
+}
+
+
+uint64_t HIDTelemetryWriter::rawBytes() const
+{
+    return _rawBytes;
+}
+
+
+uint64_t HIDTelemetryWriter::encodedBytes() const
+{
+    return _encodedBytes;
+}
+
+
+uint64_t HIDTelemetryWriter::clampedTimestamps() const
+{
+    return _clampedTimestamps;
+}
+
+
+double HIDTelemetryWriter::compressionRatio() const
+{
+    if (_encodedBytes == 0)
+        return 0;
+
+    return double(_rawBytes) / _encodedBytes;
+}
+
+
+void HIDTelemetryWriter::_startKeyframe(uint64_t timestampMicros)
+{
+    _hasPrevious.fill(false);
+    _sinceKeyframe = 0;
+
+    std::vector<uint8_t> entry;
+    HIDTelemetryLog::putFixed(entry, timestampMicros, 8);
+    HIDTelemetryLog::putFixed(entry, _encodedBytes, 8);
+    HIDTelemetryLog::putFixed(entry, _reportsWritten, 8);
+    _index.write(reinterpret_cast<const char*>(entry.data()), entry.size());
+}
+
+
+bool HIDTelemetryWriter::_writeBlock()
+{
+    if (_block.empty())
+        return true;
+
+    std::array<uint64_t, 256> counts;
+    counts.fill(0);
+
+    for (uint8_t byte: _block)
+        ++counts[byte];
+
+    HIDTelemetryLog::CodeLengths lengths;
+    HIDTelemetryLog::buildCodeLengths(counts, lengths);
+
+    uint64_t codedBits = 0;
+
+    for (std::size_t symbol = 0; symbol < counts.size(); ++symbol)
+        codedBits += counts[symbol] * lengths[symbol];
+
+    // Small or incompressible blocks are cheaper to store.
+    bool huffman = (codedBits + 7) / 8 + lengths.size() / 2 < _block.size();
+
+    _coded.clear();
+    _coded.push_back(uint8_t(huffman ? HIDTelemetryLog::Coding::HUFFMAN : HIDTelemetryLog::Coding::STORED));
+    HIDTelemetryLog::putVarint(_coded, _sinceKeyframe);
+    HIDTelemetryLog::putVarint(_coded, _block.size());
+
+    if (huffman)
+    {
+        for (std::size_t symbol = 0; symbol < lengths.size(); symbol += 2)
+            _coded.push_back(uint8_t(lengths[symbol] | (lengths[symbol + 1] << 4)));
+
+        HIDTelemetryLog::putVarint(_coded, (codedBits + 7) / 8);
+        HIDTelemetryLog::huffmanEncode(_block.data(), _block.size(), lengths, _coded);
+    }
+    else
+    {
+        HIDTelemetryLog::putVarint(_coded, _block.size());
+        _coded.insert(_coded.end(), _block.begin(), _block.end());
+    }
+
+    _block.clear();
+
+    _log.write(reinterpret_cast<const char*>(_coded.data()), _coded.size());
+
+    if (!_log)
+    {
+        ofLogError("HIDTelemetryWriter::write") << "Write failed.";
+        return false;
+    }
+
+    _encodedBytes += _coded.size();
+    return true;
+}
+
+
+} } // namespace ofx::IO
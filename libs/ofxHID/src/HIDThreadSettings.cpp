@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDThreadSettings.h"
+#include "ofLog.h"
+#include <cerrno>
+
+
+#if !defined(TARGET_WIN32)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+
+namespace ofx {
+namespace IO {
+
+
+bool HIDThreadSettings::applyToCurrentThread() const
+{
+    bool success = true;
+
+#if defined(TARGET_WIN32)
+    if (schedulingPolicy != SchedulingPolicy::DEFAULT
+    ||  !cpuAffinity.empty()
+    ||  lockMemory)
+    {
+        ofLogWarning("HIDThreadSettings::applyToCurrentThread") << "Thread settings are not supported on this platform.";
+        success = false;
+    }
+#else
+    if (schedulingPolicy != SchedulingPolicy::DEFAULT)
+    {
+        int policy = (schedulingPolicy == SchedulingPolicy::FIFO) ? SCHED_FIFO : SCHED_RR;
+
+        sched_param parameters;
+        parameters.sched_priority = std::max(sched_get_priority_min(policy),
+                                             std::min(priority, sched_get_priority_max(policy)));
+
+        int result = pthread_setschedparam(pthread_self(), policy, &parameters);
+
+        if (result != 0)
+        {
+            ofLogError("HIDThreadSettings::applyToCurrentThread") << "Unable to set scheduling policy: " << std::strerror(result);
+            success = false;
+        }
+    }
+
+    if (!cpuAffinity.empty())
+    {
+#if defined(TARGET_LINUX)
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+
+        for (auto cpu: cpuAffinity)
+        {
+            if (cpu >= 0 && cpu < CPU_SETSIZE)
+                CPU_SET(cpu, &cpus);
+        }
+
+        int result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+
+        if (result != 0)
+        {
+            ofLogError("HIDThreadSettings::applyToCurrentThread") << "Unable to set CPU affinity: " << std::strerror(result);
+            success = false;
+        }
+#else
+        ofLogWarning("HIDThreadSettings::applyToCurrentThread") << "CPU affinity is not supported on this platform.";
+        success = false;
+#endif
+    }
+
+    if (lockMemory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        ofLogError("HIDThreadSettings::applyToCurrentThread") << "Unable to lock memory: " << std::strerror(errno);
+        success = false;
+    }
+#endif
+
+    return success;
+}
+
+
+} } // namespace ofx::IO
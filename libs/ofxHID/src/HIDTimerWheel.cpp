@@ -0,0 +1,122 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDTimerWheel.h"
+#include "ofx/IO/HIDDeviceUtils.h"
+
+
+namespace ofx {
+namespace IO {
+
+
+const uint64_t HIDTimerWheel::DEFAULT_TICK_MICROS = 1000;
+const std::size_t HIDTimerWheel::DEFAULT_SLOT_COUNT = 1024;
+
+
+HIDTimerWheel::HIDTimerWheel(uint64_t tickMicros, std::size_t slotCount):
+    _slots(std::max(slotCount, std::size_t(1))),
+    _tickMicros(std::max(tickMicros, uint64_t(1))),
+    _currentTick(HIDDeviceUtils::monotonicTimeMicros() / _tickMicros)
+{
+}
+
+
+HIDTimerWheel::~HIDTimerWheel()
+{
+}
+
+
+void HIDTimerWheel::schedule(uint64_t id, uint64_t deadlineMicros)
+{
+    cancel(id);
+
+    // Round up so that a timer never expires before its deadline.
+    uint64_t tick = (deadlineMicros + _tickMicros - 1) / _tickMicros;
+    tick = std::max(tick, _currentTick + 1);
+
+    std::size_t slot = tick % _slots.size();
+
+    Timer timer;
+    timer.id = id;
+    timer.tick = tick;
+
+    Location location;
+    location.slot = slot;
+    location.timer = _slots[slot].insert(_slots[slot].end(), timer);
+
+    _timers[id] = location;
+}
+
+
+bool HIDTimerWheel::cancel(uint64_t id)
+{
+    auto iter = _timers.find(id);
+
+    if (iter == _timers.end())
+        return false;
+
+    _slots[iter->second.slot].erase(iter->second.timer);
+    _timers.erase(iter);
+    return true;
+}
+
+
+std::size_t HIDTimerWheel::advance(uint64_t nowMicros,
+                                   std::vector<uint64_t>& expired)
+{
+    uint64_t targetTick = nowMicros / _tickMicros;
+
+    if (targetTick <= _currentTick)
+        return 0;
+
+    // After a long gap every slot is visited once rather than once per tick.
+    uint64_t ticks = std::min(targetTick - _currentTick, uint64_t(_slots.size()));
+
+    std::size_t count = 0;
+
+    for (uint64_t i = 1; i <= ticks; ++i)
+    {
+        std::size_t slot = (_currentTick + i) % _slots.size();
+        auto& timers = _slots[slot];
+
+        auto iter = timers.begin();
+
+        while (iter != timers.end())
+        {
+            // Timers more than one revolution away stay in the slot.
+            if (iter->tick <= targetTick)
+            {
+                expired.push_back(iter->id);
+                _timers.erase(iter->id);
+                iter = timers.erase(iter);
+                ++count;
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+    }
+
+    _currentTick = targetTick;
+    return count;
+}
+
+
+std::size_t HIDTimerWheel::size() const
+{
+    return _timers.size();
+}
+
+
+uint64_t HIDTimerWheel::tickMicros() const
+{
+    return _tickMicros;
+}
+
+
+} } // namespace ofx::IO
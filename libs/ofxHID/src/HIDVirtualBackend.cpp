@@ -0,0 +1,339 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDVirtualBackend.h"
+#include <algorithm>
+#include <cstring>
+
+
+namespace ofx {
+namespace IO {
+
+
+namespace {
+
+
+/// \brief Decode UTF-8 into a platform wide string.
+///
+/// Invalid sequences become U+FFFD. Where wchar_t is 16 bits, code points
+/// above U+FFFF become surrogate pairs, as hidapi returns them on Windows.
+std::wstring toWideString(const std::string& input)
+{
+    std::wstring output;
+
+    std::size_t i = 0;
+
+    while (i < input.size())
+    {
+        uint8_t lead = uint8_t(input[i]);
+        uint32_t codePoint = 0xFFFD;
+        std::size_t length = 1;
+
+        if (lead < 0x80)
+        {
+            codePoint = lead;
+        }
+        else
+        {
+            std::size_t extra = 0;
+            uint32_t minimum = 0;
+
+            if ((lead & 0xE0) == 0xC0) { extra = 1; minimum = 0x80; codePoint = lead & 0x1F; }
+            else if ((lead & 0xF0) == 0xE0) { extra = 2; minimum = 0x800; codePoint = lead & 0x0F; }
+            else if ((lead & 0xF8) == 0xF0) { extra = 3; minimum = 0x10000; codePoint = lead & 0x07; }
+
+            bool valid = extra > 0 && i + extra < input.size();
+
+            for (std::size_t j = 1; valid && j <= extra; ++j)
+            {
+                uint8_t next = uint8_t(input[i + j]);
+                valid = (next & 0xC0) == 0x80;
+                codePoint = (codePoint << 6) | (next & 0x3F);
+            }
+
+            if (valid
+             && codePoint >= minimum
+             && codePoint <= 0x10FFFF
+             && (codePoint < 0xD800 || codePoint > 0xDFFF))
+            {
+                length += extra;
+            }
+            else
+            {
+                codePoint = 0xFFFD;
+            }
+        }
+
+        if (sizeof(wchar_t) == 2 && codePoint > 0xFFFF)
+        {
+            codePoint -= 0x10000;
+            output.push_back(wchar_t(0xD800 + (codePoint >> 10)));
+            output.push_back(wchar_t(0xDC00 + (codePoint & 0x3FF)));
+        }
+        else
+        {
+            output.push_back(wchar_t(codePoint));
+        }
+
+        i += length;
+    }
+
+    return output;
+}
+
+
+/// \returns a copy of the string allocated with new[].
+char* copyString(const std::string& input)
+{
+    char* output = new char[input.size() + 1];
+    std::memcpy(output, input.c_str(), input.size() + 1);
+    return output;
+}
+
+
+/// \returns a copy of the string, as a wide string allocated with new[].
+wchar_t* copyWideString(const std::string& input)
+{
+    std::wstring wide = toWideString(input);
+    wchar_t* output = new wchar_t[wide.size() + 1];
+    std::copy(wide.c_str(), wide.c_str() + wide.size() + 1, output);
+    return output;
+}
+
+
+/// \brief Copy a string into a hidapi string buffer.
+/// \returns 0, as the hidapi string calls do on success.
+int getString(const std::string& input, wchar_t* string, std::size_t maxLength)
+{
+    if (maxLength == 0)
+        return -1;
+
+    std::wstring wide = toWideString(input);
+    std::size_t count = std::min(wide.size(), maxLength - 1);
+    std::copy(wide.begin(), wide.begin() + count, string);
+    string[count] = L'\0';
+    return 0;
+}
+
+
+}
+
+
+HIDVirtualBackend::~HIDVirtualBackend()
+{
+}
+
+
+std::shared_ptr<HIDVirtualDevice> HIDVirtualBackend::addDevice(const HIDVirtualDevice::Settings& settings)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    HIDVirtualDevice::Settings deviceSettings = settings;
+
+    if (deviceSettings.path.empty())
+        deviceSettings.path = "virtual:" + std::to_string(_nextPathNumber++);
+
+    auto device = std::make_shared<HIDVirtualDevice>(deviceSettings);
+    _devices.push_back(device);
+    return device;
+}
+
+
+bool HIDVirtualBackend::removeDevice(const std::shared_ptr<HIDVirtualDevice>& device)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto iter = std::find(_devices.begin(), _devices.end(), device);
+
+    if (iter == _devices.end())
+        return false;
+
+    // Open handles keep the device alive and fail from here on.
+    device->setConnected(false);
+    _devices.erase(iter);
+    return true;
+}
+
+
+std::vector<std::shared_ptr<HIDVirtualDevice>> HIDVirtualBackend::devices() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _devices;
+}
+
+
+hid_device_info* HIDVirtualBackend::enumerate(unsigned short vendorId,
+                                              unsigned short productId)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    hid_device_info* first = nullptr;
+    hid_device_info** next = &first;
+
+    for (const auto& device: _devices)
+    {
+        const HIDVirtualDevice::Settings& settings = device->settings();
+
+        if (!device->isConnected()
+         || (vendorId != 0 && vendorId != settings.vendorId)
+         || (productId != 0 && productId != settings.productId))
+        {
+            continue;
+        }
+
+        hid_device_info* info = new hid_device_info();
+        info->path = copyString(settings.path);
+        info->vendor_id = settings.vendorId;
+        info->product_id = settings.productId;
+        info->serial_number = copyWideString(settings.serialNumber);
+        info->manufacturer_string = copyWideString(settings.manufacturer);
+        info->product_string = copyWideString(settings.product);
+        info->usage_page = settings.usagePage;
+        info->usage = settings.usage;
+        info->interface_number = settings.interfaceNumber;
+
+        *next = info;
+        next = &info->next;
+    }
+
+    return first;
+}
+
+
+void HIDVirtualBackend::freeEnumeration(hid_device_info* devices)
+{
+    while (devices)
+    {
+        hid_device_info* next = devices->next;
+        delete [] devices->path;
+        delete [] devices->serial_number;
+        delete [] devices->manufacturer_string;
+        delete [] devices->product_string;
+        delete devices;
+        devices = next;
+    }
+}
+
+
+hid_device* HIDVirtualBackend::openPath(const char* path)
+{
+    auto device = _find(path);
+
+    if (!device || !device->_open())
+        return nullptr;
+
+    Handle* handle = new Handle();
+    handle->device = device;
+    return reinterpret_cast<hid_device*>(handle);
+}
+
+
+void HIDVirtualBackend::close(hid_device* device)
+{
+    Handle* handle = reinterpret_cast<Handle*>(device);
+
+    if (handle)
+    {
+        handle->device->_close();
+        delete handle;
+    }
+}
+
+
+int HIDVirtualBackend::write(hid_device* device,
+                             const unsigned char* data,
+                             std::size_t length)
+{
+    return _device(device)._write(data, length);
+}
+
+
+int HIDVirtualBackend::readTimeout(hid_device* device,
+                                   unsigned char* data,
+                                   std::size_t length,
+                                   int milliseconds)
+{
+    return _device(device)._read(data, length, milliseconds);
+}
+
+
+int HIDVirtualBackend::sendFeatureReport(hid_device* device,
+                                         const unsigned char* data,
+                                         std::size_t length)
+{
+    return _device(device)._sendFeature(data, length);
+}
+
+
+int HIDVirtualBackend::getFeatureReport(hid_device* device,
+                                        unsigned char* data,
+                                        std::size_t length)
+{
+    return _device(device)._getFeature(data, length);
+}
+
+
+int HIDVirtualBackend::getSerialNumberString(hid_device* device,
+                                             wchar_t* string,
+                                             std::size_t maxLength)
+{
+    return getString(_device(device).settings().serialNumber, string, maxLength);
+}
+
+
+int HIDVirtualBackend::getManufacturerString(hid_device* device,
+                                             wchar_t* string,
+                                             std::size_t maxLength)
+{
+    return getString(_device(device).settings().manufacturer, string, maxLength);
+}
+
+
+int HIDVirtualBackend::getProductString(hid_device* device,
+                                        wchar_t* string,
+                                        std::size_t maxLength)
+{
+    return getString(_device(device).settings().product, string, maxLength);
+}
+
+
+bool HIDVirtualBackend::getReportDescriptor(const std::string& path,
+                                            std::vector<uint8_t>& descriptor)
+{
+    descriptor.clear();
+
+    auto device = _find(path);
+
+    if (!device || device->settings().reportDescriptor.empty())
+        return false;
+
+    descriptor = device->settings().reportDescriptor;
+    return true;
+}
+
+
+HIDVirtualDevice& HIDVirtualBackend::_device(hid_device* handle)
+{
+    return *reinterpret_cast<Handle*>(handle)->device;
+}
+
+
+std::shared_ptr<HIDVirtualDevice> HIDVirtualBackend::_find(const std::string& path) const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (const auto& device: _devices)
+    {
+        if (device->path() == path)
+            return device;
+    }
+
+    return nullptr;
+}
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,252 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDVirtualDevice.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+
+namespace ofx {
+namespace IO {
+
+
+const std::size_t HIDVirtualDevice::DEFAULT_MAX_QUEUED_INPUT_REPORTS = 64;
+
+
+HIDVirtualDevice::HIDVirtualDevice(const Settings& settings):
+    _settings(settings),
+    _opens(0),
+    _closes(0),
+    _writes(0),
+    _droppedInputReports(0)
+{
+    _settings.maxQueuedInputReports = std::max(_settings.maxQueuedInputReports,
+                                               std::size_t(1));
+}
+
+
+const HIDVirtualDevice::Settings& HIDVirtualDevice::settings() const
+{
+    return _settings;
+}
+
+
+const std::string& HIDVirtualDevice::path() const
+{
+    return _settings.path;
+}
+
+
+bool HIDVirtualDevice::pushInputReport(const uint8_t* data, std::size_t size)
+{
+    bool dropped = false;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        if (_inputReports.size() >= _settings.maxQueuedInputReports)
+        {
+            _inputReports.pop_front();
+            ++_droppedInputReports;
+            dropped = true;
+        }
+
+        _inputReports.emplace_back(data, data + size);
+    }
+
+    _inputCondition.notify_one();
+    return !dropped;
+}
+
+
+bool HIDVirtualDevice::pushInputReport(const std::vector<uint8_t>& report)
+{
+    return pushInputReport(report.data(), report.size());
+}
+
+
+void HIDVirtualDevice::setWriteHandler(SendHandler handler)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _writeHandler = handler;
+}
+
+
+void HIDVirtualDevice::setSendFeatureHandler(SendHandler handler)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _sendFeatureHandler = handler;
+}
+
+
+void HIDVirtualDevice::setGetFeatureHandler(GetHandler handler)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _getFeatureHandler = handler;
+}
+
+
+void HIDVirtualDevice::setConnected(bool connected)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _connected = connected;
+
+        if (!connected)
+            _inputReports.clear();
+    }
+
+    _inputCondition.notify_all();
+}
+
+
+bool HIDVirtualDevice::isConnected() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _connected;
+}
+
+
+void HIDVirtualDevice::setOpenFails(bool fails)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _openFails = fails;
+}
+
+
+uint64_t HIDVirtualDevice::opens() const
+{
+    return _opens;
+}
+
+
+uint64_t HIDVirtualDevice::closes() const
+{
+    return _closes;
+}
+
+
+uint64_t HIDVirtualDevice::writes() const
+{
+    return _writes;
+}
+
+
+uint64_t HIDVirtualDevice::droppedInputReports() const
+{
+    return _droppedInputReports;
+}
+
+
+std::size_t HIDVirtualDevice::queuedInputReports() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _inputReports.size();
+}
+
+
+bool HIDVirtualDevice::_open()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (!_connected || _openFails)
+        return false;
+
+    ++_opens;
+    return true;
+}
+
+
+void HIDVirtualDevice::_close()
+{
+    ++_closes;
+}
+
+
+int HIDVirtualDevice::_read(uint8_t* data, std::size_t size, int timeoutMillis)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto ready = [&]() { return !_connected || !_inputReports.empty(); };
+
+    // A negative timeout blocks until a report arrives, as hid_read() does.
+    if (timeoutMillis < 0)
+        _inputCondition.wait(lock, ready);
+    else if (!_inputCondition.wait_for(lock, std::chrono::milliseconds(timeoutMillis), ready))
+        return 0;
+
+    if (!_connected)
+        return -1;
+
+    // Like hidapi, longer reports are truncated to the buffer size.
+    const std::vector<uint8_t>& report = _inputReports.front();
+    std::size_t count = std::min(report.size(), size);
+    std::memcpy(data, report.data(), count);
+    _inputReports.pop_front();
+    return int(count);
+}
+
+
+int HIDVirtualDevice::_write(const uint8_t* data, std::size_t size)
+{
+    SendHandler handler;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        if (!_connected)
+            return -1;
+
+        handler = _writeHandler;
+    }
+
+    // The handler runs unlocked, so it may block without stalling reads.
+    int result = handler ? handler(data, size) : int(size);
+
+    if (result > -1)
+        ++_writes;
+
+    return result;
+}
+
+
+int HIDVirtualDevice::_sendFeature(const uint8_t* data, std::size_t size)
+{
+    SendHandler handler;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        if (!_connected)
+            return -1;
+
+        handler = _sendFeatureHandler;
+    }
+
+    return handler ? handler(data, size) : int(size);
+}
+
+
+int HIDVirtualDevice::_getFeature(uint8_t* data, std::size_t size)
+{
+    GetHandler handler;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        if (!_connected)
+            return -1;
+
+        handler = _getFeatureHandler;
+    }
+
+    return handler ? handler(data, size) : -1;
+}
+
+
+} } // namespace ofx::IO
@@ -0,0 +1,455 @@
+//
+// Copyright (c) 2017 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofx/IO/HIDWriteScheduler.h"
+#include "ofx/IO/HIDDeviceUtils.h"
+#include <chrono>
+#include <cmath>
+
+
+namespace ofx {
+namespace IO {
+
+
+namespace {
+
+
+/// \brief The length of the achieved rate measurement window.
+const uint64_t RATE_WINDOW_MICROS = 1000000;
+
+
+}
+
+
+const std::size_t HIDWriteScheduler::DEFAULT_URGENT_BURST = 8;
+
+
+void HIDWriteScheduler::TokenBucket::refill(uint64_t nowMicros)
+{
+    if (rate <= 0)
+    {
+        tokens = capacity;
+    }
+    else if (nowMicros > lastRefillMicros)
+    {
+        tokens = std::min(capacity, tokens + rate * (nowMicros - lastRefillMicros) / 1000000.0);
+    }
+
+    lastRefillMicros = std::max(lastRefillMicros, nowMicros);
+}
+
+
+uint64_t HIDWriteScheduler::TokenBucket::nextTokenMicros() const
+{
+    if (tokens >= 1 || rate <= 0)
+        return lastRefillMicros;
+
+    return lastRefillMicros + uint64_t(std::ceil((1 - tokens) * 1000000.0 / rate));
+}
+
+
+HIDWriteScheduler::HIDWriteScheduler()
+{
+}
+
+
+HIDWriteScheduler::~HIDWriteScheduler()
+{
+    stop();
+}
+
+
+bool HIDWriteScheduler::addDevice(HIDDevice& device)
+{
+    return addDevice(device, DeviceSettings());
+}
+
+
+bool HIDWriteScheduler::addDevice(HIDDevice& device,
+                                  const DeviceSettings& settings)
+{
+    if (!device.isOpen() || device.deviceInfo() == nullptr)
+    {
+        ofLogError("HIDWriteScheduler::addDevice") << "No device is open.";
+        return false;
+    }
+
+    std::string path = device.deviceInfo()->path();
+
+    double rate = settings.reportsPerSecond;
+
+    // An interrupt OUT endpoint cannot accept reports faster than it is polled.
+    uint64_t intervalMicros = HIDDeviceUtils::getOutputIntervalMicros(path);
+
+    if (intervalMicros > 0)
+    {
+        double pollingRate = 1000000.0 / intervalMicros;
+        rate = (rate > 0) ? std::min(rate, pollingRate) : pollingRate;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    Device& state = _devices[&device];
+    state.device = &device;
+    state.settings = settings;
+    state.settings.weight = std::max(settings.weight, std::numeric_limits<double>::epsilon());
+    state.bucket.rate = rate;
+    state.bucket.capacity = std::max(settings.burst, 1.0);
+    state.bucket.tokens = state.bucket.capacity;
+    state.bucket.lastRefillMicros = HIDDeviceUtils::monotonicTimeMicros();
+    state.stats.path = path;
+    state.stats.hub = HIDDeviceUtils::getUSBHubPath(path);
+    state.stats.reportsPerSecond = rate;
+    state.windowStartMicros = state.bucket.lastRefillMicros;
+
+    auto& hub = _hubs[state.stats.hub];
+    hub.rate = _hubReportsPerSecond;
+
+    return true;
+}
+
+
+void HIDWriteScheduler::removeDevice(HIDDevice& device)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    // Wait for an in-flight write to this device to finish.
+    _condition.wait(lock, [&]() { return _activeDevice != &device; });
+
+    _devices.erase(&device);
+}
+
+
+void HIDWriteScheduler::setHubReportsPerSecond(double reportsPerSecond)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    _hubReportsPerSecond = reportsPerSecond;
+
+    for (auto& hub: _hubs)
+        hub.second.rate = reportsPerSecond;
+}
+
+
+double HIDWriteScheduler::getHubReportsPerSecond() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _hubReportsPerSecond;
+}
+
+
+void HIDWriteScheduler::setUrgentBurst(std::size_t urgentBurst)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _urgentBurst = std::max(urgentBurst, std::size_t(1));
+}
+
+
+std::size_t HIDWriteScheduler::getUrgentBurst() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _urgentBurst;
+}
+
+
+bool HIDWriteScheduler::enqueue(HIDDevice& device,
+                                uint8_t reportId,
+                                const std::vector<uint8_t>& reportData,
+                                Lane lane)
+{
+    Report report;
+    report.reportId = reportId;
+    report.data = reportData;
+    return _enqueue(device, std::move(report), lane);
+}
+
+
+bool HIDWriteScheduler::enqueue(HIDDevice& device,
+                                HIDReportHandle report,
+                                Lane lane)
+{
+    if (!report || report->size() == 0)
+    {
+        ofLogError("HIDWriteScheduler::enqueue") << "Empty report handle.";
+        return false;
+    }
+
+    Report pending;
+    pending.reportId = report->data()[0];
+    pending.pooled = std::move(report);
+    return _enqueue(device, std::move(pending), lane);
+}
+
+
+bool HIDWriteScheduler::_enqueue(HIDDevice& device, Report report, Lane lane)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        auto iter = _devices.find(&device);
+
+        if (iter == _devices.end())
+        {
+            ofLogError("HIDWriteScheduler::enqueue") << "Unknown device.";
+            return false;
+        }
+
+        Device& state = iter->second;
+
+        bool urgent = (lane == Lane::URGENT);
+
+        std::deque<Report>& queue = urgent ? state.urgentQueue : state.queue;
+        double& lastFinishTag = urgent ? state.lastUrgentFinishTag : state.lastFinishTag;
+
+        if (queue.size() >= state.settings.maxQueueSize)
+        {
+            ++state.stats.rejected;
+            ++(urgent ? state.stats.urgent : state.stats.bulk).rejected;
+            return false;
+        }
+
+        // Pooled slabs already include the report id byte.
+        std::size_t size = report.pooled ? report.pooled->size() - 1 : report.data.size();
+
+        report.enqueueMicros = HIDDeviceUtils::monotonicTimeMicros();
+
+        // Weighted fair queuing: a report finishes after its flow's previous
+        // report and after the current virtual time, delayed by its size
+        // divided by the flow's weight.
+        report.finishTag = std::max(_virtualTime, lastFinishTag) + (size + 1) / state.settings.weight;
+        lastFinishTag = report.finishTag;
+
+        queue.push_back(std::move(report));
+    }
+
+    _condition.notify_all();
+    return true;
+}
+
+
+void HIDWriteScheduler::start()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (_running)
+        return;
+
+    _running = true;
+    _thread = std::thread(&HIDWriteScheduler::_run, this);
+}
+
+
+void HIDWriteScheduler::stop()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _running = false;
+    }
+
+    _condition.notify_all();
+
+    if (_thread.joinable())
+        _thread.join();
+}
+
+
+bool HIDWriteScheduler::isRunning() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _running;
+}
+
+
+void HIDWriteScheduler::setThreadSettings(const HIDThreadSettings& settings)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _threadSettings = settings;
+}
+
+
+std::vector<HIDWriteScheduler::DeviceStats> HIDWriteScheduler::stats() const
+{
+    std::vector<DeviceStats> result;
+
+    uint64_t now = HIDDeviceUtils::monotonicTimeMicros();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (const auto& entry: _devices)
+    {
+        const Device& state = entry.second;
+
+        DeviceStats stats = state.stats;
+        stats.urgent.queued = state.urgentQueue.size();
+        stats.bulk.queued = state.queue.size();
+        stats.queued = stats.urgent.queued + stats.bulk.queued;
+
+        // Include a window that has expired without a write to close it.
+        uint64_t elapsed = now - state.windowStartMicros;
+
+        if (elapsed >= RATE_WINDOW_MICROS)
+            stats.achievedReportsPerSecond = state.windowCount * 1000000.0 / elapsed;
+
+        result.push_back(stats);
+    }
+
+    return result;
+}
+
+
+void HIDWriteScheduler::resetLatencies()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (auto& entry: _devices)
+    {
+        entry.second.stats.urgent.latency.reset();
+        entry.second.stats.bulk.latency.reset();
+    }
+}
+
+
+void HIDWriteScheduler::_run()
+{
+    HIDThreadSettings settings;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        settings = _threadSettings;
+    }
+
+    settings.applyToCurrentThread();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (_running)
+    {
+        uint64_t now = HIDDeviceUtils::monotonicTimeMicros();
+        uint64_t wakeMicros = std::numeric_limits<uint64_t>::max();
+
+        Device* nextUrgent = nullptr;
+        Device* nextBulk = nullptr;
+
+        for (auto& entry: _devices)
+        {
+            Device& state = entry.second;
+
+            if (state.urgentQueue.empty() && state.queue.empty())
+                continue;
+
+            TokenBucket& hub = _hubs[state.stats.hub];
+
+            state.bucket.refill(now);
+            hub.refill(now);
+
+            if (state.bucket.tokens >= 1 && hub.tokens >= 1)
+            {
+                if (!state.urgentQueue.empty()
+                && (nextUrgent == nullptr || state.urgentQueue.front().finishTag < nextUrgent->urgentQueue.front().finishTag))
+                    nextUrgent = &state;
+
+                if (!state.queue.empty()
+                && (nextBulk == nullptr || state.queue.front().finishTag < nextBulk->queue.front().finishTag))
+                    nextBulk = &state;
+            }
+            else
+            {
+                wakeMicros = std::min(wakeMicros, std::max(state.bucket.nextTokenMicros(),
+                                                           hub.nextTokenMicros()));
+            }
+        }
+
+        // Urgent reports go first, but yield to one bulk report after each
+        // urgent burst so bulk traffic is never starved.
+        bool urgent = nextUrgent != nullptr && (nextBulk == nullptr || _urgentStreak < _urgentBurst);
+
+        _urgentStreak = (urgent && nextBulk != nullptr) ? _urgentStreak + 1 : 0;
+
+        Device* next = urgent ? nextUrgent : nextBulk;
+
+        if (next == nullptr)
+        {
+            if (wakeMicros == std::numeric_limits<uint64_t>::max())
+            {
+                _condition.wait(lock);
+            }
+            else
+            {
+                std::chrono::steady_clock::time_point wake{std::chrono::microseconds(wakeMicros)};
+                _condition.wait_until(lock, wake);
+            }
+
+            continue;
+        }
+
+        std::deque<Report>& queue = urgent ? next->urgentQueue : next->queue;
+
+        Report report = std::move(queue.front());
+        queue.pop_front();
+        next->bucket.tokens -= 1;
+        _hubs[next->stats.hub].tokens -= 1;
+        _virtualTime = std::max(_virtualTime, report.finishTag);
+
+        HIDDevice* device = next->device;
+        _activeDevice = device;
+
+        lock.unlock();
+
+        std::streamsize result = -1;
+
+        if (report.pooled)
+        {
+            result = device->write(report.pooled->data(), report.pooled->size());
+            report.pooled.reset();
+        }
+        else
+        {
+            result = device->writeReport(report.reportId, report.data);
+        }
+
+        lock.lock();
+
+        _activeDevice = nullptr;
+        _condition.notify_all();
+
+        auto iter = _devices.find(device);
+
+        if (iter != _devices.end())
+        {
+            Device& state = iter->second;
+
+            uint64_t written = HIDDeviceUtils::monotonicTimeMicros();
+
+            LaneStats& laneStats = urgent ? state.stats.urgent : state.stats.bulk;
+
+            if (result < 0)
+            {
+                ++state.stats.failed;
+            }
+            else
+            {
+                ++state.stats.written;
+                ++laneStats.written;
+                laneStats.latency.record(written - report.enqueueMicros);
+            }
+
+            ++state.windowCount;
+
+            uint64_t elapsed = written - state.windowStartMicros;
+
+            if (elapsed >= RATE_WINDOW_MICROS)
+            {
+                state.stats.achievedReportsPerSecond = state.windowCount * 1000000.0 / elapsed;
+                state.windowStartMicros = written;
+                state.windowCount = 0;
+            }
+        }
+    }
+}
+
+
+} } // namespace ofx::IO
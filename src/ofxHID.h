@@ -9,6 +9,40 @@
 
 
 #include "ofxIO.h"
+#include "ofx/IO/HIDBackend.h"
+#include "ofx/IO/HIDClockSync.h"
+#include "ofx/IO/HIDCompositeDevice.h"
 #include "ofx/IO/HIDDevice.h"
+#include "ofx/IO/HIDDeviceHandle.h"
 #include "ofx/IO/HIDDeviceInfo.h"
+#include "ofx/IO/HIDDeviceRegistry.h"
 #include "ofx/IO/HIDDeviceUtils.h"
+#include "ofx/IO/HIDDeviceWatchdog.h"
+#include "ofx/IO/HIDGamepadState.h"
+#include "ofx/IO/HIDGamepadStateTracker.h"
+#include "ofx/IO/HIDLatencyHistogram.h"
+#include "ofx/IO/HIDOutputReportCache.h"
+#include "ofx/IO/HIDPooledReport.h"
+#include "ofx/IO/HIDReport.h"
+#include "ofx/IO/HIDReportBroadcaster.h"
+#include "ofx/IO/HIDReportDescriptor.h"
+#include "ofx/IO/HIDReportDispatcher.h"
+#include "ofx/IO/HIDReportFilter.h"
+#include "ofx/IO/HIDReportLayout.h"
+#include "ofx/IO/HIDReportPool.h"
+#include "ofx/IO/HIDReportRing.h"
+#include "ofx/IO/HIDReportSubscriber.h"
+#include "ofx/IO/HIDSharedMemory.h"
+#include "ofx/IO/HIDSharedMemoryReader.h"
+#include "ofx/IO/HIDSharedMemoryWriter.h"
+#include "ofx/IO/HIDStream.h"
+#include "ofx/IO/HIDStreamBuffer.h"
+#include "ofx/IO/HIDTelemetryLog.h"
+#include "ofx/IO/HIDTelemetryReader.h"
+#include "ofx/IO/HIDTelemetryWriter.h"
+#include "ofx/IO/HIDThreadSettings.h"
+#include "ofx/IO/HIDTimerWheel.h"
+#include "ofx/IO/HIDTripleBuffer.h"
+#include "ofx/IO/HIDVirtualBackend.h"
+#include "ofx/IO/HIDVirtualDevice.h"
+#include "ofx/IO/HIDWriteScheduler.h"